@@ -65,6 +65,4 @@ void cboard_Arduino_Mega::ReadPreferences(char* name, char* value) {
     }
 }
 
-// TODO cboard_Arduino_Mega: add suport to analog inputs A6 and A7
-
 board_init(BOARD_Arduino_Mega_Name, cboard_Arduino_Mega);
@@ -66,6 +66,4 @@ void cboard_Arduino_Nano::ReadPreferences(char* name, char* value) {
     }
 }
 
-// TODO cboard_Arduino_Nano: add suport to analog inputs A6 and A7
-
 board_init(BOARD_Arduino_Nano_Name, cboard_Arduino_Nano);
@@ -397,73 +397,6 @@ void cboard_Blue_Pill::Draw(CDraw* draw) {
     draw->Update();
 }
 
-void cboard_Blue_Pill::Run_CPU_ns(uint64_t time) {
-    static unsigned char pi = 0;
-    static unsigned int alm[64];
-    static const int pinc = MGetPinCount();
-
-    const float RNSTEP = 200.0 * pinc * inc_ns / TTIMEOUT;
-
-    for (uint64_t c = 0; c < time; c += inc_ns) {
-        if (ns_count < inc_ns) {
-            // reset pins mean value
-            memset(alm, 0, 64 * sizeof(unsigned int));
-
-            // Spare parts window pre process
-            if (use_spare)
-                SpareParts.PreProcess();
-
-            // j = JUMPSTEPS; //step counter
-            pi = 0;
-        }
-
-        if (PICSimLab.GetMcuPwr())  // if powered
-                                    // for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-        {
-            /*
-            if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
-             {
-             }
-             */
-            // verify if a breakpoint is reached if not run one instruction
-            MStep();
-            InstCounterInc();
-            // Oscilloscope window process
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            // Spare parts window process
-            if (use_spare)
-                SpareParts.Process();
-
-            //  increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pinc)
-                pi = 0;
-            /*
-                if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
-                 {
-                  j = -1; //reset counter
-                 }
-
-                j++; //counter increment
-             */
-        }
-
-        ns_count += inc_ns;
-        if (ns_count >= TTIMEOUT) {
-            ns_count -= TTIMEOUT;
-            //  calculate mean value
-            for (pi = 0; pi < MGetPinCount(); pi++) {
-                pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
-            }
-            // Spare parts window pre post process
-            if (use_spare)
-                SpareParts.PostProcess();
-        }
-    }
-}
-
 void cboard_Blue_Pill::board_Event(CControl* control) {
     icount = MipsStrToIcount(combo1->GetText().c_str());
     PICSimLab.EndSimulation();
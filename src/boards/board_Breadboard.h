@@ -86,6 +86,8 @@ public:
     unsigned int DBGGetCONFIGSize(void) override;
     unsigned int DBGGetIDSize(void) override;
     unsigned int DBGGetEEPROM_Size(void) override;
+    int MSnapshotWrite(FILE* fout) override;
+    int MSnapshotRead(FILE* fin) override;
     int GetUARTRX(const int uart_num) override;
     int GetUARTTX(const int uart_num) override;
 
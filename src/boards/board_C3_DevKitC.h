@@ -60,7 +60,6 @@ public:
     // Called ever 100ms to draw board
     void Draw(CDraw* draw) override;
     void Run_CPU(void) override;
-    void Run_CPU_ns(uint64_t time) override;
     // Return a list of board supported microcontrollers
     lxString GetSupportedDevices(void) override { return lxT("ESP32-C3,"); };
     // Reset board status
@@ -90,6 +89,7 @@ public:
     lxString MGetPinName(int pin) override;
     int MGetPinCount(void) override;
     void PinsExtraConfig(int cfg) override;
+    void PinsRefresh(void) override;
     unsigned int DBGGetROMSize(void) override { return 4194304; };
 };
 
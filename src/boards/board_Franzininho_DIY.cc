@@ -25,6 +25,7 @@
 
 // include files
 #include "board_Franzininho_DIY.h"
+#include "../lib/board_run.h"
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
@@ -376,71 +377,54 @@ void cboard_Franzininho_DIY::Draw(CDraw* draw) {
 }
 
 void cboard_Franzininho_DIY::Run_CPU(void) {
-    int i;
-    unsigned char pi;
     const picpin* pins;
-    unsigned int alm[40];
 
-    const int pinc = MGetPinCount();
     const long int NSTEP = 4.0 * PICSimLab.GetNSTEP();  // number of steps in 100ms
-    const float RNSTEP = 200.0 * pinc / NSTEP;
 
     long long unsigned int cycle_start;
     int twostep = 0;
 
-    // reset mean value
-
-    memset(alm, 0, pinc * sizeof(unsigned int));
-
     // read pic.pins to a local variable to speed up
 
     pins = MGetPinsValues();
 
+    // reset mean value
+    AlmStart(pins, MGetPinCount());
+
     if (use_spare)
         SpareParts.PreProcess();
 
-    pi = 0;
-    if (PICSimLab.GetMcuPwr())       // if powered
-        for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-        {
-            // verify if a breakpoint is reached if not run one instruction
-            if (avr_debug_type || (!mplabxd_testbp())) {
-                if (twostep) {
-                    twostep = 0;  // NOP
-                } else {
-                    cycle_start = avr->cycle;
-                    avr_run(avr);
-                    if ((avr->cycle - cycle_start) > 1) {
-                        twostep = 1;
-                    }
-                    // TinyDebug support
-                    if (avr->data[TDDR]) {
-                        printf("%c", avr->data[TDDR]);
-                        serial_port_send(serialfd, avr->data[TDDR]);
-                        avr->data[TDDR] = 0;
+    if (PICSimLab.GetMcuPwr())  // if powered
+        Run_CPU_Steps(
+            NSTEP,  // repeat for number of steps in 100ms
+            [&](const long int, const int run) {
+                // run one instruction if a breakpoint is not reached
+                if (avr_debug_type || run) {
+                    if (twostep) {
+                        twostep = 0;  // NOP
+                    } else {
+                        cycle_start = avr->cycle;
+                        avr_run(avr);
+                        if ((avr->cycle - cycle_start) > 1) {
+                            twostep = 1;
+                        }
+                        // TinyDebug support
+                        if (avr->data[TDDR]) {
+                            printf("%c", avr->data[TDDR]);
+                            serial_port_buff_send(&serialbuff, avr->data[TDDR]);
+                            avr->data[TDDR] = 0;
+                        }
                     }
                 }
-            }
-            InstCounterInc();
-            UpdateHardware();
-
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-            ioupdated = 0;
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pinc)
-                pi = 0;
-        }
+                InstCounterInc();
+                UpdateHardware();
+            },
+            [&](const long int) {
+                ioupdated = 0;
+            });
 
     // calculate mean value
-    for (pi = 0; pi < MGetPinCount(); pi++) {
-        cboard_Franzininho_DIY::pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
-    }
+    AlmEnd(cboard_Franzininho_DIY::pins);
 
     if (use_spare)
         SpareParts.PostProcess();
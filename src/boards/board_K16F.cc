@@ -24,6 +24,7 @@
    ######################################################################## */
 
 #include "board_K16F.h"
+#include "../lib/board_run.h"
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
@@ -86,6 +87,9 @@ cboard_K16F::cboard_K16F(void) : font(10, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NOR
     lcd_init(&lcd, 16, 2, this);
     mi2c_init(&mi2c, 512);
     rtc_pfc8563_init(&rtc, this);
+    i2c_bus_init(&i2c_bus);
+    mi2c_attach(&mi2c, &i2c_bus);
+    rtc_pfc8563_I2C_attach(&rtc, &i2c_bus);
     ReadMaps();
 
     snprintf(mi2c_tmp_name, 200, "%s/picsimlab-XXXXXX", (const char*)lxGetTempDir("PICSimLab").c_str());
@@ -171,8 +175,10 @@ void cboard_K16F::Draw(CDraw* draw) {
 
                 if (output[i].id == O_LCD) {
                     if (lcd.update) {
-                        draw->Canvas.Rectangle(1, output[i].x1 - 1, output[i].y1 - 1, output[i].x2 - output[i].x1 + 2,
-                                               output[i].y2 - output[i].y1 + 3);
+                        if (lcd.redraw) {
+                            draw->Canvas.Rectangle(1, output[i].x1 - 1, output[i].y1 - 1,
+                                                   output[i].x2 - output[i].x1 + 2, output[i].y2 - output[i].y1 + 3);
+                        }
                         lcd_draw(&lcd, &draw->Canvas, output[i].x1, output[i].y1, output[i].x2 - output[i].x1,
                                  output[i].y2 - output[i].y1, PICSimLab.GetMcuPwr());
                     }
@@ -256,164 +262,151 @@ void cboard_K16F::Draw(CDraw* draw) {
 }
 
 void cboard_K16F::Run_CPU(void) {
-    int i;
     int j;
-    unsigned char pi;
     const picpin* pins;
-    unsigned int alm[18];  // luminosidade media
 
     const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
     const long int NSTEP = PICSimLab.GetNSTEP();
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
 
     pins = pic.pins;
 
-    memset(alm, 0, 18 * sizeof(unsigned int));
+    // reset pins mean value
+    AlmStart(pins, pic.PINCOUNT);
 
     if (use_spare)
         SpareParts.PreProcess();
 
     j = JUMPSTEPS;
-    pi = 0;
     if (PICSimLab.GetMcuPwr())
-        for (i = 0; i < NSTEP; i++) {
-            if (j >= JUMPSTEPS) {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-
-                pic_set_pin(&pic, 18, 0);
-                pic_set_pin(&pic, 1, 0);
-                pic_set_pin(&pic, 15, 0);
-                pic_set_pin(&pic, 16, 0);
-                pic_set_pin(&pic, 13, 0);
-                pic_set_pin(&pic, 12, 0);
-                pic_set_pin(&pic, 11, 0);
-            }
-
-            // keyboard
+        Run_CPU_Steps(
+            NSTEP,  // repeat for number of steps in 100ms
+            [&](const long int, const int run) {
+                if (j >= JUMPSTEPS) {
+                    pic_set_pin(&pic, pic.mclr, p_RST);
+
+                    pic_set_pin(&pic, 18, 0);
+                    pic_set_pin(&pic, 1, 0);
+                    pic_set_pin(&pic, 15, 0);
+                    pic_set_pin(&pic, 16, 0);
+                    pic_set_pin(&pic, 13, 0);
+                    pic_set_pin(&pic, 12, 0);
+                    pic_set_pin(&pic, 11, 0);
+                }
 
-            if (p_KEY[0]) {
-                pic_set_pin(&pic, 18, pic_get_pin(&pic, 13));
-                pic_set_pin(&pic, 13, pic_get_pin(&pic, 18));
-            }
+                // keyboard
 
-            if (p_KEY[1]) {
-                pic_set_pin(&pic, 18, pic_get_pin(&pic, 12));
-                pic_set_pin(&pic, 12, pic_get_pin(&pic, 18));
-            }
+                if (p_KEY[0]) {
+                    pic_set_pin(&pic, 18, pic_get_pin(&pic, 13));
+                    pic_set_pin(&pic, 13, pic_get_pin(&pic, 18));
+                }
 
-            if (p_KEY[2]) {
-                pic_set_pin(&pic, 18, pic_get_pin(&pic, 11));
-                pic_set_pin(&pic, 11, pic_get_pin(&pic, 18));
-            }
+                if (p_KEY[1]) {
+                    pic_set_pin(&pic, 18, pic_get_pin(&pic, 12));
+                    pic_set_pin(&pic, 12, pic_get_pin(&pic, 18));
+                }
 
-            if (p_KEY[3]) {
-                pic_set_pin(&pic, 1, pic_get_pin(&pic, 13));
-                pic_set_pin(&pic, 13, pic_get_pin(&pic, 1));
-            }
+                if (p_KEY[2]) {
+                    pic_set_pin(&pic, 18, pic_get_pin(&pic, 11));
+                    pic_set_pin(&pic, 11, pic_get_pin(&pic, 18));
+                }
 
-            if (p_KEY[4]) {
-                pic_set_pin(&pic, 1, pic_get_pin(&pic, 12));
-                pic_set_pin(&pic, 12, pic_get_pin(&pic, 1));
-            }
+                if (p_KEY[3]) {
+                    pic_set_pin(&pic, 1, pic_get_pin(&pic, 13));
+                    pic_set_pin(&pic, 13, pic_get_pin(&pic, 1));
+                }
 
-            if (p_KEY[5]) {
-                pic_set_pin(&pic, 1, pic_get_pin(&pic, 11));
-                pic_set_pin(&pic, 11, pic_get_pin(&pic, 1));
-            }
+                if (p_KEY[4]) {
+                    pic_set_pin(&pic, 1, pic_get_pin(&pic, 12));
+                    pic_set_pin(&pic, 12, pic_get_pin(&pic, 1));
+                }
 
-            if (p_KEY[6]) {
-                pic_set_pin(&pic, 15, pic_get_pin(&pic, 13));
-                pic_set_pin(&pic, 13, pic_get_pin(&pic, 15));
-            }
+                if (p_KEY[5]) {
+                    pic_set_pin(&pic, 1, pic_get_pin(&pic, 11));
+                    pic_set_pin(&pic, 11, pic_get_pin(&pic, 1));
+                }
 
-            if (p_KEY[7]) {
-                pic_set_pin(&pic, 15, pic_get_pin(&pic, 12));
-                pic_set_pin(&pic, 12, pic_get_pin(&pic, 15));
-            }
+                if (p_KEY[6]) {
+                    pic_set_pin(&pic, 15, pic_get_pin(&pic, 13));
+                    pic_set_pin(&pic, 13, pic_get_pin(&pic, 15));
+                }
 
-            if (p_KEY[8]) {
-                pic_set_pin(&pic, 15, pic_get_pin(&pic, 11));
-                pic_set_pin(&pic, 11, pic_get_pin(&pic, 15));
-            }
+                if (p_KEY[7]) {
+                    pic_set_pin(&pic, 15, pic_get_pin(&pic, 12));
+                    pic_set_pin(&pic, 12, pic_get_pin(&pic, 15));
+                }
 
-            if (p_KEY[9]) {
-                pic_set_pin(&pic, 16, pic_get_pin(&pic, 13));
-                pic_set_pin(&pic, 13, pic_get_pin(&pic, 16));
-            }
+                if (p_KEY[8]) {
+                    pic_set_pin(&pic, 15, pic_get_pin(&pic, 11));
+                    pic_set_pin(&pic, 11, pic_get_pin(&pic, 15));
+                }
 
-            if (p_KEY[10]) {
-                pic_set_pin(&pic, 16, pic_get_pin(&pic, 12));
-                pic_set_pin(&pic, 12, pic_get_pin(&pic, 16));
-            }
+                if (p_KEY[9]) {
+                    pic_set_pin(&pic, 16, pic_get_pin(&pic, 13));
+                    pic_set_pin(&pic, 13, pic_get_pin(&pic, 16));
+                }
 
-            if (p_KEY[11]) {
-                pic_set_pin(&pic, 16, pic_get_pin(&pic, 11));
-                pic_set_pin(&pic, 11, pic_get_pin(&pic, 16));
-            }
+                if (p_KEY[10]) {
+                    pic_set_pin(&pic, 16, pic_get_pin(&pic, 12));
+                    pic_set_pin(&pic, 12, pic_get_pin(&pic, 16));
+                }
 
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS) {
-                j = -1;
-            }
-            j++;
+                if (p_KEY[11]) {
+                    pic_set_pin(&pic, 16, pic_get_pin(&pic, 11));
+                    pic_set_pin(&pic, 11, pic_get_pin(&pic, 16));
+                }
 
-            if (ioupdated) {
-                // serial lcd display code
-                if ((pins[9].value) && (!clko)) {
-                    d = (d << 1) | pins[8].value;
+                if (run)
+                    PicStep();
+                ioupdated = pic.ioupdated;
+                InstCounterInc();
+            },
+            [&](const long int) {
+                if (j >= JUMPSTEPS) {
+                    j = -1;
                 }
+                j++;
+
+                if (ioupdated) {
+                    // serial lcd display code
+                    if ((pins[9].value) && (!clko)) {
+                        d = (d << 1) | pins[8].value;
+                    }
 
-                clko = pins[9].value;
+                    clko = pins[9].value;
 
-                if ((!pins[16].dir) && (!pins[16].value)) {
-                    if (!lcde) {
-                        if ((!pins[8].dir) && (!pins[8].value)) {
-                            lcd_cmd(&lcd, d);
-                        } else if ((!pins[8].dir) && (pins[8].value)) {
-                            lcd_data(&lcd, d);
+                    if ((!pins[16].dir) && (!pins[16].value)) {
+                        if (!lcde) {
+                            if ((!pins[8].dir) && (!pins[8].value)) {
+                                lcd_cmd(&lcd, d);
+                            } else if ((!pins[8].dir) && (pins[8].value)) {
+                                lcd_data(&lcd, d);
+                            }
+                            lcde = 1;
                         }
-                        lcde = 1;
+                    } else {
+                        lcde = 0;
                     }
-                } else {
-                    lcde = 0;
-                }
 
-                // i2c code
-                if (pins[2].dir) {
-                    sda = 1;
-                } else {
-                    sda = pins[2].value;
-                }
+                    // i2c code
+                    if (pins[2].dir) {
+                        sda = 1;
+                    } else {
+                        sda = pins[2].value;
+                    }
 
-                if (pins[1].dir) {
-                    sck = 1;
-                    pic_set_pin(&pic, 2, 1);
-                } else {
-                    sck = pins[1].value;
+                    if (pins[1].dir) {
+                        sck = 1;
+                        pic_set_pin(&pic, 2, 1);
+                    } else {
+                        sck = pins[1].value;
+                    }
+                    pic_set_pin(&pic, 3, i2c_bus_io(&i2c_bus, sck, sda));
                 }
-                pic_set_pin(&pic, 3, mi2c_io(&mi2c, sck, sda) & rtc_pfc8563_I2C_io(&rtc, sck, sda));
-            }
-            pic.ioupdated = 0;
-        }
+                pic.ioupdated = 0;
+            });
     // fim STEP
 
-    for (pi = 0; pi < pic.PINCOUNT; pi++) {
-        pic.pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
-    }
+    AlmEnd(pic.pins);
 
     if (use_spare)
         SpareParts.PostProcess();
@@ -446,6 +439,7 @@ void cboard_K16F::Reset(void) {
     lcd_rst(&lcd);
     mi2c_rst(&mi2c);
     rtc_pfc8563_rst(&rtc);
+    i2c_bus_rst(&i2c_bus);
     pic_set_pin_DOV(&pic, 18, 0);
     pic_set_pin_DOV(&pic, 1, 0);
     pic_set_pin_DOV(&pic, 15, 0);
@@ -828,6 +822,7 @@ void cboard_K16F::EvKeyRelease(uint key, uint mask) {
 
 void cboard_K16F::EvOnShow(void) {
     lcd.update = 1;
+    lcd.redraw = 1;
     board::EvOnShow();
 }
 
@@ -945,4 +940,42 @@ void cboard_K16F::RefreshStatus(void) {
         PICSimLab.GetStatusBar()->SetField(2, lxT("Serial: ") + lxString::FromAscii(SERIALDEVICE) + lxT(" (ERROR)"));
 }
 
+int cboard_K16F::SnapshotWrite(FILE* fout) {
+    int ret = lcd_snapshot_write(&lcd, fout);
+    ret |= rtc_pfc8563_snapshot_write(&rtc, fout);
+    ret |= snapshot_write(fout, &lcde, sizeof(lcde));
+    ret |= snapshot_write(fout, &clko, sizeof(clko));
+    ret |= snapshot_write(fout, &d, sizeof(d));
+    ret |= snapshot_write(fout, &sda, sizeof(sda));
+    ret |= snapshot_write(fout, &sck, sizeof(sck));
+    ret |= mi2c_snapshot_write(&mi2c, fout);
+    return ret;
+}
+
+int cboard_K16F::SnapshotRead(FILE* fin) {
+    lcd_t slcd = lcd;
+    rtc_pfc8563_t srtc = rtc;
+    decltype(lcde) slcde;
+    decltype(clko) sclko;
+    decltype(d) sd;
+    decltype(sda) ssda;
+    decltype(sck) ssck;
+
+    if (lcd_snapshot_read(&slcd, fin) || rtc_pfc8563_snapshot_read(&srtc, fin) ||
+        snapshot_read(fin, &slcde, sizeof(slcde)) || snapshot_read(fin, &sclko, sizeof(sclko)) ||
+        snapshot_read(fin, &sd, sizeof(sd)) || snapshot_read(fin, &ssda, sizeof(ssda)) ||
+        snapshot_read(fin, &ssck, sizeof(ssck)) || mi2c_snapshot_read(&mi2c, fin)) {
+        return -1;
+    }
+
+    lcd = slcd;
+    rtc = srtc;
+    lcde = slcde;
+    clko = sclko;
+    d = sd;
+    sda = ssda;
+    sck = ssck;
+    return 0;
+}
+
 board_init(BOARD_K16F_Name, cboard_K16F);
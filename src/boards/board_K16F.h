@@ -28,6 +28,7 @@
 
 #include "bsim_picsim.h"
 
+#include "../devices/i2c_bus.h"
 #include "../devices/lcd_hd44780.h"
 #include "../devices/mi2c_24CXXX.h"
 #include "../devices/rtc_pfc8563.h"
@@ -42,6 +43,7 @@ private:
 
     mi2c_t mi2c;
     rtc_pfc8563_t rtc;
+    i2c_bus_t i2c_bus;  // shared by mi2c and rtc
 
     int lcde;
 
@@ -77,6 +79,8 @@ public:
     void ReadPreferences(char* name, char* value) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
+    int SnapshotWrite(FILE* fout) override;
+    int SnapshotRead(FILE* fin) override;
 };
 
 #endif /* BOARD_K16F_H */
@@ -24,6 +24,7 @@
    ######################################################################## */
 
 #include "board_McLab2.h"
+#include "../lib/board_run.h"
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
@@ -524,8 +525,10 @@ void cboard_McLab2::Draw(CDraw* draw) {
                     draw->Canvas.ChangeScale(Scale, Scale);
                 } else if (output[i].id == O_LCD) {
                     if (lcd.update) {
-                        draw->Canvas.Rectangle(1, output[i].x1 - 1, output[i].y1 - 1, output[i].x2 - output[i].x1 + 2,
-                                               output[i].y2 - output[i].y1 + 3);
+                        if (lcd.redraw) {
+                            draw->Canvas.Rectangle(1, output[i].x1 - 1, output[i].y1 - 1,
+                                                   output[i].x2 - output[i].x1 + 2, output[i].y2 - output[i].y1 + 3);
+                        }
                         lcd_draw(&lcd, &draw->Canvas, output[i].x1, output[i].y1, output[i].x2 - output[i].x1,
                                  output[i].y2 - output[i].y1, PICSimLab.GetMcuPwr());
                     }
@@ -680,7 +683,6 @@ void cboard_McLab2::Run_CPU(void) {
     const picpin* pins;
     int bret;
 
-    unsigned int alm[40];   // luminosidade media
     unsigned int alm1[40];  // luminosidade media display
     unsigned int alm2[40];  // luminosidade media display
     unsigned int alm3[40];  // luminosidade media display
@@ -689,9 +691,7 @@ void cboard_McLab2::Run_CPU(void) {
     const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
     const long int NSTEPJ = PICSimLab.GetNSTEPJ();
     const long int NSTEP = PICSimLab.GetNSTEP();
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
 
-    memset(alm, 0, 40 * sizeof(unsigned int));
     memset(alm1, 0, 40 * sizeof(unsigned int));
     memset(alm2, 0, 40 * sizeof(unsigned int));
     memset(alm3, 0, 40 * sizeof(unsigned int));
@@ -699,6 +699,8 @@ void cboard_McLab2::Run_CPU(void) {
 
     pins = pic.pins;
 
+    AlmStart(pins, pic.PINCOUNT);
+
     if (use_spare)
         SpareParts.PreProcess();
 
@@ -713,158 +715,149 @@ void cboard_McLab2::Run_CPU(void) {
     }
 
     j = JUMPSTEPS;
-    pi = 0;
     if (PICSimLab.GetMcuPwr())
-        for (i = 0; i < NSTEP; i++) {
-            if (j >= JUMPSTEPS) {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-
-                if (!bounce.do_bounce) {
-                    pic_set_pin(&pic, 33, p_BT_[0]);
-                    pic_set_pin(&pic, 34, p_BT_[1]);
-                    pic_set_pin(&pic, 35, p_BT_[2]);
-                    pic_set_pin(&pic, 36, p_BT_[3]);
-                }
+        Run_CPU_Steps(
+            NSTEP,  // repeat for number of steps in 100ms
+            [&](const long int, const int run) {
+                if (j >= JUMPSTEPS) {
+                    pic_set_pin(&pic, pic.mclr, p_RST);
+
+                    if (!bounce.do_bounce) {
+                        pic_set_pin(&pic, 33, p_BT_[0]);
+                        pic_set_pin(&pic, 34, p_BT_[1]);
+                        pic_set_pin(&pic, 35, p_BT_[2]);
+                        pic_set_pin(&pic, 36, p_BT_[3]);
+                    }
 
-                rpmc++;
-                if (rpmc > rpmstp) {
-                    rpmc = 0;
-                    pic_set_pin(&pic, 15, !pic_get_pin(&pic, 15));
+                    rpmc++;
+                    if (rpmc > rpmstp) {
+                        rpmc = 0;
+                        pic_set_pin(&pic, 15, !pic_get_pin(&pic, 15));
+                    }
                 }
-            }
 
-            if (bounce.do_bounce) {
-                bret = SWBounce_process(&bounce);
-                if (bret) {
-                    for (int pl = 0; pl < 4; pl++) {
-                        if (bounce.bounce[pl]) {
-                            if (bret == 1) {
-                                pic_set_pin(&pic, 33 + pl, !pins[33 + pl - 1].value);
-                            } else {
-                                pic_set_pin(&pic, 33 + pl, p_BT_[pl]);
+                if (bounce.do_bounce) {
+                    bret = SWBounce_process(&bounce);
+                    if (bret) {
+                        for (int pl = 0; pl < 4; pl++) {
+                            if (bounce.bounce[pl]) {
+                                if (bret == 1) {
+                                    pic_set_pin(&pic, 33 + pl, !pins[33 + pl - 1].value);
+                                } else {
+                                    pic_set_pin(&pic, 33 + pl, p_BT_[pl]);
+                                }
                             }
                         }
                     }
                 }
-            }
 
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-
-            if (ioupdated) {
-                if (!bounce.do_bounce) {
-                    pic_set_pin(&pic, 33, p_BT_[0]);
-                    pic_set_pin(&pic, 34, p_BT_[1]);
-                    pic_set_pin(&pic, 35, p_BT_[2]);
-                    pic_set_pin(&pic, 36, p_BT_[3]);
+                if (run)
+                    PicStep();
+                ioupdated = pic.ioupdated;
+                InstCounterInc();
+
+                if (ioupdated) {
+                    if (!bounce.do_bounce) {
+                        pic_set_pin(&pic, 33, p_BT_[0]);
+                        pic_set_pin(&pic, 34, p_BT_[1]);
+                        pic_set_pin(&pic, 35, p_BT_[2]);
+                        pic_set_pin(&pic, 36, p_BT_[3]);
+                    }
                 }
-            }
+            },
+            [&](const long int) {
+                if (j >= JUMPSTEPS) {
+                    for (pj = 18; pj < 30; pj++) {
+                        pinv = pins[pj].value;
+                        if ((pinv) && (pins[39].value))
+                            alm1[pj]++;
+                        if ((pinv) && (pins[38].value))
+                            alm2[pj]++;
+                        if ((pinv) && (pins[37].value))
+                            alm3[pj]++;
+                        if ((pinv) && (pins[36].value))
+                            alm4[pj]++;
+                    }
 
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS) {
-                for (pj = 18; pj < 30; pj++) {
-                    pinv = pins[pj].value;
-                    if ((pinv) && (pins[39].value))
-                        alm1[pj]++;
-                    if ((pinv) && (pins[38].value))
-                        alm2[pj]++;
-                    if ((pinv) && (pins[37].value))
-                        alm3[pj]++;
-                    if ((pinv) && (pins[36].value))
-                        alm4[pj]++;
+                    j = -1;
                 }
+                j++;
 
-                j = -1;
-            }
-            j++;
-
-            // potênciometro p2
-            // p2 rc circuit
-
-            if (!pins[2].dir) {
-                // decarga por RA1
-                vp2[1] = vp2[0] = 5 * pins[2].value;
-            }
-
-            vp2[1] = vp2[0];
+                // potênciometro p2
+                // p2 rc circuit
 
-            vp2[0] = vp2in * 0.00021 + vp2[1] * 0.99979;
+                if (!pins[2].dir) {
+                    // decarga por RA1
+                    vp2[1] = vp2[0] = 5 * pins[2].value;
+                }
 
-            if (pins[2].ptype < 3)
-                pic_set_pin(&pic, 3, vp2[0] > 1.25);
-            else
-                pic_set_apin(&pic, 3, vp2[0]);
-
-            if (ioupdated) {
-                // lcd dipins[2].dirsplay code
-                if ((!pins[8].dir) && (!pins[8].value)) {
-                    if (!lcde) {
-                        d = 0;
-                        if (pins[29].value)
-                            d |= 0x80;
-                        if (pins[28].value)
-                            d |= 0x40;
-                        if (pins[27].value)
-                            d |= 0x20;
-                        if (pins[26].value)
-                            d |= 0x10;
-                        if (pins[21].value)
-                            d |= 0x08;
-                        if (pins[20].value)
-                            d |= 0x04;
-                        if (pins[19].value)
-                            d |= 0x02;
-                        if (pins[18].value)
-                            d |= 0x01;
-
-                        if ((!pins[7].dir) && (!pins[7].value)) {
-                            lcd_cmd(&lcd, d);
-                        } else if ((!pins[7].dir) && (pins[7].value)) {
-                            lcd_data(&lcd, d);
+                vp2[1] = vp2[0];
+
+                vp2[0] = vp2in * 0.00021 + vp2[1] * 0.99979;
+
+                if (pins[2].ptype < 3)
+                    pic_set_pin(&pic, 3, vp2[0] > 1.25);
+                else
+                    pic_set_apin(&pic, 3, vp2[0]);
+
+                if (ioupdated) {
+                    // lcd dipins[2].dirsplay code
+                    if ((!pins[8].dir) && (!pins[8].value)) {
+                        if (!lcde) {
+                            d = 0;
+                            if (pins[29].value)
+                                d |= 0x80;
+                            if (pins[28].value)
+                                d |= 0x40;
+                            if (pins[27].value)
+                                d |= 0x20;
+                            if (pins[26].value)
+                                d |= 0x10;
+                            if (pins[21].value)
+                                d |= 0x08;
+                            if (pins[20].value)
+                                d |= 0x04;
+                            if (pins[19].value)
+                                d |= 0x02;
+                            if (pins[18].value)
+                                d |= 0x01;
+
+                            if ((!pins[7].dir) && (!pins[7].value)) {
+                                lcd_cmd(&lcd, d);
+                            } else if ((!pins[7].dir) && (pins[7].value)) {
+                                lcd_data(&lcd, d);
+                            }
+                            lcde = 1;
                         }
-                        lcde = 1;
-                    }
 
-                } else {
-                    lcde = 0;
-                }
+                    } else {
+                        lcde = 0;
+                    }
 
-                // i2c code
-                if (pins[22].dir) {
-                    sda = 1;
-                } else {
-                    sda = pins[22].value;
-                }
+                    // i2c code
+                    if (pins[22].dir) {
+                        sda = 1;
+                    } else {
+                        sda = pins[22].value;
+                    }
 
-                if (pins[17].dir) {
-                    sck = 1;
-                    pic_set_pin(&pic, 18, 1);
-                } else {
-                    sck = pins[17].value;
+                    if (pins[17].dir) {
+                        sck = 1;
+                        pic_set_pin(&pic, 18, 1);
+                    } else {
+                        sck = pins[17].value;
+                    }
+                    pic_set_pin(&pic, 23, mi2c_io(&mi2c, sck, sda));
                 }
-                pic_set_pin(&pic, 23, mi2c_io(&mi2c, sck, sda));
-            }
-            pic.ioupdated = 0;
-        }
+                pic.ioupdated = 0;
+            });
     // fim STEP
 
+    AlmEnd(pic.pins);
+
     for (pi = 0; pi < pic.PINCOUNT; pi++) {
         if (pic.pins[pi].port == P_VDD)
             pic.pins[pi].oavalue = 255;
-        else
-            pic.pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
 
         lm1[pi] = (int)(((600.0 * alm1[pi]) / NSTEPJ) + 30);
         lm2[pi] = (int)(((600.0 * alm2[pi]) / NSTEPJ) + 30);
@@ -1245,6 +1238,7 @@ void cboard_McLab2::EvKeyRelease(uint key, uint mask) {
 
 void cboard_McLab2::EvOnShow(void) {
     lcd.update = 1;
+    lcd.redraw = 1;
     board::EvOnShow();
 }
 
@@ -1470,4 +1464,53 @@ void cboard_McLab2::ReadPreferences(char* name, char* value) {
     }
 }
 
+int cboard_McLab2::SnapshotWrite(FILE* fout) {
+    int ret = lcd_snapshot_write(&lcd, fout);
+    ret |= snapshot_write(fout, &lcde, sizeof(lcde));
+    ret |= snapshot_write(fout, &vtc, sizeof(vtc));
+    ret |= snapshot_write(fout, &vt, sizeof(vt));
+    ret |= snapshot_write(fout, &temp, sizeof(temp));
+    ret |= snapshot_write(fout, &rpmstp, sizeof(rpmstp));
+    ret |= snapshot_write(fout, &rpmc, sizeof(rpmc));
+    ret |= snapshot_write(fout, &d, sizeof(d));
+    ret |= snapshot_write(fout, &sda, sizeof(sda));
+    ret |= snapshot_write(fout, &sck, sizeof(sck));
+    ret |= mi2c_snapshot_write(&mi2c, fout);
+    return ret;
+}
+
+int cboard_McLab2::SnapshotRead(FILE* fin) {
+    lcd_t slcd = lcd;
+    decltype(lcde) slcde;
+    decltype(vtc) svtc;
+    decltype(vt) svt;
+    decltype(temp) stemp;
+    decltype(rpmstp) srpmstp;
+    decltype(rpmc) srpmc;
+    decltype(d) sd;
+    decltype(sda) ssda;
+    decltype(sck) ssck;
+
+    if (lcd_snapshot_read(&slcd, fin) || snapshot_read(fin, &slcde, sizeof(slcde)) ||
+        snapshot_read(fin, &svtc, sizeof(svtc)) || snapshot_read(fin, &svt, sizeof(svt)) ||
+        snapshot_read(fin, &stemp, sizeof(stemp)) || snapshot_read(fin, &srpmstp, sizeof(srpmstp)) ||
+        snapshot_read(fin, &srpmc, sizeof(srpmc)) || snapshot_read(fin, &sd, sizeof(sd)) ||
+        snapshot_read(fin, &ssda, sizeof(ssda)) || snapshot_read(fin, &ssck, sizeof(ssck)) || (svt & ~1) ||
+        mi2c_snapshot_read(&mi2c, fin)) {
+        return -1;
+    }
+
+    lcd = slcd;
+    lcde = slcde;
+    vtc = svtc;
+    vt = svt;
+    memcpy(temp, stemp, sizeof(temp));
+    rpmstp = srpmstp;
+    rpmc = srpmc;
+    d = sd;
+    sda = ssda;
+    sck = ssck;
+    return 0;
+}
+
 board_init(BOARD_McLab2_Name, cboard_McLab2);
@@ -118,6 +118,8 @@ public:
     void SetScale(double scale) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
+    int SnapshotWrite(FILE* fout) override;
+    int SnapshotRead(FILE* fin) override;
     void OnTime(void);
 };
 
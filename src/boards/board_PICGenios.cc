@@ -24,6 +24,7 @@
    ######################################################################## */
 
 #include "board_PICGenios.h"
+#include "../lib/board_run.h"
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
@@ -243,6 +244,9 @@ cboard_PICGenios::cboard_PICGenios(void) : font(10, lxFONTFAMILY_TELETYPE, lxFON
     lcd_init(&lcd, 16, 2, this);
     mi2c_init(&mi2c, 4);
     rtc_ds1307_init(&rtc2, this);
+    i2c_bus_init(&i2c_bus);
+    mi2c_attach(&mi2c, &i2c_bus);
+    rtc_ds1307_I2C_attach(&rtc2, &i2c_bus);
 
     ReadMaps();
 
@@ -703,15 +707,20 @@ void cboard_PICGenios::Draw(CDraw* draw) {
                     draw->Canvas.ChangeScale(Scale, Scale);
                 } else if (output[i].id == O_LCD) {
                     if (lcd.update) {
-                        draw->Canvas.ChangeScale(1.0, 1.0);
-                        if (lcd.lnum == 2) {
-                            draw->Canvas.PutBitmap(lcdbmp[0], (output[i].x1 - 41) * Scale, (output[i].y1 - 58) * Scale);
-                        } else {
-                            draw->Canvas.PutBitmap(lcdbmp[1], (output[i].x1 - 41) * Scale, (output[i].y1 - 58) * Scale);
+                        if (lcd.redraw) {
+                            draw->Canvas.ChangeScale(1.0, 1.0);
+                            if (lcd.lnum == 2) {
+                                draw->Canvas.PutBitmap(lcdbmp[0], (output[i].x1 - 41) * Scale,
+                                                       (output[i].y1 - 58) * Scale);
+                            } else {
+                                draw->Canvas.PutBitmap(lcdbmp[1], (output[i].x1 - 41) * Scale,
+                                                       (output[i].y1 - 58) * Scale);
+                            }
+                            draw->Canvas.ChangeScale(Scale, Scale);
+                            draw->Canvas.Rectangle(1, output[i].x1 - 1, output[i].y1 - 2,
+                                                   output[i].x2 - output[i].x1 + 2,
+                                                   output[i].y2 - output[i].y1 + ((lcd.lnum == 2) ? 3 : 78));
                         }
-                        draw->Canvas.ChangeScale(Scale, Scale);
-                        draw->Canvas.Rectangle(1, output[i].x1 - 1, output[i].y1 - 2, output[i].x2 - output[i].x1 + 2,
-                                               output[i].y2 - output[i].y1 + ((lcd.lnum == 2) ? 3 : 78));
                         if (dip[0]) {
                             lcd_draw(&lcd, &draw->Canvas, output[i].x1, output[i].y1, output[i].x2 - output[i].x1,
                                      output[i].y2 - output[i].y1, PICSimLab.GetMcuPwr());
@@ -952,12 +961,11 @@ void cboard_PICGenios::OnTime(void) {
 void cboard_PICGenios::Run_CPU(void) {
     int i;
     int j;
-    unsigned char pi, pj;
+    unsigned char pj;
     unsigned char pinv;
     const picpin* pins;
     int bret;
 
-    unsigned int alm[40];   // luminosidade media
     unsigned int alm1[40];  // luminosidade media display
     unsigned int alm2[40];  // luminosidade media display
     unsigned int alm3[40];  // luminosidade media display
@@ -966,12 +974,10 @@ void cboard_PICGenios::Run_CPU(void) {
     const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
     const long int NSTEPJ = PICSimLab.GetNSTEPJ();
     const long int NSTEP = PICSimLab.GetNSTEP();
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
 
     if (use_spare)
         SpareParts.PreProcess();
 
-    memset(alm, 0, 40 * sizeof(unsigned int));
     memset(alm1, 0, 40 * sizeof(unsigned int));
     memset(alm2, 0, 40 * sizeof(unsigned int));
     memset(alm3, 0, 40 * sizeof(unsigned int));
@@ -979,6 +985,8 @@ void cboard_PICGenios::Run_CPU(void) {
 
     pins = pic.pins;
 
+    AlmStart(pins, pic.PINCOUNT);
+
     unsigned char p_BT_[7];
     memcpy(p_BT_, p_BT, 7);
 
@@ -1012,236 +1020,229 @@ void cboard_PICGenios::Run_CPU(void) {
     }
 
     j = JUMPSTEPS;
-    pi = 0;
     if (PICSimLab.GetMcuPwr())
-        for (i = 0; i < NSTEP; i++) {
-            if (j >= JUMPSTEPS) {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-
-                if (!bounce.do_bounce) {
-                    pic_set_pin(&pic, 33, p_BT_[0]);
-                    pic_set_pin(&pic, 34, p_BT_[1]);
-                    pic_set_pin(&pic, 35, p_BT_[2]);
-                    pic_set_pin(&pic, 36, p_BT_[3]);
-                    pic_set_pin(&pic, 37, p_BT_[4]);
-                    pic_set_pin(&pic, 38, p_BT_[5]);
-                    pic_set_pin(&pic, 7, p_BT_[6]);
-                }
+        Run_CPU_Steps(
+            NSTEP,  // repeat for number of steps in 100ms
+            [&](const long int, const int run) {
+                if (j >= JUMPSTEPS) {
+                    pic_set_pin(&pic, pic.mclr, p_RST);
+
+                    if (!bounce.do_bounce) {
+                        pic_set_pin(&pic, 33, p_BT_[0]);
+                        pic_set_pin(&pic, 34, p_BT_[1]);
+                        pic_set_pin(&pic, 35, p_BT_[2]);
+                        pic_set_pin(&pic, 36, p_BT_[3]);
+                        pic_set_pin(&pic, 37, p_BT_[4]);
+                        pic_set_pin(&pic, 38, p_BT_[5]);
+                        pic_set_pin(&pic, 7, p_BT_[6]);
+                    }
 
-                /*
-                    pic_set_pin(&pic, 39, 1);
-                    pic_set_pin(&pic, 40, 1);
-                    pic_set_pin(&pic, 19,1);
-                    pic_set_pin(&pic, 20,1);
-                    pic_set_pin(&pic, 21,1);
-                    pic_set_pin(&pic, 22,1);
-                    pic_set_pin(&pic, 27,1);
-                    pic_set_pin(&pic, 28,1);
-                    pic_set_pin(&pic, 29,1);
-                    pic_set_pin(&pic, 30,1);
-                     */
-
-                // keyboard
-
-                if (p_KEY[0]) {
-                    pic_set_pin(&pic, 22, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 22));
-                }
+                    /*
+                        pic_set_pin(&pic, 39, 1);
+                        pic_set_pin(&pic, 40, 1);
+                        pic_set_pin(&pic, 19,1);
+                        pic_set_pin(&pic, 20,1);
+                        pic_set_pin(&pic, 21,1);
+                        pic_set_pin(&pic, 22,1);
+                        pic_set_pin(&pic, 27,1);
+                        pic_set_pin(&pic, 28,1);
+                        pic_set_pin(&pic, 29,1);
+                        pic_set_pin(&pic, 30,1);
+                         */
+
+                    // keyboard
+
+                    if (p_KEY[0]) {
+                        pic_set_pin(&pic, 22, pic_get_pin(&pic, 33));
+                        pic_set_pin(&pic, 33, pic_get_pin(&pic, 22));
+                    }
 
-                if (p_KEY[1]) {
-                    pic_set_pin(&pic, 22, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 22));
-                }
+                    if (p_KEY[1]) {
+                        pic_set_pin(&pic, 22, pic_get_pin(&pic, 34));
+                        pic_set_pin(&pic, 34, pic_get_pin(&pic, 22));
+                    }
 
-                if (p_KEY[2]) {
-                    pic_set_pin(&pic, 22, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 22));
-                }
+                    if (p_KEY[2]) {
+                        pic_set_pin(&pic, 22, pic_get_pin(&pic, 35));
+                        pic_set_pin(&pic, 35, pic_get_pin(&pic, 22));
+                    }
 
-                if (p_KEY[3]) {
-                    pic_set_pin(&pic, 21, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 21));
-                }
+                    if (p_KEY[3]) {
+                        pic_set_pin(&pic, 21, pic_get_pin(&pic, 33));
+                        pic_set_pin(&pic, 33, pic_get_pin(&pic, 21));
+                    }
 
-                if (p_KEY[4]) {
-                    pic_set_pin(&pic, 21, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 21));
-                }
+                    if (p_KEY[4]) {
+                        pic_set_pin(&pic, 21, pic_get_pin(&pic, 34));
+                        pic_set_pin(&pic, 34, pic_get_pin(&pic, 21));
+                    }
 
-                if (p_KEY[5]) {
-                    pic_set_pin(&pic, 21, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 21));
-                }
+                    if (p_KEY[5]) {
+                        pic_set_pin(&pic, 21, pic_get_pin(&pic, 35));
+                        pic_set_pin(&pic, 35, pic_get_pin(&pic, 21));
+                    }
 
-                if (p_KEY[6]) {
-                    pic_set_pin(&pic, 20, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 20));
-                }
+                    if (p_KEY[6]) {
+                        pic_set_pin(&pic, 20, pic_get_pin(&pic, 33));
+                        pic_set_pin(&pic, 33, pic_get_pin(&pic, 20));
+                    }
 
-                if (p_KEY[7]) {
-                    pic_set_pin(&pic, 20, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 20));
-                }
+                    if (p_KEY[7]) {
+                        pic_set_pin(&pic, 20, pic_get_pin(&pic, 34));
+                        pic_set_pin(&pic, 34, pic_get_pin(&pic, 20));
+                    }
 
-                if (p_KEY[8]) {
-                    pic_set_pin(&pic, 20, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 20));
-                }
+                    if (p_KEY[8]) {
+                        pic_set_pin(&pic, 20, pic_get_pin(&pic, 35));
+                        pic_set_pin(&pic, 35, pic_get_pin(&pic, 20));
+                    }
 
-                if (p_KEY[9]) {
-                    pic_set_pin(&pic, 19, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 19));
-                }
+                    if (p_KEY[9]) {
+                        pic_set_pin(&pic, 19, pic_get_pin(&pic, 33));
+                        pic_set_pin(&pic, 33, pic_get_pin(&pic, 19));
+                    }
 
-                if (p_KEY[10]) {
-                    pic_set_pin(&pic, 19, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 19));
-                }
+                    if (p_KEY[10]) {
+                        pic_set_pin(&pic, 19, pic_get_pin(&pic, 34));
+                        pic_set_pin(&pic, 34, pic_get_pin(&pic, 19));
+                    }
 
-                if (p_KEY[11]) {
-                    pic_set_pin(&pic, 19, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 19));
-                }
+                    if (p_KEY[11]) {
+                        pic_set_pin(&pic, 19, pic_get_pin(&pic, 35));
+                        pic_set_pin(&pic, 35, pic_get_pin(&pic, 19));
+                    }
 
-                if (dip[14]) {
-                    if (cooler_pwr > 55) {
-                        rpmc++;
-                        if (rpmc > rpmstp) {
-                            rpmc = 0;
-                            pic_set_pin(&pic, 15, !pins[14].value);
-                        }
-                    } else
-                        pic_set_pin(&pic, 15, 0);
+                    if (dip[14]) {
+                        if (cooler_pwr > 55) {
+                            rpmc++;
+                            if (rpmc > rpmstp) {
+                                rpmc = 0;
+                                pic_set_pin(&pic, 15, !pins[14].value);
+                            }
+                        } else
+                            pic_set_pin(&pic, 15, 0);
+                    }
                 }
-            }
 
-            if (bounce.do_bounce) {
-                bret = SWBounce_process(&bounce);
-                if (bret) {
-                    for (int pl = 0; pl < 6; pl++) {
-                        if (bounce.bounce[pl]) {
+                if (bounce.do_bounce) {
+                    bret = SWBounce_process(&bounce);
+                    if (bret) {
+                        for (int pl = 0; pl < 6; pl++) {
+                            if (bounce.bounce[pl]) {
+                                if (bret == 1) {
+                                    pic_set_pin(&pic, 33 + pl, !pins[33 + pl - 1].value);
+                                } else {
+                                    pic_set_pin(&pic, 33 + pl, p_BT_[pl]);
+                                }
+                            }
+                        }
+                        if (bounce.bounce[6]) {
                             if (bret == 1) {
-                                pic_set_pin(&pic, 33 + pl, !pins[33 + pl - 1].value);
+                                pic_set_pin(&pic, 7, !pins[7 - 1].value);
                             } else {
-                                pic_set_pin(&pic, 33 + pl, p_BT_[pl]);
+                                pic_set_pin(&pic, 7, p_BT_[6]);
                             }
                         }
                     }
-                    if (bounce.bounce[6]) {
-                        if (bret == 1) {
-                            pic_set_pin(&pic, 7, !pins[7 - 1].value);
-                        } else {
-                            pic_set_pin(&pic, 7, p_BT_[6]);
-                        }
-                    }
-                }
-            }
-
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS) {
-                for (pj = 18; pj < 30; pj++) {
-                    pinv = pins[pj].value;
-                    if ((pinv) && (pins[3].value) && (dip[10]))
-                        alm1[pj]++;
-                    if ((pinv) && (pins[4].value) && (dip[11]))
-                        alm2[pj]++;
-                    if ((pinv) && (pins[5].value) && (dip[12]))
-                        alm3[pj]++;
-                    if ((pinv) && (pins[6].value) && (dip[13]))
-                        alm4[pj]++;
                 }
 
-                if (dip[7])
-                    alm[32] = 0;
+                if (run)
+                    PicStep();
+                ioupdated = pic.ioupdated;
+                InstCounterInc();
+            },
+            [&](const long int) {
+                if (j >= JUMPSTEPS) {
+                    for (pj = 18; pj < 30; pj++) {
+                        pinv = pins[pj].value;
+                        if ((pinv) && (pins[3].value) && (dip[10]))
+                            alm1[pj]++;
+                        if ((pinv) && (pins[4].value) && (dip[11]))
+                            alm2[pj]++;
+                        if ((pinv) && (pins[5].value) && (dip[12]))
+                            alm3[pj]++;
+                        if ((pinv) && (pins[6].value) && (dip[13]))
+                            alm4[pj]++;
+                    }
 
-                // potenciometro p1 e p2
-                if (dip[18])
-                    pic_set_apin(&pic, 2, vp1in);
-                if (dip[19])
-                    pic_set_apin(&pic, 3, vp2in);
+                    // potenciometro p1 e p2
+                    if (dip[18])
+                        pic_set_apin(&pic, 2, vp1in);
+                    if (dip[19])
+                        pic_set_apin(&pic, 3, vp2in);
 
-                j = -1;
-            }
-            j++;
-
-            if (ioupdated) {
-                // lcd dipins[2].display code
-
-                if ((!pins[8].dir) && (!pins[8].value)) {
-                    if (!lcde) {
-                        d = 0;
-                        if (pins[29].value)
-                            d |= 0x80;
-                        if (pins[28].value)
-                            d |= 0x40;
-                        if (pins[27].value)
-                            d |= 0x20;
-                        if (pins[26].value)
-                            d |= 0x10;
-                        if (pins[21].value)
-                            d |= 0x08;
-                        if (pins[20].value)
-                            d |= 0x04;
-                        if (pins[19].value)
-                            d |= 0x02;
-                        if (pins[18].value)
-                            d |= 0x01;
-
-                        if ((!pins[9].dir) && (!pins[9].value)) {
-                            lcd_cmd(&lcd, d);
-                        } else if ((!pins[9].dir) && (pins[9].value)) {
-                            lcd_data(&lcd, d);
+                    j = -1;
+                }
+                j++;
+
+                if (ioupdated) {
+                    // lcd dipins[2].display code
+
+                    if ((!pins[8].dir) && (!pins[8].value)) {
+                        if (!lcde) {
+                            d = 0;
+                            if (pins[29].value)
+                                d |= 0x80;
+                            if (pins[28].value)
+                                d |= 0x40;
+                            if (pins[27].value)
+                                d |= 0x20;
+                            if (pins[26].value)
+                                d |= 0x10;
+                            if (pins[21].value)
+                                d |= 0x08;
+                            if (pins[20].value)
+                                d |= 0x04;
+                            if (pins[19].value)
+                                d |= 0x02;
+                            if (pins[18].value)
+                                d |= 0x01;
+
+                            if ((!pins[9].dir) && (!pins[9].value)) {
+                                lcd_cmd(&lcd, d);
+                            } else if ((!pins[9].dir) && (pins[9].value)) {
+                                lcd_data(&lcd, d);
+                            }
+                            lcde = 1;
                         }
-                        lcde = 1;
+                    } else {
+                        lcde = 0;
                     }
-                } else {
-                    lcde = 0;
-                }
-                // end display code
+                    // end display code
 
-                // i2c code
-                if (pins[22].dir) {
-                    sda = 1;
-                } else {
-                    sda = pins[22].value;
-                }
+                    // i2c code
+                    if (pins[22].dir) {
+                        sda = 1;
+                    } else {
+                        sda = pins[22].value;
+                    }
 
-                if (pins[17].dir) {
-                    sck = 1;
-                    if (dip[5]) {
-                        pic_set_pin(&pic, 18, 1);
+                    if (pins[17].dir) {
+                        sck = 1;
+                        if (dip[5]) {
+                            pic_set_pin(&pic, 18, 1);
+                        }
+                    } else {
+                        sck = pins[17].value;
+                    }
+                    if (dip[6]) {
+                        pic_set_pin(&pic, 23, i2c_bus_io(&i2c_bus, sck, sda));
                     }
-                } else {
-                    sck = pins[17].value;
-                }
-                if (dip[6]) {
-                    pic_set_pin(&pic, 23, mi2c_io(&mi2c, sck, sda) & rtc_ds1307_I2C_io(&rtc2, sck, sda));
                 }
-            }
-            pic.ioupdated = 0;
-        }
+                pic.ioupdated = 0;
+            });
 
     // fim STEP
 
+    AlmEnd(pic.pins);
+
+    // RB0 mean value disabled by dip switch
+    if (dip[7])
+        pic.pins[32].oavalue = 55;
+
     for (i = 0; i < pic.PINCOUNT; i++) {
         if (pic.pins[i].port == P_VDD)
             pic.pins[i].oavalue = 255;
-        else
-            pic.pins[i].oavalue = (int)((alm[i] * RNSTEP) + 55);
 
         lm1[i] = (int)(((600.0 * alm1[i]) / NSTEPJ) + 30);
         lm2[i] = (int)(((600.0 * alm2[i]) / NSTEPJ) + 30);
@@ -1316,6 +1317,7 @@ void cboard_PICGenios::Reset(void) {
     lcd_rst(&lcd);
     mi2c_rst(&mi2c);
     rtc_ds1307_rst(&rtc2);
+    i2c_bus_rst(&i2c_bus);
 
     p_BT[0] = 1;
     p_BT[1] = 1;
@@ -1513,6 +1515,8 @@ void cboard_PICGenios::EvMouseButtonPress(uint button, uint x, uint y, uint stat
                 case I_D01: {
                     dip[0] ^= 0x01;
                     output_ids[O_D01]->update = 1;
+                    lcd.update = 1;
+                    lcd.redraw = 1;
 
                     output_ids[O_LCD]->update = 1;
                 } break;
@@ -2060,6 +2064,7 @@ void cboard_PICGenios::EvKeyRelease(uint key, uint mask) {
 
 void cboard_PICGenios::EvOnShow(void) {
     lcd.update = 1;
+    lcd.redraw = 1;
     board::EvOnShow();
 }
 
@@ -2499,4 +2504,56 @@ void cboard_PICGenios::board_Event(CControl* control) {
     }
 }
 
+int cboard_PICGenios::SnapshotWrite(FILE* fout) {
+    int ret = lcd_snapshot_write(&lcd, fout);
+    ret |= rtc_ds1307_snapshot_write(&rtc2, fout);
+    ret |= snapshot_write(fout, &lcde, sizeof(lcde));
+    ret |= snapshot_write(fout, &vtc, sizeof(vtc));
+    ret |= snapshot_write(fout, &vt, sizeof(vt));
+    ret |= snapshot_write(fout, &temp, sizeof(temp));
+    ret |= snapshot_write(fout, &rpmstp, sizeof(rpmstp));
+    ret |= snapshot_write(fout, &rpmc, sizeof(rpmc));
+    ret |= snapshot_write(fout, &d, sizeof(d));
+    ret |= snapshot_write(fout, &sda, sizeof(sda));
+    ret |= snapshot_write(fout, &sck, sizeof(sck));
+    ret |= mi2c_snapshot_write(&mi2c, fout);
+    return ret;
+}
+
+int cboard_PICGenios::SnapshotRead(FILE* fin) {
+    lcd_t slcd = lcd;
+    rtc_ds1307_t srtc2 = rtc2;
+    decltype(lcde) slcde;
+    decltype(vtc) svtc;
+    decltype(vt) svt;
+    decltype(temp) stemp;
+    decltype(rpmstp) srpmstp;
+    decltype(rpmc) srpmc;
+    decltype(d) sd;
+    decltype(sda) ssda;
+    decltype(sck) ssck;
+
+    if (lcd_snapshot_read(&slcd, fin) || rtc_ds1307_snapshot_read(&srtc2, fin) ||
+        snapshot_read(fin, &slcde, sizeof(slcde)) || snapshot_read(fin, &svtc, sizeof(svtc)) ||
+        snapshot_read(fin, &svt, sizeof(svt)) || snapshot_read(fin, &stemp, sizeof(stemp)) ||
+        snapshot_read(fin, &srpmstp, sizeof(srpmstp)) || snapshot_read(fin, &srpmc, sizeof(srpmc)) ||
+        snapshot_read(fin, &sd, sizeof(sd)) || snapshot_read(fin, &ssda, sizeof(ssda)) ||
+        snapshot_read(fin, &ssck, sizeof(ssck)) || (svt & ~1) || mi2c_snapshot_read(&mi2c, fin)) {
+        return -1;
+    }
+
+    lcd = slcd;
+    rtc2 = srtc2;
+    lcde = slcde;
+    vtc = svtc;
+    vt = svt;
+    memcpy(temp, stemp, sizeof(temp));
+    rpmstp = srpmstp;
+    rpmc = srpmc;
+    d = sd;
+    sda = ssda;
+    sck = ssck;
+    return 0;
+}
+
 board_init(BOARD_PICGenios_Name, cboard_PICGenios);
@@ -26,6 +26,7 @@
 #ifndef BOARD_PICGenios_H
 #define BOARD_PICGenios_H
 
+#include "../devices/i2c_bus.h"
 #include "../devices/lcd_hd44780.h"
 #include "../devices/mi2c_24CXXX.h"
 #include "../devices/rtc_ds1307.h"
@@ -50,6 +51,7 @@ private:
 
     mi2c_t mi2c;
     rtc_ds1307_t rtc2;
+    i2c_bus_t i2c_bus;  // shared by mi2c and rtc2
 
     int lcde;
 
@@ -129,6 +131,8 @@ public:
     void ReadPreferences(char* name, char* value) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
+    int SnapshotWrite(FILE* fout) override;
+    int SnapshotRead(FILE* fin) override;
     void board_Event(CControl* control) override;
     void SetScale(double scale) override;
     void OnTime(void);
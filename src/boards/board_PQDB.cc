@@ -23,6 +23,7 @@
    For e-mail suggestions :  lcgamboa@yahoo.com
    ######################################################################## */
 
+#include "../lib/board_run.h"
 #include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
@@ -477,8 +478,10 @@ void cboard_PQDB::Draw(CDraw* draw) {
                     draw->Canvas.Circle(1, output[i].cx + x, output[i].cy + y, 3);
                 } else if (output[i].id == O_LCD) {  // draw lcd text
                     // strech lcd background
-                    draw->Canvas.Rectangle(1, output[i].x1 - 15, output[i].y1 - 5, output[i].x2 - output[i].x1 + 32,
-                                           output[i].y2 - output[i].y1 + 13);
+                    if (lcd.redraw) {
+                        draw->Canvas.Rectangle(1, output[i].x1 - 15, output[i].y1 - 5,
+                                               output[i].x2 - output[i].x1 + 32, output[i].y2 - output[i].y1 + 13);
+                    }
                     lcd_draw(&lcd, &draw->Canvas, output[i].x1, output[i].y1, output[i].x2 - output[i].x1,
                              output[i].y2 - output[i].y1, PICSimLab.GetMcuPwr());
                 } else if (output[i].id == O_MP) {
@@ -567,195 +570,180 @@ void cboard_PQDB::Draw(CDraw* draw) {
 void cboard_PQDB::Run_CPU(void) {
     int i;
     int j;
-    int pi;
     const picpin* pins;
 
-    unsigned int alm[40];  // valor médio dos pinos de IO
-
     unsigned int alm7seg[32];  // luminosidade media display 7 seg
 
     const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
     const long int NSTEP = PICSimLab.GetNSTEP();
-    const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
 
     if (use_spare)
         SpareParts.PreProcess();
 
     memset(alm7seg, 0, 32 * sizeof(unsigned int));
 
-    memset(alm, 0, 40 * sizeof(unsigned int));
-
     memset(shiftReg_alm, 0, 8 * sizeof(unsigned long));
 
     pins = pic.pins;
 
+    AlmStart(pins, pic.PINCOUNT);
+
     j = JUMPSTEPS;
-    pi = 0;
     if (PICSimLab.GetMcuPwr()) {
-        for (i = 0; i < NSTEP; i++) {
-            if (j >= JUMPSTEPS) {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-
-                // keyboard
-                // D3-7 do shiftReg
-                // 0-9: UDLRS sABXY
-                if (pins[KEYPAD_1_PIN].dir) {
-                    if ((p_KEY[0] && (shiftReg.out & SRD3)) || (p_KEY[1] && (shiftReg.out & SRD4)) ||
-                        (p_KEY[2] && (shiftReg.out & SRD5)) || (p_KEY[3] && (shiftReg.out & SRD6)) ||
-                        (p_KEY[4] && (shiftReg.out & SRD7))) {
-                        pic_set_pin(&pic, KEYPAD_1_PIN + 1, 1);
-                    } else {
-                        pic_set_pin(&pic, KEYPAD_1_PIN + 1, 0);
+        Run_CPU_Steps(
+            NSTEP,  // repeat for number of steps in 100ms
+            [&](const long int, const int run) {
+                if (j >= JUMPSTEPS) {
+                    pic_set_pin(&pic, pic.mclr, p_RST);
+
+                    // keyboard
+                    // D3-7 do shiftReg
+                    // 0-9: UDLRS sABXY
+                    if (pins[KEYPAD_1_PIN].dir) {
+                        if ((p_KEY[0] && (shiftReg.out & SRD3)) || (p_KEY[1] && (shiftReg.out & SRD4)) ||
+                            (p_KEY[2] && (shiftReg.out & SRD5)) || (p_KEY[3] && (shiftReg.out & SRD6)) ||
+                            (p_KEY[4] && (shiftReg.out & SRD7))) {
+                            pic_set_pin(&pic, KEYPAD_1_PIN + 1, 1);
+                        } else {
+                            pic_set_pin(&pic, KEYPAD_1_PIN + 1, 0);
+                        }
                     }
-                }
-                if (pins[KEYPAD_2_PIN].dir) {
-                    if ((p_KEY[5] && (shiftReg.out & SRD3)) || (p_KEY[6] && (shiftReg.out & SRD4)) ||
-                        (p_KEY[7] && (shiftReg.out & SRD5)) || (p_KEY[8] && (shiftReg.out & SRD6)) ||
-                        (p_KEY[9] && (shiftReg.out & SRD7))) {
-                        pic_set_pin(&pic, KEYPAD_2_PIN + 1, 1);
-                    } else {
-                        pic_set_pin(&pic, KEYPAD_2_PIN + 1, 0);
+                    if (pins[KEYPAD_2_PIN].dir) {
+                        if ((p_KEY[5] && (shiftReg.out & SRD3)) || (p_KEY[6] && (shiftReg.out & SRD4)) ||
+                            (p_KEY[7] && (shiftReg.out & SRD5)) || (p_KEY[8] && (shiftReg.out & SRD6)) ||
+                            (p_KEY[9] && (shiftReg.out & SRD7))) {
+                            pic_set_pin(&pic, KEYPAD_2_PIN + 1, 1);
+                        } else {
+                            pic_set_pin(&pic, KEYPAD_2_PIN + 1, 0);
+                        }
                     }
                 }
-            }
 
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-
-            if (ioupdated) {
-                // keyboard
-                // D3-7 do shiftReg
-                // 0-9: UDLRS sABXY
-                if (pins[KEYPAD_1_PIN].dir) {
-                    if ((p_KEY[0] && (shiftReg.out & SRD3)) || (p_KEY[1] && (shiftReg.out & SRD4)) ||
-                        (p_KEY[2] && (shiftReg.out & SRD5)) || (p_KEY[3] && (shiftReg.out & SRD6)) ||
-                        (p_KEY[4] && (shiftReg.out & SRD7))) {
-                        pic_set_pin(&pic, KEYPAD_1_PIN + 1, 1);
-                    } else {
-                        pic_set_pin(&pic, KEYPAD_1_PIN + 1, 0);
+                if (run)
+                    PicStep();
+                ioupdated = pic.ioupdated;
+                InstCounterInc();
+
+                if (ioupdated) {
+                    // keyboard
+                    // D3-7 do shiftReg
+                    // 0-9: UDLRS sABXY
+                    if (pins[KEYPAD_1_PIN].dir) {
+                        if ((p_KEY[0] && (shiftReg.out & SRD3)) || (p_KEY[1] && (shiftReg.out & SRD4)) ||
+                            (p_KEY[2] && (shiftReg.out & SRD5)) || (p_KEY[3] && (shiftReg.out & SRD6)) ||
+                            (p_KEY[4] && (shiftReg.out & SRD7))) {
+                            pic_set_pin(&pic, KEYPAD_1_PIN + 1, 1);
+                        } else {
+                            pic_set_pin(&pic, KEYPAD_1_PIN + 1, 0);
+                        }
                     }
-                }
-                if (pins[KEYPAD_2_PIN].dir) {
-                    if ((p_KEY[5] && (shiftReg.out & SRD3)) || (p_KEY[6] && (shiftReg.out & SRD4)) ||
-                        (p_KEY[7] && (shiftReg.out & SRD5)) || (p_KEY[8] && (shiftReg.out & SRD6)) ||
-                        (p_KEY[9] && (shiftReg.out & SRD7))) {
-                        pic_set_pin(&pic, KEYPAD_2_PIN + 1, 1);
-                    } else {
-                        pic_set_pin(&pic, KEYPAD_2_PIN + 1, 0);
+                    if (pins[KEYPAD_2_PIN].dir) {
+                        if ((p_KEY[5] && (shiftReg.out & SRD3)) || (p_KEY[6] && (shiftReg.out & SRD4)) ||
+                            (p_KEY[7] && (shiftReg.out & SRD5)) || (p_KEY[8] && (shiftReg.out & SRD6)) ||
+                            (p_KEY[9] && (shiftReg.out & SRD7))) {
+                            pic_set_pin(&pic, KEYPAD_2_PIN + 1, 1);
+                        } else {
+                            pic_set_pin(&pic, KEYPAD_2_PIN + 1, 0);
+                        }
                     }
                 }
-            }
-
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS) {
-                // contabilizando a média do 7 segmentos
-                for (int iDisp = DISP_1_PIN; iDisp <= DISP_4_PIN; iDisp++) {
-                    if (pins[iDisp].value && !pins[iDisp].dir) {
-                        for (int iSeg = 0; iSeg < 8; iSeg++) {
-                            if (shiftReg.out & (1 << iSeg)) {
-                                alm7seg[(iDisp - DISP_1_PIN) * 8 + iSeg]++;
+            },
+            [&](const long int) {
+                if (j >= JUMPSTEPS) {
+                    // contabilizando a média do 7 segmentos
+                    for (int iDisp = DISP_1_PIN; iDisp <= DISP_4_PIN; iDisp++) {
+                        if (pins[iDisp].value && !pins[iDisp].dir) {
+                            for (int iSeg = 0; iSeg < 8; iSeg++) {
+                                if (shiftReg.out & (1 << iSeg)) {
+                                    alm7seg[(iDisp - DISP_1_PIN) * 8 + iSeg]++;
+                                }
                             }
                         }
                     }
-                }
 
-                alm[32] = 0;
-
-                // potenciometro
-                pic_set_apin(&pic, POT_PIN + 1, vPOT);  // pot
-                pic_set_apin(&pic, LDR_PIN + 1, vLDR);  // ldr
-                pic_set_apin(&pic, LM_PIN + 1, vLM);    // temp
-
-                // valor medio shift register
-                if (pic.pins[pic.PINCOUNT].value)
-                    shiftReg_alm[0]++;
-                if (pic.pins[pic.PINCOUNT + 1].value)
-                    shiftReg_alm[1]++;
-                if (pic.pins[pic.PINCOUNT + 2].value)
-                    shiftReg_alm[2]++;
-                if (pic.pins[pic.PINCOUNT + 3].value)
-                    shiftReg_alm[3]++;
-                if (pic.pins[pic.PINCOUNT + 4].value)
-                    shiftReg_alm[4]++;
-                if (pic.pins[pic.PINCOUNT + 5].value)
-                    shiftReg_alm[5]++;
-                if (pic.pins[pic.PINCOUNT + 6].value)
-                    shiftReg_alm[6]++;
-                if (pic.pins[pic.PINCOUNT + 7].value)
-                    shiftReg_alm[7]++;
-
-                j = -1;
-            }
-            j++;
-
-            if (ioupdated) {
-                // lcd display code
-                if ((!pins[LCD_EN_PIN].dir) && (!pins[LCD_EN_PIN].value)) {
-                    if (!lcde) {
-                        d = (shiftReg.out & 0x0f) << 4;
-
-                        if ((!pins[LCD_RS_PIN].dir) && (!pins[LCD_RS_PIN].value)) {
-                            lcd_cmd(&lcd, d);
-                        } else if ((!pins[LCD_RS_PIN].dir) && (pins[LCD_RS_PIN].value)) {
-                            lcd_data(&lcd, d);
+                    // potenciometro
+                    pic_set_apin(&pic, POT_PIN + 1, vPOT);  // pot
+                    pic_set_apin(&pic, LDR_PIN + 1, vLDR);  // ldr
+                    pic_set_apin(&pic, LM_PIN + 1, vLM);    // temp
+
+                    // valor medio shift register
+                    if (pic.pins[pic.PINCOUNT].value)
+                        shiftReg_alm[0]++;
+                    if (pic.pins[pic.PINCOUNT + 1].value)
+                        shiftReg_alm[1]++;
+                    if (pic.pins[pic.PINCOUNT + 2].value)
+                        shiftReg_alm[2]++;
+                    if (pic.pins[pic.PINCOUNT + 3].value)
+                        shiftReg_alm[3]++;
+                    if (pic.pins[pic.PINCOUNT + 4].value)
+                        shiftReg_alm[4]++;
+                    if (pic.pins[pic.PINCOUNT + 5].value)
+                        shiftReg_alm[5]++;
+                    if (pic.pins[pic.PINCOUNT + 6].value)
+                        shiftReg_alm[6]++;
+                    if (pic.pins[pic.PINCOUNT + 7].value)
+                        shiftReg_alm[7]++;
+
+                    j = -1;
+                }
+                j++;
+
+                if (ioupdated) {
+                    // lcd display code
+                    if ((!pins[LCD_EN_PIN].dir) && (!pins[LCD_EN_PIN].value)) {
+                        if (!lcde) {
+                            d = (shiftReg.out & 0x0f) << 4;
+
+                            if ((!pins[LCD_RS_PIN].dir) && (!pins[LCD_RS_PIN].value)) {
+                                lcd_cmd(&lcd, d);
+                            } else if ((!pins[LCD_RS_PIN].dir) && (pins[LCD_RS_PIN].value)) {
+                                lcd_data(&lcd, d);
+                            }
+                            lcde = 1;
                         }
-                        lcde = 1;
+                    } else {
+                        lcde = 0;
                     }
-                } else {
-                    lcde = 0;
-                }
-                // end display code
+                    // end display code
 
-                // ds1307 over i2c code
-                if (pins[SDA_PIN].dir) {
-                    sda = 1;
-                } else {
-                    sda = pins[SDA_PIN].value;
-                }
-                if (pins[SCL_PIN].dir) {
-                    sck = 1;
-                    pic_set_pin(&pic, SCL_PIN + 1, 1);
-                } else {
-                    sck = pins[SCL_PIN].value;
-                }
-                pic_set_pin(&pic, SDA_PIN + 1, rtc_ds1307_I2C_io(&rtc2, sck, sda));
+                    // ds1307 over i2c code
+                    if (pins[SDA_PIN].dir) {
+                        sda = 1;
+                    } else {
+                        sda = pins[SDA_PIN].value;
+                    }
+                    if (pins[SCL_PIN].dir) {
+                        sck = 1;
+                        pic_set_pin(&pic, SCL_PIN + 1, 1);
+                    } else {
+                        sck = pins[SCL_PIN].value;
+                    }
+                    pic_set_pin(&pic, SDA_PIN + 1, rtc_ds1307_I2C_io(&rtc2, sck, sda));
 
-                // 74hc595 code
-                if (pins[SO_DATA_PIN].dir == 0) {
-                    srDATA = pins[SO_DATA_PIN].value;
-                }
-                if (pins[SO_CLK_PIN].dir == 0) {
-                    srCLK = pins[SO_CLK_PIN].value;
-                }
-                if (pins[SO_EN_PIN].dir == 0) {
-                    srLAT = pins[SO_EN_PIN].value;
-                }
-                unsigned short ret = io_74xx595_io(&shiftReg, srDATA, srCLK, srLAT, 1);
-                if (_srret != ret) {
-                    pic.pins[PSRD0].value = (ret & 0x01) != 0;
-                    pic.pins[PSRD1].value = (ret & 0x02) != 0;
-                    pic.pins[PSRD2].value = (ret & 0x04) != 0;
-                    pic.pins[PSRD3].value = (ret & 0x08) != 0;
-                    pic.pins[PSRD4].value = (ret & 0x10) != 0;
-                    pic.pins[PSRD5].value = (ret & 0x20) != 0;
-                    pic.pins[PSRD6].value = (ret & 0x40) != 0;
-                    pic.pins[PSRD7].value = (ret & 0x80) != 0;
+                    // 74hc595 code
+                    if (pins[SO_DATA_PIN].dir == 0) {
+                        srDATA = pins[SO_DATA_PIN].value;
+                    }
+                    if (pins[SO_CLK_PIN].dir == 0) {
+                        srCLK = pins[SO_CLK_PIN].value;
+                    }
+                    if (pins[SO_EN_PIN].dir == 0) {
+                        srLAT = pins[SO_EN_PIN].value;
+                    }
+                    unsigned short ret = io_74xx595_io(&shiftReg, srDATA, srCLK, srLAT, 1);
+                    if (_srret != ret) {
+                        pic.pins[PSRD0].value = (ret & 0x01) != 0;
+                        pic.pins[PSRD1].value = (ret & 0x02) != 0;
+                        pic.pins[PSRD2].value = (ret & 0x04) != 0;
+                        pic.pins[PSRD3].value = (ret & 0x08) != 0;
+                        pic.pins[PSRD4].value = (ret & 0x10) != 0;
+                        pic.pins[PSRD5].value = (ret & 0x20) != 0;
+                        pic.pins[PSRD6].value = (ret & 0x40) != 0;
+                        pic.pins[PSRD7].value = (ret & 0x80) != 0;
+                    }
+                    _srret = ret;
                 }
-                _srret = ret;
-            }
-        }
+            });
         pic.ioupdated = 0;
     }
     // fim STEP
@@ -763,11 +751,12 @@ void cboard_PQDB::Run_CPU(void) {
     // alm[23] = 0; //aquecedor
     // alm[16] = 0; //ventilador
 
+    AlmEnd(pic.pins);
+    pic.pins[32].oavalue = 55;
+
     for (i = 0; i < pic.PINCOUNT; i++) {
         if (pic.pins[i].port == P_VDD) {
             pic.pins[i].oavalue = 255;
-        } else {
-            pic.pins[i].oavalue = (int)((alm[i] * RNSTEP) + 55);
         }
     }
 
@@ -1246,6 +1235,7 @@ void cboard_PQDB::EvKeyRelease(uint key, uint mask) {
 
 void cboard_PQDB::EvOnShow(void) {
     lcd.update = 1;
+    lcd.redraw = 1;
     board::EvOnShow();
 }
 
@@ -1580,4 +1570,72 @@ int cboard_PQDB::MGetPinCount(void) {
     return bsim_picsim::MGetPinCount() + 8;
 }
 
+int cboard_PQDB::SnapshotWrite(FILE* fout) {
+    int ret = lcd_snapshot_write(&lcd, fout);
+    ret |= rtc_ds1307_snapshot_write(&rtc2, fout);
+    ret |= io_74xx595_snapshot_write(&shiftReg, fout);
+    ret |= snapshot_write(fout, &lcde, sizeof(lcde));
+    ret |= snapshot_write(fout, &vtc, sizeof(vtc));
+    ret |= snapshot_write(fout, &vt, sizeof(vt));
+    ret |= snapshot_write(fout, &temp, sizeof(temp));
+    ret |= snapshot_write(fout, &rpmstp, sizeof(rpmstp));
+    ret |= snapshot_write(fout, &rpmc, sizeof(rpmc));
+    ret |= snapshot_write(fout, &d, sizeof(d));
+    ret |= snapshot_write(fout, &sda, sizeof(sda));
+    ret |= snapshot_write(fout, &sck, sizeof(sck));
+    ret |= snapshot_write(fout, &srDATA, sizeof(srDATA));
+    ret |= snapshot_write(fout, &srCLK, sizeof(srCLK));
+    ret |= snapshot_write(fout, &srLAT, sizeof(srLAT));
+    ret |= snapshot_write(fout, &_srret, sizeof(_srret));
+    return ret;
+}
+
+int cboard_PQDB::SnapshotRead(FILE* fin) {
+    lcd_t slcd = lcd;
+    rtc_ds1307_t srtc2 = rtc2;
+    io_74xx595_t sshiftReg;
+    decltype(lcde) slcde;
+    decltype(vtc) svtc;
+    decltype(vt) svt;
+    decltype(temp) stemp;
+    decltype(rpmstp) srpmstp;
+    decltype(rpmc) srpmc;
+    decltype(d) sd;
+    decltype(sda) ssda;
+    decltype(sck) ssck;
+    decltype(srDATA) ssrDATA;
+    decltype(srCLK) ssrCLK;
+    decltype(srLAT) ssrLAT;
+    decltype(_srret) s_srret;
+
+    if (lcd_snapshot_read(&slcd, fin) || rtc_ds1307_snapshot_read(&srtc2, fin) ||
+        io_74xx595_snapshot_read(&sshiftReg, fin) || snapshot_read(fin, &slcde, sizeof(slcde)) ||
+        snapshot_read(fin, &svtc, sizeof(svtc)) || snapshot_read(fin, &svt, sizeof(svt)) ||
+        snapshot_read(fin, &stemp, sizeof(stemp)) || snapshot_read(fin, &srpmstp, sizeof(srpmstp)) ||
+        snapshot_read(fin, &srpmc, sizeof(srpmc)) || snapshot_read(fin, &sd, sizeof(sd)) ||
+        snapshot_read(fin, &ssda, sizeof(ssda)) || snapshot_read(fin, &ssck, sizeof(ssck)) ||
+        snapshot_read(fin, &ssrDATA, sizeof(ssrDATA)) || snapshot_read(fin, &ssrCLK, sizeof(ssrCLK)) ||
+        snapshot_read(fin, &ssrLAT, sizeof(ssrLAT)) || snapshot_read(fin, &s_srret, sizeof(s_srret)) || (svt & ~1)) {
+        return -1;
+    }
+
+    lcd = slcd;
+    rtc2 = srtc2;
+    shiftReg = sshiftReg;
+    lcde = slcde;
+    vtc = svtc;
+    vt = svt;
+    memcpy(temp, stemp, sizeof(temp));
+    rpmstp = srpmstp;
+    rpmc = srpmc;
+    d = sd;
+    sda = ssda;
+    sck = ssck;
+    srDATA = ssrDATA;
+    srCLK = ssrCLK;
+    srLAT = ssrLAT;
+    _srret = s_srret;
+    return 0;
+}
+
 board_init(BOARD_PQDB_Name, cboard_PQDB);
@@ -211,6 +211,8 @@ public:
     void ReadPreferences(char* name, char* value) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
+    int SnapshotWrite(FILE* fout) override;
+    int SnapshotRead(FILE* fin) override;
     lxString MGetPinName(int pin) override;
     int MGetPinCount(void) override;
 };
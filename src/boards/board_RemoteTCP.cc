@@ -535,23 +535,14 @@ if (use_spare)
 }
 
 void cboard_RemoteTCP::Run_CPU_ns(uint64_t time) {
-    static unsigned char pi = 0;
-    static unsigned int alm[64];
-    static const int pinc = MGetPinCount();
-
-    const float RNSTEP = 200.0 * pinc * inc_ns / TTIMEOUT;
-
     for (uint64_t c = 0; c < time; c += inc_ns) {
         if (ns_count < inc_ns) {
             // reset pins mean value
-            memset(alm, 0, 64 * sizeof(unsigned int));
+            AlmStart(pins, MGetPinCount());
 
             // Spare parts window pre process
             if (use_spare)
                 SpareParts.PreProcess();
-
-            // j = JUMPSTEPS; //step counter
-            pi = 0;
         }
 
         if (PICSimLab.GetMcuPwr())  // if powered
@@ -585,11 +576,8 @@ void cboard_RemoteTCP::Run_CPU_ns(uint64_t time) {
             if (use_spare)
                 SpareParts.Process();
 
-            //  increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pinc)
-                pi = 0;
+            // integrate mean value of changed pins, they are written by the server thread
+            AlmScan();
             /*
                 if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
                  {
@@ -604,9 +592,7 @@ void cboard_RemoteTCP::Run_CPU_ns(uint64_t time) {
         if (ns_count >= TTIMEOUT) {  // every 100ms
             ns_count -= TTIMEOUT;
             //  calculate mean value
-            for (pi = 0; pi < MGetPinCount(); pi++) {
-                pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
-            }
+            AlmEnd(pins);
             // Spare parts window pre post process
             if (use_spare)
                 SpareParts.PostProcess();
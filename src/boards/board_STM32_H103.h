@@ -55,7 +55,6 @@ public:
     // Called ever 100ms to draw board
     void Draw(CDraw* draw) override;
     void Run_CPU(void) override{};
-    void Run_CPU_ns(uint64_t time) override;
     // Return a list of board supported microcontrollers
     lxString GetSupportedDevices(void) override { return lxT("stm32f103rbt6,"); };
     // Reset board status
@@ -84,6 +83,7 @@ public:
     lxString MGetPinName(int pin) override;
     int MGetPinCount(void) override;
     void PinsExtraConfig(int cfg) override;
+    void PinsRefresh(void) override;
 };
 
 #endif /* BOARD_STM32_H103_H */
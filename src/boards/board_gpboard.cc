@@ -274,35 +274,25 @@ void cboard_gpboard::Draw(CDraw* draw) {
 }
 
 void cboard_gpboard::Run_CPU(void) {
-    int i;
-    // int j;
-    unsigned char pi;
-    unsigned int alm[64];
-    const int pinc = MGetPinCount();
-
-    // const int JUMPSTEPS = Window1.GetJUMPSTEPS (); //number of steps skipped
-    const long int NSTEP = PICSimLab.GetNSTEP();  // number of steps in 100ms
-    const float RNSTEP = 200.0 * pinc / NSTEP;
-
     // reset pins mean value
-    memset(alm, 0, 64 * sizeof(unsigned int));
+    AlmStart(pins, MGetPinCount());
 
     // Spare parts window pre process
     if (use_spare)
         SpareParts.PreProcess();
 
-    // j = JUMPSTEPS; //step counter
-    pi = 0;
-    if (PICSimLab.GetMcuPwr())                      // if powered
-        for (i = 0; i < PICSimLab.GetNSTEP(); i++)  // repeat for number of steps in 100ms
-        {
-            /*
-            if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
-             {
-             }
-             */
-            // verify if a breakpoint is reached if not run one instruction
-            MStep();
+    if (PICSimLab.GetMcuPwr()) {                      // if powered
+        const long int nstep = PICSimLab.GetNSTEP();  // number of steps in 100ms
+        long int i = 0;
+        while (i < nstep) {
+            // the steps before the next timer, oscilloscope sample or pin change run in one batch without returning
+            // to the board, the last step of the batch is processed normally
+            const int n = MRun((int)IdleSteps(nstep - i - 1) + 1);
+            i += n;
+            InstCounterSkip(n - 1);
+            if (use_oscope)
+                Oscilloscope.SkipIdleSteps(n - 1);
+
             InstCounterInc();
             // Oscilloscope window process
             if (use_oscope)
@@ -311,25 +301,19 @@ void cboard_gpboard::Run_CPU(void) {
             if (use_spare)
                 SpareParts.Process();
 
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pinc)
-                pi = 0;
-            /*
-             if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
-              {
-               j = -1; //reset counter
-              }
-
-             j++; //counter increment
-             */
+            // integrate mean value of changed pins
+            AlmUpdate();
+
+            // changed pins already consumed by the spare parts
+            if (!use_spare) {
+                memset(ioupdated_pins, 0, sizeof(ioupdated_pins));
+            }
+            ioupdated = 0;
         }
+    }
 
     // calculate mean value
-    for (pi = 0; pi < MGetPinCount(); pi++) {
-        pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
-    }
+    AlmEnd(pins);
 
     // Spare parts window pre post process
     if (use_spare)
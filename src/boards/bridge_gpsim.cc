@@ -10,13 +10,104 @@
 // #include <gpsim/pir.h>
 // #include <gpsim/eeprom.h>
 // #include <gpsim/packages.h>
-// #include <gpsim/stimuli.h>
+#include <gpsim/stimuli.h>
 #include <gpsim/sim_context.h>
 
 void simulation_cleanup(void);
 
 static pic_processor* gpic;
 
+static void (*pin_callback)(void* arg, int pin) = NULL;
+static void* pin_callback_arg = NULL;
+static int pin_changed = 0;
+
+// Installed as the IOPIN monitor, forwards the events to the original monitor (the gpsim PinModule) and reports
+// the pin change
+class PinWatch : public PinMonitor {
+public:
+    PinWatch(int pin_, IOPIN* iopin_) : pin(pin_), iopin(iopin_), monitor(iopin_->getMonitor()) {}
+
+    void setDrivenState(char s) override {
+        if (monitor)
+            monitor->setDrivenState(s);
+        changed();
+    }
+    void setDrivingState(char s) override {
+        if (monitor)
+            monitor->setDrivingState(s);
+        changed();
+    }
+    void set_nodeVoltage(double v) override {
+        if (monitor)
+            monitor->set_nodeVoltage(v);
+        changed();
+    }
+    void putState(char s) override {
+        if (monitor)
+            monitor->putState(s);
+        changed();
+    }
+    void setDirection() override {
+        if (monitor)
+            monitor->setDirection();
+        changed();
+    }
+    void updateUI() override {
+        if (monitor)
+            monitor->updateUI();
+    }
+
+    int pin;
+    IOPIN* iopin;
+    PinMonitor* monitor;
+
+private:
+    void changed(void) {
+        pin_changed = 1;
+        if (pin_callback)
+            pin_callback(pin_callback_arg, pin);
+    }
+};
+
+static PinWatch* pin_watch[256];
+
+static void pin_watch_release(const int i) {
+    // IOPIN refuses to replace a monitor, clear it first
+    if (pin_watch[i]->iopin->getMonitor() == pin_watch[i]) {
+        pin_watch[i]->iopin->setMonitor(NULL);
+        pin_watch[i]->iopin->setMonitor(pin_watch[i]->monitor);
+    }
+    delete pin_watch[i];
+    pin_watch[i] = NULL;
+}
+
+static void pin_watch_remove(void) {
+    for (int i = 0; i < 256; i++) {
+        if (pin_watch[i]) {
+            pin_watch_release(i);
+        }
+    }
+}
+
+// gpsim can replace the pins monitors when the pins are remapped (on load or reset)
+static void pin_watch_install(void) {
+    if (!gpic || !pin_callback) {
+        return;
+    }
+    const int count = gpic->get_pin_count();
+    for (int i = 1; (i <= count) && (i < 256); i++) {
+        IOPIN* iopin = gpic->get_pin(i);
+        if (pin_watch[i] && ((pin_watch[i]->iopin != iopin) || (iopin->getMonitor() != pin_watch[i]))) {
+            pin_watch_release(i);
+        }
+        if (iopin && !pin_watch[i]) {
+            pin_watch[i] = new PinWatch(i, iopin);
+            iopin->setMonitor(NULL);
+            iopin->setMonitor(pin_watch[i]);
+        }
+    }
+}
+
 int bridge_gpsim_init(const char* processor, const char* fileName, float freq) {
     // initialize_gpsim_core ();
     // initialization_is_complete ();
@@ -33,6 +124,7 @@ void bridge_gpsim_reset(void) {
     if (gpic->is_sleeping())
         gpic->exit_sleep();
     gpic->reset(POR_RESET);
+    pin_watch_install();
 }
 
 unsigned char bridge_gpsim_get_pin_count(void) {
@@ -93,7 +185,31 @@ void bridge_gpsim_step(void) {
     gpic->step_cycle();
 }
 
+int bridge_gpsim_run(int cycles) {
+    int n = 0;
+
+    pin_changed = 0;
+    while (n < cycles) {
+        gpic->step_cycle();
+        n++;
+        if (pin_changed)
+            break;
+    }
+    return n;
+}
+
+void bridge_gpsim_set_pin_callback(void (*callback)(void* arg, int pin), void* arg) {
+    pin_watch_remove();
+    pin_callback = callback;
+    pin_callback_arg = arg;
+    pin_watch_install();
+}
+
 void bridge_gpsim_end(void) {
+    // restore the original monitors, the IOPIN destructor expects them
+    pin_watch_remove();
+    pin_callback = NULL;
+    pin_callback_arg = NULL;
     CSimulationContext::GetContext()->Clear();
     // simulation_cleanup ();
     // Ugly hack to permit gpsim restart
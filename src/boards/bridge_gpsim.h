@@ -26,6 +26,8 @@ unsigned char bridge_gpsim_get_pin_value(int pin);
 unsigned char bridge_gpsim_get_pin_dir(int pin);
 void bridge_gpsim_set_pin_value(int pin, unsigned char value);
 void bridge_gpsim_step(void);
+int bridge_gpsim_run(int cycles);
+void bridge_gpsim_set_pin_callback(void (*callback)(void* arg, int pin), void* arg);
 void bridge_gpsim_end(void);
 int bridge_gpsim_dump_memory(const char* fname);
 char* bridge_gpsim_get_processor_list(char* buff, unsigned int size);
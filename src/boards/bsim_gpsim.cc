@@ -32,6 +32,7 @@ static const unsigned char GPSIM_PORTS[5] = {0, 1, 2, 3, 0xFF};
 
 bsim_gpsim::bsim_gpsim(void) {
     char list[2000];
+    memset(pins_changed, 0, sizeof(pins_changed));
     supported_devices = bridge_gpsim_get_processor_list(list, 1999);
     PICSimLab.SetNeedReboot();
 }
@@ -63,6 +64,13 @@ void bsim_gpsim::MSetSerial(const char* port) {
          ret = bridge_gpsim_init(processor, fname, freq);
      }
 
+     if (ret == 0) {
+         // pins[] is only updated when gpsim reports a change
+         bridge_gpsim_set_pin_callback(PinChanged, this);
+         memset(pins_changed, 0xFF, sizeof(pins_changed));
+         pins_refresh();
+     }
+
      return ret;
  }
 
@@ -160,6 +168,7 @@ void bsim_gpsim::MSetSerial(const char* port) {
 
  void bsim_gpsim::MSetPin(int pin, unsigned char value) {
      bridge_gpsim_set_pin_value(pin, value);
+     pins_refresh();
  }
 
  void bsim_gpsim::MSetPinDOV(int pin, unsigned char ovalue) {
@@ -176,6 +185,8 @@ void bsim_gpsim::MSetSerial(const char* port) {
 
  void bsim_gpsim::MReset(int flags) {
      bridge_gpsim_reset();
+     memset(pins_changed, 0xFF, sizeof(pins_changed));
+     pins_refresh();
  }
 
  const picpin* bsim_gpsim::MGetPinsValues(void) {
@@ -184,10 +195,41 @@ void bsim_gpsim::MSetSerial(const char* port) {
 
  void bsim_gpsim::MStep(void) {
      bridge_gpsim_step();
-
-     for (int i = 0; i < MGetPinCount(); i++) {
-         pins[i].value = bridge_gpsim_get_pin_value(i + 1);
-         pins[i].dir = bridge_gpsim_get_pin_dir(i + 1);
+     pins_refresh();
+ }
+
+ int bsim_gpsim::MRun(const int cycles) {
+     const int n = bridge_gpsim_run(cycles);
+     pins_refresh();
+     return n;
+ }
+
+ void bsim_gpsim::PinChanged(void* arg, int pin) {
+     bsim_gpsim* bsim = (bsim_gpsim*)arg;
+     // called from inside gpsim, the pin is read after the step
+     bsim->pins_changed[pin >> 5] |= 1U << (pin & 0x1F);
+ }
+
+ void bsim_gpsim::pins_refresh(void) {
+     const int pinc = MGetPinCount();
+
+     for (int w = 0; w < IOUPDATED_WORDS; w++) {
+         uint32_t changed = pins_changed[w];
+         if (!changed)
+             continue;
+         pins_changed[w] = 0;
+         for (int b = 0; changed; b++, changed >>= 1) {
+             const int pin = (w << 5) + b;
+             if (!(changed & 1) || !pin || (pin > pinc))
+                 continue;
+             const unsigned char value = bridge_gpsim_get_pin_value(pin);
+             const unsigned char dir = bridge_gpsim_get_pin_dir(pin);
+             if ((pins[pin - 1].value != value) || (pins[pin - 1].dir != dir)) {
+                 pins[pin - 1].value = value;
+                 pins[pin - 1].dir = dir;
+                 ioupdated_pin(pin);
+             }
+         }
      }
  }
 
@@ -60,8 +60,14 @@ public:
     int GetDefaultClock(void) override { return 8; };
 
 protected:
+    /**
+     * @brief Run up to cycles cycles, stopping after the first one that changes some pin; returns the cycles run
+     */
+    int MRun(const int cycles);
     void pins_reset(void);
+    void pins_refresh(void);
     picpin pins[256];
+    uint32_t pins_changed[IOUPDATED_WORDS];  // pins reported by gpsim and not yet read
     unsigned int serialbaud;
     float serialexbaud;
     float freq;
@@ -71,6 +77,9 @@ protected:
     int serialfd;
 #endif
     lxString supported_devices;
+
+private:
+    static void PinChanged(void* arg, int pin);
 };
 
 #endif /* BOARD_GPSIM_H */
@@ -29,6 +29,7 @@
 
 bsim_picsim::bsim_picsim(void) {
     pic.PINCOUNT = 0;
+    uart_txreg = 0;
 }
 
 void bsim_picsim::MSetSerial(const char* port) {
@@ -59,6 +60,12 @@ int bsim_picsim::MInit(const char* processor, const char* fname, float freq) {
 
     pic.pins = (picpin*)realloc(pic.pins, sizeof(picpin) * 256);
 
+    // the USART TXREG writes are only watched for the free run --stop-uart option
+    uart_txreg = 0;
+    if (PICSimLab.GetFreeRun() && pic.USARTCOUNT) {
+        uart_txreg = pic.serial[0].serial_TXREG_ADDR;
+    }
+
     return ret;
 }
 
@@ -178,14 +185,18 @@ const picpin* bsim_picsim::MGetPinsValues(void) {
 }
 
 void bsim_picsim::MStep(void) {
-    pic_step(&pic);
+    PicStep();
     if (pic.s2 == 1)
-        pic_step(&pic);
+        PicStep();
 }
 
 void bsim_picsim::MStepResume(void) {
     if (pic.s2 == 1)
-        pic_step(&pic);
+        PicStep();
+}
+
+void bsim_picsim::UartTXOutput(void) {
+    PICSimLab.UartOutput(*pic.serial[0].serial_TXREG);
 }
 
 void bsim_picsim::MReset(int flags) {
@@ -274,4 +285,92 @@ int bsim_picsim::GetUARTTX(const int uart_num) {
         return pic.usart_tx[uart_num];
     }
     return 0;
-}
\ No newline at end of file
+}
+// pointer free part of the picsim core state
+#define PICSIM_CORE(copy) \
+    copy(jpc);            \
+    copy(lram);           \
+    copy(rram);           \
+    copy(w);              \
+    copy(wdt);            \
+    copy(s2);             \
+    copy(sleep);          \
+    copy(cycles);         \
+    copy(cp0);            \
+    copy(cp1);            \
+    copy(cp2);            \
+    copy(cp2_);           \
+    copy(cp3);            \
+    copy(t2pr);           \
+    copy(t0cki_);         \
+    copy(t1cki_);         \
+    copy(int0);           \
+    copy(int1);           \
+    copy(int2);           \
+    copy(int0v);          \
+    copy(int1v);          \
+    copy(int2v);          \
+    copy(portbm);         \
+    copy(adcon1);         \
+    copy(adcstep);        \
+    copy(twdt);           \
+    copy(ee_wr);          \
+    copy(p16latch);       \
+    copy(porta);          \
+    copy(portb);          \
+    copy(portc);          \
+    copy(portd);          \
+    copy(porte);          \
+    copy(portf);          \
+    copy(portg);          \
+    copy(trisa);          \
+    copy(trisb);          \
+    copy(trisc);          \
+    copy(trisd);          \
+    copy(trise);          \
+    copy(trisf);          \
+    copy(trisg);          \
+    copy(ssp_ck);         \
+    copy(ssp_sck);        \
+    copy(ssp_scka);       \
+    copy(sspsr);          \
+    copy(ssp_bit)
+
+#define PICSIM_CORE_WRITE(field) ret |= snapshot_write(fout, &pic.field, sizeof(pic.field))
+#define PICSIM_CORE_READ(field) ret |= snapshot_read(fin, &core.field, sizeof(core.field))
+#define PICSIM_CORE_COPY(field) memcpy(&pic.field, &core.field, sizeof(pic.field))
+
+int bsim_picsim::MSnapshotWrite(FILE* fout) {
+    int ret = 0;
+    PICSIM_CORE(PICSIM_CORE_WRITE);
+    ret |= snapshot_write(fout, pic.stack, pic.STACKSIZE * sizeof(unsigned int));
+    ret |= snapshot_write(fout, pic.ccp, pic.CCPCOUNT * sizeof(ccp_t));
+    ret |= SnapshotWriteMemories(fout);
+    return ret;
+}
+
+int bsim_picsim::MSnapshotRead(FILE* fin) {
+    static _pic core;
+    unsigned int* stack = new unsigned int[pic.STACKSIZE];
+    ccp_t* ccp = new ccp_t[pic.CCPCOUNT];
+    int ret = 0;
+
+    // the core state is read to a copy and applied after the memories
+    memcpy(&core, &pic, sizeof(pic));
+    PICSIM_CORE(PICSIM_CORE_READ);
+    ret |= snapshot_read(fin, stack, pic.STACKSIZE * sizeof(unsigned int));
+    ret |= snapshot_read(fin, ccp, pic.CCPCOUNT * sizeof(ccp_t));
+
+    if (!ret && !SnapshotReadMemories(fin)) {
+        PICSIM_CORE(PICSIM_CORE_COPY);
+        memcpy(pic.stack, stack, pic.STACKSIZE * sizeof(unsigned int));
+        memcpy(pic.ccp, ccp, pic.CCPCOUNT * sizeof(ccp_t));
+        pic.ioupdated = 1;
+    } else {
+        ret = -1;
+    }
+
+    delete[] stack;
+    delete[] ccp;
+    return ret;
+}
@@ -74,13 +74,26 @@ public:
     unsigned int DBGGetEEPROM_Size(void) override;
     unsigned int DBGGetRAMLAWR(void) override;
     unsigned int DBGGetRAMLARD(void) override;
+    int MSnapshotWrite(FILE* fout) override;
+    int MSnapshotRead(FILE* fin) override;
     void EndServers(void) override;
     int GetDefaultClock(void) override { return 8; };
     int GetUARTRX(const int uart_num) override;
     int GetUARTTX(const int uart_num) override;
 
 protected:
+    // run one instruction, with the bytes written to the USART TXREG sent to the free run UART output
+    void PicStep(void) {
+        pic_step(&pic);
+        if (uart_txreg && (pic.lram == uart_txreg)) {
+            UartTXOutput();
+        }
+    };
     _pic pic;
+
+private:
+    void UartTXOutput(void);
+    unsigned short uart_txreg;
 };
 
 #endif /* BOARD_PIC_H */
@@ -28,8 +28,10 @@
 #endif
 
 #include <time.h>
+#include "../lib/oscilloscope.h"
 #include "../lib/picsimlab.h"
 #include "../lib/serial_port.h"
+#include "../lib/spareparts.h"
 #include "bsim_qemu.h"
 
 #define dprintf \
@@ -95,10 +97,10 @@ static int64_t GotoNow(void) {
 
 static void picsimlab_write_pin(int pin, int value) {
     // printf("================> IO    <====================== %ji\n", now - g_board->timer.last);
-    ioupdated = 1;
     g_board->Run_CPU_ns(GotoNow());
 
     g_pins[pin - 1].value = value;
+    g_board->ioupdated_pin(pin);
     // printf("pin[%i]=%i\n", pin, value);
 }
 
@@ -106,11 +108,11 @@ static void picsimlab_dir_pins(int pin, int dir) {
     // printf("================> IO    <====================== %ji\n", now - g_board->timer.last);
 
     if (pin > 0) {  // normal io
-        ioupdated = 1;
         g_board->Run_CPU_ns(GotoNow());
         g_pins[pin - 1].dir = !dir;
+        g_board->ioupdated_pin(pin);
     } else if (dir == -1) {  // sync input
-        ioupdated = 1;
+        g_board->ioupdated = 1;
         g_board->Run_CPU_ns(GotoNow());
     } else {  // especial pin cfg
         g_board->PinsExtraConfig(dir);
@@ -121,26 +123,45 @@ static void picsimlab_dir_pins(int pin, int dir) {
 static int picsimlab_i2c_event(const uint8_t id, const uint8_t addr, const uint16_t event) {
     g_board->Run_CPU_ns(GotoNow());
 
+    // with the devices of the spare parts on a shared bus the transfer goes direct to them, without bit-banging.
+    // No bus is returned while the pins are observed, then the SCL/SDA edges are generated as before.
+    i2c_bus_t* bus = SpareParts.FindI2CBus(g_board->master_i2c[id].scl_pin, g_board->master_i2c[id].sda_pin);
+
     switch (event & 0xFF) {
         case I2C_START_RECV:
         case I2C_START_SEND:
-
-            bitbang_i2c_ctrl_start(&g_board->master_i2c[id]);
+            if (bus) {
+                i2c_bus_start(bus);
+            } else {
+                bitbang_i2c_ctrl_start(&g_board->master_i2c[id]);
+            }
             g_board->timer.last += 8000;
             g_board->Run_CPU_ns(8000);
 
             if (event == I2C_START_RECV) {
-                bitbang_i2c_ctrl_write(&g_board->master_i2c[id], (addr << 1) | 0x01);
+                if (bus) {
+                    i2c_bus_write(bus, (addr << 1) | 0x01);
+                } else {
+                    bitbang_i2c_ctrl_write(&g_board->master_i2c[id], (addr << 1) | 0x01);
+                }
                 dprintf(">>> start recv =0x%02x\n", addr);
             } else {
-                bitbang_i2c_ctrl_write(&g_board->master_i2c[id], addr << 1);
+                if (bus) {
+                    i2c_bus_write(bus, addr << 1);
+                } else {
+                    bitbang_i2c_ctrl_write(&g_board->master_i2c[id], addr << 1);
+                }
                 dprintf(">>> start send =0x%02x\n", addr);
             }
             g_board->timer.last += 72000;
             g_board->Run_CPU_ns(72000);
             break;
         case I2C_FINISH:
-            bitbang_i2c_ctrl_stop(&g_board->master_i2c[id]);
+            if (bus) {
+                i2c_bus_stop(bus);
+            } else {
+                bitbang_i2c_ctrl_stop(&g_board->master_i2c[id]);
+            }
             g_board->timer.last += 8000;
             g_board->Run_CPU_ns(8000);
             dprintf("<<< stop =0x%02x\n", addr);
@@ -149,13 +170,21 @@ static int picsimlab_i2c_event(const uint8_t id, const uint8_t addr, const uint1
             break;
         case I2C_WRITE:
             dprintf("==> send addr=0x%02x value=0x%02x\n", addr, event >> 8);
-            bitbang_i2c_ctrl_write(&g_board->master_i2c[id], event >> 8);  // TODO verify ACK
+            if (bus) {
+                i2c_bus_write(bus, event >> 8);
+            } else {
+                bitbang_i2c_ctrl_write(&g_board->master_i2c[id], event >> 8);  // TODO verify ACK
+            }
             g_board->timer.last += 72000;
             g_board->Run_CPU_ns(72000);
             return 1;
             break;
         case I2C_READ:
-            bitbang_i2c_ctrl_read(&g_board->master_i2c[id]);  // TODO verify ACK
+            if (bus) {
+                g_board->master_i2c[id].datar = i2c_bus_read(bus);
+            } else {
+                bitbang_i2c_ctrl_read(&g_board->master_i2c[id]);  // TODO verify ACK
+            }
             g_board->timer.last += 72000;
             g_board->Run_CPU_ns(72000);
             dprintf("<== recv addr=0x%02x value=0x%02x\n", addr, g_board->master_i2c[id].datar);
@@ -178,7 +207,7 @@ static uint8_t picsimlab_spi_event(const uint8_t id, const uint16_t event) {
             return g_board->master_spi[id].data;
             break;
         case 1:  // CS
-            ioupdated = 1;
+            g_board->ioupdated = 1;
             dprintf("SPI MASTER CS 0x%02X\n", event >> 8);
             switch (event >> 9) {
                 case 0:
@@ -201,6 +230,10 @@ static uint8_t picsimlab_spi_event(const uint8_t id, const uint16_t event) {
 static void picsimlab_uart_tx_event(const uint8_t id, const uint8_t value) {
     dprintf("Uart[%i] %c \n", id, value);
 
+    if (!id) {
+        PICSimLab.UartOutput(value);
+    }
+
     g_board->Run_CPU_ns(GotoNow());
 
     bitbang_uart_send(&g_board->master_uart[id], value);
@@ -382,12 +415,95 @@ static void user_timeout_cb(void* opaque) {
     int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
     timer_mod_ns(board->timer.qtimer, now + board->timer.timeout);
     if (PICSimLab.GetSimulationRun()) {
-        ioupdated = 0;
+        board->ioupdated = 0;
         board->Run_CPU_ns(GotoNow());
     }
     board->timer.last = now;
 }
 
+void bsim_qemu::Run_CPU_ns(uint64_t time) {
+    const int pwr = PICSimLab.GetMcuPwr();
+
+    PinsRefresh();
+
+    // pins changed outside of the steps
+    AlmScan();
+
+    for (uint64_t c = 0; c < time; c += inc_ns) {
+        if (ns_count < inc_ns) {
+            // reset pins mean value
+            AlmStart(pins, MGetPinCount());
+
+            // Spare parts window pre process
+            if (use_spare)
+                SpareParts.PreProcess();
+        }
+
+        // fast forward while nothing changes, the step that reaches the time limit, the end of 100ms, the next timer
+        // or the next oscilloscope sample is run normally
+        if (!ioupdated || !pwr) {
+            const uint64_t period = (uint64_t)(TTIMEOUT - 1 - ns_count) / inc_ns;
+            uint64_t steps = (time - c - 1) / inc_ns;
+            if (steps > period) {
+                steps = period;
+            }
+            if (pwr && steps) {
+                steps = IdleSteps(steps);
+            }
+            if (steps) {
+                if (pwr) {
+                    InstCounterSkip(steps);
+                    if (use_oscope)
+                        Oscilloscope.SkipIdleSteps(steps);
+                    // the pins mean value integrates the constant pins by the InstCounter advance
+                }
+                c += steps * inc_ns;
+                ns_count += steps * inc_ns;
+            }
+        }
+
+        if (pwr)  // if powered
+        {
+            // verify if a breakpoint is reached if not run one instruction
+            MStep();
+            InstCounterInc();
+            // Oscilloscope window process
+            if (use_oscope)
+                Oscilloscope.SetSample();
+            // Spare parts window process
+            if (use_spare)
+                SpareParts.Process();
+
+            // integrate mean value of changed pins
+            AlmUpdate();
+
+            // single pin changes already consumed by the spare parts, stop waking up every step
+            if (ioupdated == IOUPDATED_PINS) {
+                uint32_t pending = 0;
+                if (!use_spare) {
+                    memset(ioupdated_pins, 0, sizeof(ioupdated_pins));
+                }
+                for (int w = 0; w < IOUPDATED_WORDS; w++) {
+                    pending |= ioupdated_pins[w];
+                }
+                if (!pending) {
+                    ioupdated = 0;
+                }
+            }
+        }
+
+        ns_count += inc_ns;
+        if (ns_count >= TTIMEOUT) {  // every 100ms
+            ns_count -= TTIMEOUT;
+            //  calculate mean value
+            AlmEnd(pins);
+            // Spare parts window pre post process
+            if (use_spare)
+                SpareParts.PostProcess();
+        }
+    }
+}
+
 void bsim_qemu::EvThreadRun(CThread& thread) {
     mtx_qinit->Lock();
 
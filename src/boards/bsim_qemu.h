@@ -67,12 +67,14 @@ public:
     int GetDefaultClock(void) override { return 1; };
     int GetInc_ns(void) { return inc_ns; };
     virtual void PinsExtraConfig(int cfg){};
+    virtual void PinsRefresh(void){};  // update board input pins, called on every Run_CPU_ns
     user_timer_t timer;
-    virtual void Run_CPU_ns(uint64_t time) = 0;
+    void Run_CPU_ns(uint64_t time);
     bitbang_i2c_t master_i2c[2];
     bitbang_spi_t master_spi[2];
     bitbang_uart_t master_uart[3];
     bitbang_pwm_t ledc;
+    // TODO snapshot support, the qemu library has no interface to save and restore the machine state
     void IoLockAccess(void) override;
     void IoUnlockAccess(void) override;
     int GetUARTRX(const int uart_num) override;
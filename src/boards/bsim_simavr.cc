@@ -74,7 +74,9 @@ bsim_simavr::bsim_simavr(void) {
     eeprom = NULL;
     usart_count = 0;
     pkg = PDIP;
+    pin_count = 0;
     serialfd = INVALID_SERIAL;
+    serial_port_buff_init(&serialbuff);
 }
 
 // uart stuff
@@ -88,6 +90,25 @@ static const char* irq_names_uart[IRQ_UART_COUNT] = {
     /*[IRQ_UART_BYTE_OUT] =*/"8>uart.out",
 };
 
+void bsim_simavr::out_hook(struct avr_irq_t* irq, uint32_t value, void* param) {
+    picpin* p = (picpin*)param;
+    if (p->value != value) {
+        p->value = value;
+        board* pboard = PICSimLab.GetBoard();
+        pboard->ioupdated_pin((p - pboard->MGetPinsValues()) + 1);
+    }
+}
+
+void bsim_simavr::ddr_hook(struct avr_irq_t* irq, uint32_t value, void* param) {
+    picpin* p = (picpin*)param;
+    unsigned char dir = !(value & (1 << p->pord));
+    if (p->dir != dir) {
+        p->dir = dir;
+        board* pboard = PICSimLab.GetBoard();
+        pboard->ioupdated_pin((p - pboard->MGetPinsValues()) + 1);
+    }
+}
+
 /*
  * called when a byte is send via the uart on the AVR
  */
@@ -271,6 +292,9 @@ void bsim_simavr::pins_reset(void) {
             pins[20].ptype = PT_POWER;
             // AREF
             pins[19].ptype = PT_ANAREF;
+            // ADC6 and ADC7 are analog only inputs
+            pins[18].ptype = PT_ANALOG;
+            pins[21].ptype = PT_ANALOG;
         }
     }
 }
@@ -279,6 +303,37 @@ void avr_callback_sleep_raw_(avr_t* avr, avr_cycle_count_t how_long) {}
 
 static const unsigned char AVR_PORTS[12] = {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L'};
 
+// pin number of each ADC channel
+static const unsigned char ADC_PINS_2560[16] = {97, 96, 95, 94, 93, 92, 91, 90, 89, 88, 87, 86, 85, 84, 83, 82};
+static const unsigned char ADC_PINS_T85[4] = {5, 7, 3, 2};
+static const unsigned char ADC_PINS_328_PDIP[6] = {23, 24, 25, 26, 27, 28};
+static const unsigned char ADC_PINS_328_QFN[8] = {23, 24, 25, 26, 27, 28, 19, 22};  // A6 and A7 only in QFN
+
+void bsim_simavr::adc_pins_init(void) {
+    const unsigned char* adc_pins;
+    int adc_count;
+
+    memset(adc_irq, 0, sizeof(adc_irq));
+
+    if (lxString(avr->mmcu).compare(lxT("atmega2560")) == 0) {
+        adc_pins = ADC_PINS_2560;
+        adc_count = 16;
+    } else if (lxString(avr->mmcu).compare(lxT("attiny85")) == 0) {
+        adc_pins = ADC_PINS_T85;
+        adc_count = 4;
+    } else if (pkg == PDIP) {  // atmega328
+        adc_pins = ADC_PINS_328_PDIP;
+        adc_count = 6;
+    } else {  // QFN
+        adc_pins = ADC_PINS_328_QFN;
+        adc_count = 8;
+    }
+
+    for (int i = 0; i < adc_count; i++) {
+        adc_irq[adc_pins[i] - 1] = avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, i);
+    }
+}
+
 int bsim_simavr::MInit(const char* processor, const char* fname, float freq) {
     int ret;
     lxString sproc = GetSupportedDevices();
@@ -300,6 +355,16 @@ int bsim_simavr::MInit(const char* processor, const char* fname, float freq) {
 
     avr->sleep = avr_callback_sleep_raw_;
 
+    pin_count = 0;
+    if (lxString(avr->mmcu).compare(lxT("atmega2560")) == 0) {
+        pin_count = 100;
+    } else if (lxString(avr->mmcu).compare(lxT("attiny85")) == 0) {
+        pin_count = 8;
+    } else if ((lxString(avr->mmcu).compare(lxT("atmega328")) == 0) ||
+               (lxString(avr->mmcu).compare(lxT("atmega328p")) == 0)) {
+        pin_count = (pkg == PDIP) ? 28 : 32;
+    }
+
     // using ee =0 ioctl return the pointer to internal eeprom data instead load
     // values in the pointer
     avr_eeprom_desc_t epromd;
@@ -362,6 +427,7 @@ int bsim_simavr::MInit(const char* processor, const char* fname, float freq) {
         }
     }
     pins_reset();
+    adc_pins_init();
 
     /*
     //external pull-up for i2c
@@ -424,6 +490,7 @@ int bsim_simavr::MInit(const char* processor, const char* fname, float freq) {
 
     serialexbaud[0] = 9600;
     serialbaud[0] = serial_port_cfg(serialfd, serialexbaud[0]);
+    serial_port_buff_start(&serialbuff, serialfd);
 
     if (usart_count) {
         for (int i = 0; i < usart_count; i++) {
@@ -473,6 +540,7 @@ void bsim_simavr::MEnd(void) {
         mplabxd_end();
     }
 
+    serial_port_buff_stop(&serialbuff);
     serial_port_close(&serialfd);
 
     avr_terminate(avr);
@@ -637,25 +705,7 @@ int bsim_simavr::CpuInitialized(void) {
 int bsim_simavr::MGetPinCount(void) {
     if (avr == NULL)
         return 0;
-    if (lxString(avr->mmcu).compare(lxT("atmega328")) == 0) {
-        if (pkg == PDIP) {
-            return 28;
-        } else {  // QFN
-            return 32;
-        }
-    }
-    if (lxString(avr->mmcu).compare(lxT("atmega328p")) == 0) {
-        if (pkg == PDIP) {
-            return 28;
-        } else {  // QFN
-            return 32;
-        }
-    }
-    if (lxString(avr->mmcu).compare(lxT("atmega2560")) == 0)
-        return 100;
-    if (lxString(avr->mmcu).compare(lxT("attiny85")) == 0)
-        return 8;
-    return 0;
+    return pin_count;
 }
 
 lxString bsim_simavr::MGetPinName(int pin) {
@@ -1137,7 +1187,7 @@ lxString bsim_simavr::MGetPinName(int pin) {
                     return "+5V";
                     break;
                 case 19:
-                    return "ADC6";
+                    return "ADC6/A6";
                     break;
                 case 20:
                     return "AREF";
@@ -1146,7 +1196,7 @@ lxString bsim_simavr::MGetPinName(int pin) {
                     return "GND";
                     break;
                 case 22:
-                    return "ADC7";
+                    return "ADC7/A7";
                     break;
                 case 23:
                     return "PC0/A0";
@@ -1223,157 +1273,9 @@ void bsim_simavr::MSetAPin(int pin, float value) {
     if (avr == NULL)
         return;
 
-    if (lxString(avr->mmcu).compare(lxT("atmega2560")) == 0) {
-        switch (pin) {
-            case 82:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 15), (int)(value * 1000));
-                break;
-            case 83:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 14), (int)(value * 1000));
-                break;
-            case 84:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 13), (int)(value * 1000));
-                break;
-            case 85:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 12), (int)(value * 1000));
-                break;
-            case 86:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 11), (int)(value * 1000));
-                break;
-            case 87:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 10), (int)(value * 1000));
-                break;
-            case 88:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 9), (int)(value * 1000));
-                break;
-            case 89:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 8), (int)(value * 1000));
-                break;
-            case 90:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 7), (int)(value * 1000));
-                break;
-            case 91:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 6), (int)(value * 1000));
-                break;
-            case 92:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 5), (int)(value * 1000));
-                break;
-            case 93:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 4), (int)(value * 1000));
-                break;
-            case 94:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 3), (int)(value * 1000));
-                break;
-            case 95:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 2), (int)(value * 1000));
-                break;
-            case 96:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 1), (int)(value * 1000));
-                break;
-            case 97:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 0), (int)(value * 1000));
-                break;
-        }
-    } else if (lxString(avr->mmcu).compare(lxT("attiny85")) == 0) {
-        switch (pin) {
-            case 5:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 0), (int)(value * 1000));
-                break;
-            case 7:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 1), (int)(value * 1000));
-                break;
-            case 3:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 2), (int)(value * 1000));
-                break;
-            case 2:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 3), (int)(value * 1000));
-                break;
-        }
-    } else  // atmega328
-    {
-        if (pkg == PDIP) {
-            switch (pin) {
-                case 23:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 0), (int)(value * 1000));
-                    break;
-                case 24:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 1), (int)(value * 1000));
-                    break;
-                case 25:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 2), (int)(value * 1000));
-                    break;
-                case 26:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 3), (int)(value * 1000));
-                    break;
-                case 27:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 4), (int)(value * 1000));
-                    break;
-                case 28:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 5), (int)(value * 1000));
-                    break;
-            }
-        } else {  // QFN
-            switch (pin) {
-                case 23:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 0), (int)(value * 1000));
-                    break;
-                case 24:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 1), (int)(value * 1000));
-                    break;
-                case 25:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 2), (int)(value * 1000));
-                    break;
-                case 26:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 3), (int)(value * 1000));
-                    break;
-                case 27:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 4), (int)(value * 1000));
-                    break;
-                case 28:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 5), (int)(value * 1000));
-                    break;
-                case 19:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 6), (int)(value * 1000));
-                    break;
-                case 22:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 7), (int)(value * 1000));
-                    break;
-            }
-        }
+    if (adc_irq[pin - 1]) {
+        pins[pin - 1].ptype = PT_ANALOG;
+        avr_raise_irq(adc_irq[pin - 1], (int)(value * 1000));
     }
 }
 
@@ -1390,7 +1292,8 @@ const picpin* bsim_simavr::MGetPinsValues(void) {
 
 void bsim_simavr::SerialSend(bitbang_uart_t* _bb_uart, const unsigned char value) {
     if (_bb_uart == &bb_uart[0]) {  // send only serial 0
-        serial_port_send(serialfd, value);
+        serial_port_buff_send(&serialbuff, value);
+        PICSimLab.UartOutput(value);
     }
     if (usart_count) {
         bitbang_uart_send(_bb_uart, value);
@@ -1403,7 +1306,7 @@ void bsim_simavr::SerialSend(bitbang_uart_t* _bb_uart, const unsigned char value
 static void uart_in_hook(struct avr_irq_t* irq, uint32_t value, void* param) {
     bitbang_uart_t* bb_uart = ((bitbang_uart_t*)param);
     (dynamic_cast<bsim_simavr*>(bb_uart->pboard))->SerialSend(bb_uart, value);
-    ioupdated = 1;
+    bb_uart->pboard->ioupdated = 1;
 }
 
 void bsim_simavr::UpdateHardware(void) {
@@ -1416,7 +1319,7 @@ void bsim_simavr::UpdateHardware(void) {
         if (cont > 1000) {
             cont = 0;
 
-            if (PICSimLab.GetUseDSRReset() && serial_port_get_dsr(serialfd)) {
+            if (PICSimLab.GetUseDSRReset() && serial_port_buff_get_dsr(&serialbuff)) {
                 if (aux) {
                     MReset(0);
                     aux = 0;
@@ -1428,7 +1331,7 @@ void bsim_simavr::UpdateHardware(void) {
             for (int i = 0; i < usart_count; i++) {
                 if (avr->data[UCSR_base[i] + 1] & 0x10) {  // RXEN
 
-                    if ((!i) && (serial_port_rec(serialfd, &c))) {
+                    if ((!i) && (serial_port_buff_rec(&serialbuff, &c))) {
                         avr_raise_irq(serial_irq[0] + IRQ_UART_BYTE_OUT, c);
                     }
 
@@ -1605,6 +1508,207 @@ unsigned int bsim_simavr::DBGGetEEPROM_Size(void) {
     return avr->e2end + 1;
 }
 
+// The simavr cycle timers callbacks are static functions of the simavr peripherals, they can't be listed in a table.
+// A snapshot timer is saved with a key: the callback offset from a simavr function and the param offset from the avr
+// core (the peripherals are allocated with the core). It is only restored if the same key was seen in a live timer
+// list of the same processor in this process, using the callback pointer seen there. A value read from the file is
+// never called. The offset of a second function refuses snapshots of other simavr builds.
+#define SIMAVR_CODE_OFFSET(func) ((int64_t)((intptr_t)(func) - (intptr_t)avr_cycle_timer_register))
+#define SIMAVR_NULL_PARAM INT64_MIN
+
+#define SIMAVR_MAX_VECTORS 64
+#define SIMAVR_MAX_TIMERS (sizeof(avr->cycle_timers.timer_slots) / sizeof(avr->cycle_timers.timer_slots[0]))
+#define SIMAVR_KNOWN_MAX 128
+
+typedef struct {
+    uint64_t when;  ///< cycles to the expiration
+    int64_t timer;  ///< callback key
+    int64_t param;  ///< param key
+} simavr_snapshot_timer_t;
+
+typedef struct {
+    const char* mmcu;
+    int64_t timer;
+    int64_t param;
+    avr_cycle_timer_t callback;
+} simavr_known_timer_t;
+
+static simavr_known_timer_t simavr_known[SIMAVR_KNOWN_MAX];
+static int simavr_known_count = 0;
+
+static int64_t simavr_param_key(avr_t* avr, void* param) {
+    return param ? (int64_t)((char*)param - (char*)avr) : SIMAVR_NULL_PARAM;
+}
+
+static int simavr_known_find(avr_t* avr, const int64_t timer, const int64_t param) {
+    for (int i = 0; i < simavr_known_count; i++) {
+        if ((simavr_known[i].timer == timer) && (simavr_known[i].param == param) &&
+            !strcmp(simavr_known[i].mmcu, avr->mmcu)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// add the timers of the live list to the known timers
+static void simavr_known_update(avr_t* avr) {
+    for (avr_cycle_timer_slot_p slot = avr->cycle_timers.timer; slot; slot = slot->next) {
+        const int64_t timer = SIMAVR_CODE_OFFSET(slot->timer);
+        const int64_t param = simavr_param_key(avr, slot->param);
+        if ((simavr_known_find(avr, timer, param) < 0) && (simavr_known_count < SIMAVR_KNOWN_MAX)) {
+            simavr_known_timer_t* known = &simavr_known[simavr_known_count++];
+            known->mmcu = avr->mmcu;
+            known->timer = timer;
+            known->param = param;
+            known->callback = slot->timer;
+        }
+    }
+}
+
+static avr_int_vector_p simavr_vector(avr_int_table_t* table, const uint8_t vector) {
+    for (int i = 0; i < table->vector_count; i++) {
+        if (table->vector[i]->vector == vector) {
+            return table->vector[i];
+        }
+    }
+    return NULL;
+}
+
+int bsim_simavr::MSnapshotWrite(FILE* fout) {
+    avr_int_table_t* table = &avr->interrupts;
+    const int mask = (sizeof(table->pending.buffer) / sizeof(table->pending.buffer[0])) - 1;
+    const int64_t build = SIMAVR_CODE_OFFSET(avr_run);
+    simavr_snapshot_timer_t timers[SIMAVR_MAX_TIMERS];
+    uint8_t pending[SIMAVR_MAX_VECTORS];
+    uint8_t queue[SIMAVR_MAX_VECTORS];
+    uint8_t running[SIMAVR_MAX_VECTORS];
+    uint32_t counts[3] = {0, 0, 0};  // queue, running and timers
+
+    simavr_known_update(avr);
+
+    for (int i = 0; i < table->vector_count; i++) {
+        pending[i] = table->vector[i]->pending;
+    }
+    for (int c = table->pending.read; c != table->pending.write; c = (c + 1) & mask) {
+        queue[counts[0]++] = table->pending.buffer[c]->vector;
+    }
+    for (int i = 0; i < table->running_ptr; i++) {
+        running[counts[1]++] = table->running[i]->vector;
+    }
+    for (avr_cycle_timer_slot_p slot = avr->cycle_timers.timer; slot; slot = slot->next) {
+        simavr_snapshot_timer_t* timer = &timers[counts[2]++];
+        timer->when = (slot->when > avr->cycle) ? slot->when - avr->cycle : 0;
+        timer->timer = SIMAVR_CODE_OFFSET(slot->timer);
+        timer->param = simavr_param_key(avr, slot->param);
+    }
+
+    // the cpu state is written before the memories, so it is checked before the memories are read back
+    int ret = snapshot_write(fout, &build, sizeof(build));
+    ret |= snapshot_write(fout, avr->sreg, sizeof(avr->sreg));
+    ret |= snapshot_write(fout, &avr->state, sizeof(avr->state));
+    ret |= snapshot_write(fout, &avr->cycle, sizeof(avr->cycle));
+    ret |= snapshot_write(fout, &avr->interrupt_state, sizeof(avr->interrupt_state));
+    ret |= snapshot_write(fout, pending, table->vector_count);
+    ret |= snapshot_write(fout, counts, sizeof(counts));
+    ret |= snapshot_write(fout, queue, counts[0]);
+    ret |= snapshot_write(fout, running, counts[1]);
+    ret |= snapshot_write(fout, timers, counts[2] * sizeof(simavr_snapshot_timer_t));
+    ret |= SnapshotWriteMemories(fout);
+    return ret;
+}
+
+int bsim_simavr::MSnapshotRead(FILE* fin) {
+    avr_int_table_t* table = &avr->interrupts;
+    const int mask = (sizeof(table->pending.buffer) / sizeof(table->pending.buffer[0])) - 1;
+    int64_t build;
+    uint8_t sreg[sizeof(avr->sreg)];
+    decltype(avr->state) state;
+    avr_cycle_count_t cycle;
+    decltype(avr->interrupt_state) interrupt_state;
+    simavr_snapshot_timer_t timers[SIMAVR_MAX_TIMERS];
+    int known[SIMAVR_MAX_TIMERS];
+    uint8_t pending[SIMAVR_MAX_VECTORS];
+    uint8_t queue[SIMAVR_MAX_VECTORS];
+    uint8_t running[SIMAVR_MAX_VECTORS];
+    avr_int_vector_p vqueue[SIMAVR_MAX_VECTORS];
+    avr_int_vector_p vrunning[SIMAVR_MAX_VECTORS];
+    uint32_t counts[3];
+
+    // everything is read and checked before changing the cpu
+    if (snapshot_read(fin, &build, sizeof(build)) || (build != SIMAVR_CODE_OFFSET(avr_run))) {
+        printf("PICSimLab: Snapshot of other simavr build!\n");
+        return -1;
+    }
+
+    int ret = snapshot_read(fin, sreg, sizeof(sreg));
+    ret |= snapshot_read(fin, &state, sizeof(state));
+    ret |= snapshot_read(fin, &cycle, sizeof(cycle));
+    ret |= snapshot_read(fin, &interrupt_state, sizeof(interrupt_state));
+    ret |= snapshot_read(fin, pending, table->vector_count);
+    ret |= snapshot_read(fin, counts, sizeof(counts));
+    if (ret || (counts[0] > (uint32_t)mask) || (counts[1] > SIMAVR_MAX_VECTORS) || (counts[2] > SIMAVR_MAX_TIMERS)) {
+        return -1;
+    }
+    ret |= snapshot_read(fin, queue, counts[0]);
+    ret |= snapshot_read(fin, running, counts[1]);
+    ret |= snapshot_read(fin, timers, counts[2] * sizeof(simavr_snapshot_timer_t));
+    if (ret) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < counts[0]; i++) {
+        if (!(vqueue[i] = simavr_vector(table, queue[i]))) {
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < counts[1]; i++) {
+        if (!(vrunning[i] = simavr_vector(table, running[i]))) {
+            return -1;
+        }
+    }
+
+    simavr_known_update(avr);
+    for (uint32_t i = 0; i < counts[2]; i++) {
+        if ((known[i] = simavr_known_find(avr, timers[i].timer, timers[i].param)) < 0) {
+            printf("PICSimLab: Snapshot cycle timer not known in this session, run the simulation before loading!\n");
+            return -1;
+        }
+    }
+
+    // the memory blocks sizes are checked before the first one is read
+    if (SnapshotReadMemories(fin)) {
+        return -1;
+    }
+
+    memcpy(avr->sreg, sreg, sizeof(sreg));
+    avr->state = state;
+    avr->cycle = cycle;
+    avr->interrupt_state = interrupt_state;
+
+    for (int i = 0; i < table->vector_count; i++) {
+        table->vector[i]->pending = pending[i];
+    }
+    table->pending.read = 0;
+    table->pending.write = 0;
+    for (uint32_t i = 0; i < counts[0]; i++) {
+        table->pending.buffer[table->pending.write] = vqueue[i];
+        table->pending.write = (table->pending.write + 1) & mask;
+    }
+    table->running_ptr = 0;
+    for (uint32_t i = 0; i < counts[1]; i++) {
+        table->running[table->running_ptr++] = vrunning[i];
+    }
+
+    // registered in the saved order, timers with the same expiration keep their order
+    avr_cycle_timer_reset(avr);
+    for (uint32_t i = 0; i < counts[2]; i++) {
+        const simavr_known_timer_t* timer = &simavr_known[known[i]];
+        void* param = (timer->param != SIMAVR_NULL_PARAM) ? (char*)avr + timer->param : NULL;
+        avr_cycle_timer_register(avr, timers[i].when, timer->callback, param);
+    }
+    return 0;
+}
+
 void bsim_simavr::EndServers(void) {
     mplabxd_server_end();
 }
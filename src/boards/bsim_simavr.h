@@ -94,23 +94,17 @@ public:
     unsigned int DBGGetCONFIGSize(void) override;
     unsigned int DBGGetIDSize(void) override;
     unsigned int DBGGetEEPROM_Size(void) override;
+    int MSnapshotWrite(FILE* fout) override;
+    int MSnapshotRead(FILE* fin) override;
     void EndServers(void) override;
     int GetDefaultClock(void) override { return 16; };
     int GetUARTRX(const int uart_num) override;
     int GetUARTTX(const int uart_num) override;
     virtual void UpdateHardware(void);
 
-    static void out_hook(struct avr_irq_t* irq, uint32_t value, void* param) {
-        picpin* p = (picpin*)param;
-        p->value = value;
-        ioupdated = 1;
-    }
+    static void out_hook(struct avr_irq_t* irq, uint32_t value, void* param);
 
-    static void ddr_hook(struct avr_irq_t* irq, uint32_t value, void* param) {
-        picpin* p = (picpin*)param;
-        p->dir = !(value & (1 << p->pord));
-        ioupdated = 1;
-    }
+    static void ddr_hook(struct avr_irq_t* irq, uint32_t value, void* param);
 
     void SerialSend(bitbang_uart_t* _bb_uart, const unsigned char value);
 
@@ -121,11 +115,14 @@ protected:
     avr_irq_t* serial_irq[MAX_UART_COUNT];
     picpin pins[256];
     avr_irq_t* Write_stat_irq[100];
+    avr_irq_t* adc_irq[100];  // ADC input irq of each pin, NULL if not analog
     unsigned int serialbaud[MAX_UART_COUNT];
     float serialexbaud[MAX_UART_COUNT];
     void pins_reset(void);
+    void adc_pins_init(void);
     int avr_debug_type;
     serialfd_t serialfd;
+    serial_port_buff_t serialbuff;
     bitbang_uart_t bb_uart[MAX_UART_COUNT];
     unsigned char* eeprom;
     unsigned char uart_config[MAX_UART_COUNT];
@@ -140,6 +137,7 @@ private:
 
 protected:
     int pkg;
+    int pin_count;
 };
 
 #define EIMSK 0x3D
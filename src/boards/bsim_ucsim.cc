@@ -251,7 +251,32 @@ void bsim_ucsim::MSetSerial(const char* port) {
 
      ucsim_step();
 
-     volatile unsigned short p[4];
+     if (ports_read()) {
+         pins_update();
+     }
+ }
+
+ int bsim_ucsim::MRun(const int steps) {
+     int n = 0;
+
+     ioupdated = 0;
+
+     // only the ports are visible to the board, run without returning while they don't change
+     while (n < steps) {
+         ucsim_step();
+         n++;
+         if (ports_read()) {
+             pins_update();
+             break;
+         }
+     }
+     return n;
+ }
+
+ // ucsimlib has no port change notification or multi instruction run, reading the ports after each instruction is
+ // the only way to see a pin change at the instruction that made it. All the four ports have pins on every processor.
+ int bsim_ucsim::ports_read(void) {
+     unsigned short p[4];
 
      p[0] = ucsim_get_port(0);
      p[1] = ucsim_get_port(1);
@@ -259,18 +284,27 @@ void bsim_ucsim::MSetSerial(const char* port) {
      p[3] = ucsim_get_port(3);
 
      if ((p[0] != ports[0]) || (p[1] != ports[1]) || (p[2] != ports[2]) || (p[3] != ports[3])) {
-         ioupdated = 1;
          ports[0] = p[0];
          ports[1] = p[1];
          ports[2] = p[2];
          ports[3] = p[3];
+         return 1;
+     }
+     return 0;
+ }
 
-         for (int i = 0; i < MGetPinCount(); i++) {
-             if (*pins[i].port < 4) {
-                 pins[i].value = (ports[*pins[i].port] & (0x0001 << pins[i].pord)) > 0;
-                 if (procid != PID_C51) {
-                     pins[i].dir = (ports[*pins[i].port] & (0x0100 << pins[i].pord)) > 0;
-                 }
+ void bsim_ucsim::pins_update(void) {
+     for (int i = 0; i < MGetPinCount(); i++) {
+         if (*pins[i].port < 4) {
+             unsigned char value = (ports[*pins[i].port] & (0x0001 << pins[i].pord)) > 0;
+             unsigned char dir = pins[i].dir;
+             if (procid != PID_C51) {
+                 dir = (ports[*pins[i].port] & (0x0100 << pins[i].pord)) > 0;
+             }
+             if ((pins[i].value != value) || (pins[i].dir != dir)) {
+                 pins[i].value = value;
+                 pins[i].dir = dir;
+                 ioupdated_pin(i + 1);
              }
          }
      }
@@ -59,7 +59,13 @@ public:
     void MReset(int flags) override;
 
 protected:
+    /**
+     * @brief Run up to steps instructions, stopping after the first one that changes some port; returns the steps run
+     */
+    int MRun(const int steps);
     void pins_reset(void);
+    int ports_read(void);
+    void pins_update(void);
     picpin pins[256];
     unsigned int serialbaud;
     float serialexbaud;
@@ -196,7 +196,7 @@ static void bitbang_i2c_ctrl_callback(void* arg) {
     switch (i2c->status) {
         case I2C_START:
             if (i2c->clkpc == 0) {
-                ioupdated = 1;
+                i2c->pboard->ioupdated = 1;
                 i2c->sda_dir = PD_OUT;
                 i2c->sda_value = 0;
                 i2c->scl_value = 1;
@@ -209,7 +209,7 @@ static void bitbang_i2c_ctrl_callback(void* arg) {
             break;
         case I2C_STOP:
             if (i2c->clkpc == 0) {
-                ioupdated = 1;
+                i2c->pboard->ioupdated = 1;
                 i2c->sda_dir = PD_OUT;
                 i2c->sda_value = 1;
                 i2c->scl_value = 1;
@@ -224,7 +224,7 @@ static void bitbang_i2c_ctrl_callback(void* arg) {
             if (i2c->bit < 8) {
                 switch (i2c->clkpc) {
                     case 0:
-                        ioupdated = 1;
+                        i2c->pboard->ioupdated = 1;
                         i2c->scl_value = 0;
                         break;
                     case 1:
@@ -232,7 +232,7 @@ static void bitbang_i2c_ctrl_callback(void* arg) {
                         i2c->sda_value = (i2c->datab & (0x01 << (7 - i2c->bit))) > 0;
                         break;
                     case 2:
-                        ioupdated = 1;
+                        i2c->pboard->ioupdated = 1;
                         i2c->scl_value = 1;
                         break;
                     case 3:
@@ -244,7 +244,7 @@ static void bitbang_i2c_ctrl_callback(void* arg) {
             } else {  // read ACK
                 switch (i2c->clkpc) {
                     case 0:
-                        ioupdated = 1;
+                        i2c->pboard->ioupdated = 1;
                         i2c->scl_value = 0;
                         if (i2c->bit > 8) {
                             i2c->sda_dir = PD_OUT;
@@ -259,7 +259,7 @@ static void bitbang_i2c_ctrl_callback(void* arg) {
                         i2c->scl_value = 0;
                         break;
                     case 2:
-                        ioupdated = 1;
+                        i2c->pboard->ioupdated = 1;
                         i2c->scl_value = 1;
                         i2c->ack = i2c->sda_value;  // FIXME verify ack
                         break;
@@ -276,14 +276,14 @@ static void bitbang_i2c_ctrl_callback(void* arg) {
             if (i2c->bit < 8) {
                 switch (i2c->clkpc) {
                     case 0:
-                        ioupdated = 1;
+                        i2c->pboard->ioupdated = 1;
                         i2c->scl_value = 0;
                         break;
                     case 1:
                         i2c->scl_value = 0;
                         break;
                     case 2:
-                        ioupdated = 1;
+                        i2c->pboard->ioupdated = 1;
                         i2c->scl_value = 1;
                         break;
                     case 3:
@@ -296,7 +296,7 @@ static void bitbang_i2c_ctrl_callback(void* arg) {
             } else {  // read ACK
                 switch (i2c->clkpc) {
                     case 0:
-                        ioupdated = 1;
+                        i2c->pboard->ioupdated = 1;
                         i2c->scl_value = 0;
                         if (i2c->bit > 8) {
                             i2c->sda_dir = PD_OUT;
@@ -312,7 +312,7 @@ static void bitbang_i2c_ctrl_callback(void* arg) {
                         i2c->sda_value = i2c->ack;  // FIXME verify ack
                         break;
                     case 2:
-                        ioupdated = 1;
+                        i2c->pboard->ioupdated = 1;
                         i2c->scl_value = 1;
                         break;
                     case 3:
@@ -342,7 +342,7 @@ void bitbang_i2c_ctrl_end(bitbang_i2c_t* i2c) {
 }
 
 void bitbang_i2c_ctrl_start(bitbang_i2c_t* i2c) {
-    ioupdated = 1;
+    i2c->pboard->ioupdated = 1;
     i2c->sda_dir = PD_OUT;
     i2c->sda_value = 1;
     i2c->scl_value = 1;
@@ -357,7 +357,7 @@ void bitbang_i2c_ctrl_restart(bitbang_i2c_t* i2c) {
 }
 
 void bitbang_i2c_ctrl_stop(bitbang_i2c_t* i2c) {
-    ioupdated = 1;
+    i2c->pboard->ioupdated = 1;
     i2c->sda_dir = PD_OUT;
     i2c->sda_value = 0;
     i2c->scl_value = 1;
@@ -367,7 +367,7 @@ void bitbang_i2c_ctrl_stop(bitbang_i2c_t* i2c) {
 }
 
 void bitbang_i2c_ctrl_write(bitbang_i2c_t* i2c, const unsigned char data) {
-    ioupdated = 1;
+    i2c->pboard->ioupdated = 1;
     i2c->sda_dir = PD_OUT;
     i2c->status = I2C_DATAW;
     i2c->bit = 0;
@@ -378,7 +378,7 @@ void bitbang_i2c_ctrl_write(bitbang_i2c_t* i2c, const unsigned char data) {
 }
 
 void bitbang_i2c_ctrl_read(bitbang_i2c_t* i2c) {
-    ioupdated = 1;
+    i2c->pboard->ioupdated = 1;
     i2c->sda_dir = PD_IN;
     i2c->status = I2C_DATAR;
     i2c->bit = 0;
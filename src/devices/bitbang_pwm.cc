@@ -57,7 +57,7 @@ static void bitbang_pwm_ctrl_callback(void* arg) {
             }
             if (pwm->out[i] != out) {
                 pwm->out[i] = out;
-                ioupdated = 1;
+                pwm->pboard->ioupdated = 1;
             }
         }
     }
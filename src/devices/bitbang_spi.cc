@@ -165,7 +165,7 @@ static void bitbang_spi_ctrl_callback(void* arg) {
 
     switch (spi->clkpc) {
         case 0:  // CLK HIGH -> LOW
-            ioupdated = 1;
+            spi->pboard->ioupdated = 1;
             spi->sck_value = 0;
             if (spi->bit == spi->lenght) {
                 // spi->cs_value = 1;
@@ -180,7 +180,7 @@ static void bitbang_spi_ctrl_callback(void* arg) {
             spi->copi_value = (spi->outsr & (0x01 << (7 - spi->bit))) > 0;
             break;
         case 2:  // CLK LOW -> HIGH
-            ioupdated = 1;
+            spi->pboard->ioupdated = 1;
             spi->sck_value = 1;
             break;
         case 3:  // CLK MIDLE HIGH
@@ -215,7 +215,7 @@ void bitbang_spi_ctrl_end(bitbang_spi_t* spi) {
 
 void bitbang_spi_ctrl_write(bitbang_spi_t* spi, const unsigned char data) {
     dprintf("ctrl bitbang_spi ctrl data to send 0x%02x \n", data);
-    ioupdated = 1;
+    spi->pboard->ioupdated = 1;
     spi->insr = 0;
     spi->outsr = 0;
     spi->bit = 0;
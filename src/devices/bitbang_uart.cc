@@ -71,7 +71,7 @@ static void bitbang_uart_rx_callback(void* arg) {
         }
         bu->datar = bu->insr >> 8;
         bu->data_recv = 1;
-        ioupdated = 1;  // to check for new bytes
+        bu->pboard->ioupdated = 1;  // to check for new bytes
         dprintf("uart rx 0x%02X (%c)\n", bu->datar, bu->datar);
 
         if (bu->CallbackRX) {
@@ -87,7 +87,7 @@ static void bitbang_uart_tx_callback(void* arg) {
 
     bu->outsr = (bu->outsr >> 1);
     bu->bcw++;
-    ioupdated = 1;
+    bu->pboard->ioupdated = 1;
     bu->tx_value = (bu->outsr & 0x01);
     if (bu->bcw > 10) {
         bu->bcw = 0;
@@ -151,7 +151,7 @@ void bitbang_uart_send(bitbang_uart_t* bu, const unsigned char data) {
 
     dprintf("uart tx 0x%02X (%c)\n", bu->dataw, bu->dataw);
     bu->outsr = (bu->dataw << 1) | 0xFE00;
-    ioupdated = 1;
+    bu->pboard->ioupdated = 1;
     bu->bcw = 1;
     bu->leds |= 0x02;
 
@@ -452,6 +452,51 @@ static const char* debug_BSB(eth_w5500_t* eth) {
 }
 #endif
 
+// allocate the 16KB RX and TX memories to the sockets in order, like the W5500 does
+// called at reset and at socket OPEN, sockets not closed keep their memory, pointers and FSR
+static void eth_w5500_buffers_cfg(eth_w5500_t* eth) {
+    unsigned short rx_ptr = 0;
+    unsigned short tx_ptr = 0;
+
+    for (int n = 0; n < 8; n++) {
+        if (eth->Socket[n][Sn_SR] != SOCK_CLOSED) {
+            rx_ptr = eth->RX_ptr[n] + eth->RX_size[n];
+            tx_ptr = eth->TX_ptr[n] + eth->TX_size[n];
+            continue;
+        }
+
+        unsigned int rx_size = eth->Socket[n][Sn_RXBUF_SIZE] * 1024;
+        unsigned int tx_size = eth->Socket[n][Sn_TXBUF_SIZE] * 1024;
+
+        // valid sizes are 0, 1, 2, 4, 8 and 16KB
+        if ((rx_size > 0x4000) || (rx_size & (rx_size - 1))) {
+            rx_size = eth->RX_size[n];
+        }
+        if ((tx_size > 0x4000) || (tx_size & (tx_size - 1))) {
+            tx_size = eth->TX_size[n];
+        }
+        // sockets that don't fit get no memory
+        if ((rx_ptr + rx_size) > 0x4000) {
+            rx_size = 0;
+        }
+        if ((tx_ptr + tx_size) > 0x4000) {
+            tx_size = 0;
+        }
+
+        eth->RX_size[n] = rx_size;
+        eth->TX_size[n] = tx_size;
+        eth->RX_mask[n] = rx_size ? rx_size - 1 : 0;
+        eth->TX_mask[n] = tx_size ? tx_size - 1 : 0;
+        eth->RX_ptr[n] = rx_size ? rx_ptr : 0;
+        eth->TX_ptr[n] = tx_size ? tx_ptr : 0;
+
+        writeWord(eth->Socket[n], Sn_TX_FSR0, tx_size);
+
+        rx_ptr += rx_size;
+        tx_ptr += tx_size;
+    }
+}
+
 void eth_w5500_rst(eth_w5500_t* eth) {
     bitbang_spi_rst(&eth->bb_spi);
     eth->control = 0;
@@ -468,23 +513,16 @@ void eth_w5500_rst(eth_w5500_t* eth) {
     } else {
         eth->Common[CR_PHYCFGR] &= ~0x01;  // link off
     }
-    // TODO add support to buffer size different of 2k
     for (int n = 0; n < 8; n++) {
         eth->sockfd[n] = INVALID_SOCKET_VALUE;
         eth->Socket[n][Sn_TXBUF_SIZE] = 2;
         eth->Socket[n][Sn_RXBUF_SIZE] = 2;
-
-        eth->RX_size[n] = eth->Socket[n][Sn_RXBUF_SIZE] * 1024;
-        eth->TX_size[n] = eth->Socket[n][Sn_TXBUF_SIZE] * 1024;
-        eth->RX_mask[n] = eth->RX_size[n] - 1;
-        eth->TX_mask[n] = eth->TX_size[n] - 1;
-
-        writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
-
-        eth->RX_ptr[n] = eth->RX_size[n] * n;
-        eth->TX_ptr[n] = eth->TX_size[n] * n;
+        eth->RX_size[n] = 2048;
+        eth->TX_size[n] = 2048;
         eth->listenfd_map[n] = 0;
+        eth->poll_cnt[n] = 0;
     }
+    eth_w5500_buffers_cfg(eth);
     dprintf("rst w5500\n");
 }
 
@@ -717,7 +755,7 @@ static void eth_w5500_fake_dhcp_reply(eth_w5500_t* eth, int n) {
     size -= readWord(eth->Socket[n], Sn_RX_RD0);
 
     if (size < 0) {
-        size += eth->RX_size[n];
+        size += 0x10000;  // 16 bits pointers
     }
     writeWord(eth->Socket[n], Sn_RX_RSR0, size);
 
@@ -736,7 +774,8 @@ static void eth_w5500_fake_dhcp_reply(eth_w5500_t* eth, int n) {
 
 static unsigned int conn_timeout[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 
-void eth_w5500_process(eth_w5500_t* eth) {
+// service the host socket of one emulated socket, slice is set when called once per simulation slice
+static void eth_w5500_socket_process(eth_w5500_t* eth, const int n, const int slice) {
     char temp_buff[0x4000];
     char skt_addr[30];
     unsigned short skt_port;
@@ -755,266 +794,269 @@ void eth_w5500_process(eth_w5500_t* eth) {
     FILE* fouts;
 #endif
 
-    if (eth->active)
-        eth->active--;
+    switch (eth->Socket[n][Sn_SR]) {
+        case SOCK_SYNSENT:
+            sprintf(skt_addr, "%i.%i.%i.%i", eth->Socket[n][Sn_DIPR0], eth->Socket[n][Sn_DIPR1],
+                    eth->Socket[n][Sn_DIPR2], eth->Socket[n][Sn_DIPR3]);
+            skt_port = readWord(eth->Socket[n], Sn_DPORT0);
 
-    if (!eth->link)
-        return;
-
-    for (int n = 0; n < 8; n++) {
-        switch (eth->Socket[n][Sn_SR]) {
-            case SOCK_SYNSENT:
-                sprintf(skt_addr, "%i.%i.%i.%i", eth->Socket[n][Sn_DIPR0], eth->Socket[n][Sn_DIPR1],
-                        eth->Socket[n][Sn_DIPR2], eth->Socket[n][Sn_DIPR3]);
-                skt_port = readWord(eth->Socket[n], Sn_DPORT0);
-
-                memset(&serv, 0, sizeof(serv));
-                serv.sin_family = AF_INET;
-                serv.sin_addr.s_addr = inet_addr(skt_addr);
-                serv.sin_port = htons(skt_port);
+            memset(&serv, 0, sizeof(serv));
+            serv.sin_family = AF_INET;
+            serv.sin_addr.s_addr = inet_addr(skt_addr);
+            serv.sin_port = htons(skt_port);
 
-                if (connect(eth->sockfd[n], (sockaddr*)&serv, sizeof(serv)) < 0) {
+            if (connect(eth->sockfd[n], (sockaddr*)&serv, sizeof(serv)) < 0) {
 #ifndef _WIN_
-                    if ((errno == EINPROGRESS) || (errno == EALREADY))
+                if ((errno == EINPROGRESS) || (errno == EALREADY))
 #else
-                    if ((WSAGetLastError() == WSAEINPROGRESS) || (WSAGetLastError() == WSAEALREADY) ||
-                        (WSAGetLastError() == WSAEWOULDBLOCK))
+                if ((WSAGetLastError() == WSAEINPROGRESS) || (WSAGetLastError() == WSAEALREADY) ||
+                    (WSAGetLastError() == WSAEWOULDBLOCK))
 #endif
-                    {
-                        conn_timeout[n]++;
-                        if (conn_timeout[n] < CONN_TIMEOUT) {
-                            break;
-                        }
+                {
+                    conn_timeout[n] += slice;  // count only slices, services on register access are extra
+                    if (conn_timeout[n] < CONN_TIMEOUT) {
+                        break;
                     }
+                }
 #ifdef _WIN_
-                    if (WSAGetLastError() != WSAEISCONN) {
+                if (WSAGetLastError() != WSAEISCONN) {
 #endif
-                        printf("eth_w5500: connect error : %s \n", strerror(errno));
-                        eth->Socket[n][Sn_SR] = SOCK_CLOSED;
-                        eth->status[n] = ER_CONN;
-                        break;
+                    printf("eth_w5500: connect error : %s \n", strerror(errno));
+                    eth->Socket[n][Sn_SR] = SOCK_CLOSED;
+                    eth->status[n] = ER_CONN;
+                    break;
 #ifdef _WIN_
-                    }
-#endif
                 }
+#endif
+            }
 
-                dsprintf("Socket %i Connected to %s:%i\n", n, skt_addr, skt_port);
+            dsprintf("Socket %i Connected to %s:%i\n", n, skt_addr, skt_port);
+            eth->Socket[n][Sn_SR] = SOCK_ESTABLISHED;
+            eth->Socket[n][Sn_IR] |= 0x01;
+
+            writeWord(eth->Socket[n], Sn_TX_RD0, 0);
+            writeWord(eth->Socket[n], Sn_TX_WR0, 0);
+            writeWord(eth->Socket[n], Sn_RX_RD0, 0);
+            writeWord(eth->Socket[n], Sn_RX_WR0, 0);
+            writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
+            writeWord(eth->Socket[n], Sn_RX_RSR0, 0);
+            setnblock(eth->sockfd[n]);
+            break;
+        case SOCK_LISTEN:
+            if ((eth->sockfd[n] = accept(eth->listenfd[eth->listenfd_map[n]], (sockaddr*)&cli, &clilen)) < 0) {
+                // printf ("eth_w5500: accept error : %s \n", strerror (errno));
+                eth->sockfd[n] = INVALID_SOCKET_VALUE;
+            } else {
+                setnblock(eth->sockfd[n]);
                 eth->Socket[n][Sn_SR] = SOCK_ESTABLISHED;
-                eth->Socket[n][Sn_IR] |= 0x01;
-
+                dsprintf("Socket %i Connected\n", n);
                 writeWord(eth->Socket[n], Sn_TX_RD0, 0);
                 writeWord(eth->Socket[n], Sn_TX_WR0, 0);
                 writeWord(eth->Socket[n], Sn_RX_RD0, 0);
                 writeWord(eth->Socket[n], Sn_RX_WR0, 0);
-                writeWord(eth->Socket[n], Sn_TX_FSR0, eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
+                writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
                 writeWord(eth->Socket[n], Sn_RX_RSR0, 0);
-                setnblock(eth->sockfd[n]);
-                break;
-            case SOCK_LISTEN:
-                if ((eth->sockfd[n] = accept(eth->listenfd[eth->listenfd_map[n]], (sockaddr*)&cli, &clilen)) < 0) {
-                    // printf ("eth_w5500: accept error : %s \n", strerror (errno));
-                    eth->sockfd[n] = INVALID_SOCKET_VALUE;
-                } else {
-                    setnblock(eth->sockfd[n]);
-                    eth->Socket[n][Sn_SR] = SOCK_ESTABLISHED;
-                    dsprintf("Socket %i Connected\n", n);
-                    writeWord(eth->Socket[n], Sn_TX_RD0, 0);
-                    writeWord(eth->Socket[n], Sn_TX_WR0, 0);
-                    writeWord(eth->Socket[n], Sn_RX_RD0, 0);
-                    writeWord(eth->Socket[n], Sn_RX_WR0, 0);
-                    writeWord(eth->Socket[n], Sn_TX_FSR0, eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
-                    writeWord(eth->Socket[n], Sn_RX_RSR0, 0);
-                    eth->bindp[n] = 0;
-                }
-                break;
-            case SOCK_ESTABLISHED:
+                eth->bindp[n] = 0;
+            }
+            break;
+        case SOCK_ESTABLISHED:
 
-                size = eth->RX_size[n] - readWord(eth->Socket[n], Sn_RX_RSR0);
-                if (size < 0)
-                    size = 0;
+            size = eth->RX_size[n] - readWord(eth->Socket[n], Sn_RX_RSR0);
+            if (size < 0)
+                size = 0;
 
-                if (size) {
-                    if ((s = recv(eth->sockfd[n], temp_buff, size, 0)) < 0) {
+            if (size) {
+                if ((s = recv(eth->sockfd[n], temp_buff, size, 0)) < 0) {
 #ifndef _WIN_
-                        if (errno != EAGAIN)
+                    if (errno != EAGAIN)
 #else
-                        if (WSAGetLastError() != WSAEWOULDBLOCK)
+                    if (WSAGetLastError() != WSAEWOULDBLOCK)
 #endif
-                        {
-                            printf("eth_w5500: recv tcp error :[%i] %s \n", errno, strerror(errno));
-                            eth->Socket[n][Sn_SR] = SOCK_CLOSED;
-                            eth->status[n] = ER_RECV;
-                        }
+                    {
+                        printf("eth_w5500: recv tcp error :[%i] %s \n", errno, strerror(errno));
+                        eth->Socket[n][Sn_SR] = SOCK_CLOSED;
+                        eth->status[n] = ER_RECV;
                     }
-                    if (s > 0) {
-                        eth->active = 2;
-                        eth->Socket[n][Sn_IR] |= 0x04;
+                }
+                if (s > 0) {
+                    eth->active = 2;
+                    eth->Socket[n][Sn_IR] |= 0x04;
 
-                        addr_base = (readWord(eth->Socket[n], Sn_RX_WR0));
+                    addr_base = (readWord(eth->Socket[n], Sn_RX_WR0));
 
-                        for (i = 0; i < s; i++) {
-                            addr = (addr_base + i) & eth->RX_mask[n];
-                            eth->RX_Mem[eth->RX_ptr[n] + addr] = temp_buff[i];
-                        }
+                    for (i = 0; i < s; i++) {
+                        addr = (addr_base + i) & eth->RX_mask[n];
+                        eth->RX_Mem[eth->RX_ptr[n] + addr] = temp_buff[i];
+                    }
 
-                        dsprintf("eth_w5500: Socket %i Received %i\n", n, s);
-                        writeWord(eth->Socket[n], Sn_RX_WR0, readWord(eth->Socket[n], Sn_RX_WR0) + s);
+                    dsprintf("eth_w5500: Socket %i Received %i\n", n, s);
+                    writeWord(eth->Socket[n], Sn_RX_WR0, readWord(eth->Socket[n], Sn_RX_WR0) + s);
 
-                        size = readWord(eth->Socket[n], Sn_RX_WR0);
-                        size -= readWord(eth->Socket[n], Sn_RX_RD0);
+                    size = readWord(eth->Socket[n], Sn_RX_WR0);
+                    size -= readWord(eth->Socket[n], Sn_RX_RD0);
 
-                        if (size < 0) {
-                            size += eth->RX_size[n];
-                        }
+                    if (size < 0) {
+                        size += 0x10000;  // 16 bits pointers
+                    }
 
-                        writeWord(eth->Socket[n], Sn_RX_RSR0, size);
+                    writeWord(eth->Socket[n], Sn_RX_RSR0, size);
 
 #ifdef DUMP
-                        sprintf(sfname, "/tmp/%03i_recv_tcp.bin", scont++);
-                        fouts = fopen(sfname, "w");
-                        fwrite(temp_buff, s, 1, fouts);
-                        fclose(fouts);
+                    sprintf(sfname, "/tmp/%03i_recv_tcp.bin", scont++);
+                    fouts = fopen(sfname, "w");
+                    fwrite(temp_buff, s, 1, fouts);
+                    fclose(fouts);
 #endif
 #ifdef TEXTDUMP
-                        temp_buff[s] = 0;
-                        printf(temp_buff);
+                    temp_buff[s] = 0;
+                    printf(temp_buff);
 #endif
-                    }
                 }
-                break;
-            case SOCK_UDP:
+            }
+            break;
+        case SOCK_UDP:
 
-                sprintf(skt_addr, "%i.%i.%i.%i", eth->Socket[n][Sn_DIPR0], eth->Socket[n][Sn_DIPR1],
-                        eth->Socket[n][Sn_DIPR2], eth->Socket[n][Sn_DIPR3]);
-                skt_port = readWord(eth->Socket[n], Sn_DPORT0);
+            sprintf(skt_addr, "%i.%i.%i.%i", eth->Socket[n][Sn_DIPR0], eth->Socket[n][Sn_DIPR1],
+                    eth->Socket[n][Sn_DIPR2], eth->Socket[n][Sn_DIPR3]);
+            skt_port = readWord(eth->Socket[n], Sn_DPORT0);
 
-                memset(&serv, 0, sizeof(serv));
+            memset(&serv, 0, sizeof(serv));
 
-                // Filling server information
-                serv.sin_family = AF_INET;
-                serv.sin_port = htons(skt_port);
-                serv.sin_addr.s_addr = inet_addr(skt_addr);
+            // Filling server information
+            serv.sin_family = AF_INET;
+            serv.sin_port = htons(skt_port);
+            serv.sin_addr.s_addr = inet_addr(skt_addr);
 
-                for (j = 0; j < 8; j++) {
-                    if ((eth->listenfd_port[j] == 0) || (eth->listenfd_port[j] == skt_port)) {
-                        eth->listenfd_map[n] = j;
-                        eth->listenfd_port[j] = skt_port;
-                        break;
-                    }
+            for (j = 0; j < 8; j++) {
+                if ((eth->listenfd_port[j] == 0) || (eth->listenfd_port[j] == skt_port)) {
+                    eth->listenfd_map[n] = j;
+                    eth->listenfd_port[j] = skt_port;
+                    break;
                 }
+            }
 
-                if ((eth->listenfd[eth->listenfd_map[n]] == INVALID_SOCKET_VALUE) && !strcmp(skt_addr, "0.0.0.0") &&
-                    (skt_port == 0)) {
-                    skt_port = readWord(eth->Socket[n], Sn_PORT0);
+            if ((eth->listenfd[eth->listenfd_map[n]] == INVALID_SOCKET_VALUE) && !strcmp(skt_addr, "0.0.0.0") &&
+                (skt_port == 0)) {
+                skt_port = readWord(eth->Socket[n], Sn_PORT0);
 
-                    if (skt_port < 2000)  // avoid system services
-                    {
-                        skt_port += 2000;
-                    }
+                if (skt_port < 2000)  // avoid system services
+                {
+                    skt_port += 2000;
+                }
 
-                    eth->bindp[n] = skt_port;
-                    memset(&serv, 0, sizeof(serv));
+                eth->bindp[n] = skt_port;
+                memset(&serv, 0, sizeof(serv));
 
-                    // Filling server information
-                    serv.sin_family = AF_INET;
-                    serv.sin_port = htons(skt_port);
-                    serv.sin_addr.s_addr = htonl(INADDR_ANY);
+                // Filling server information
+                serv.sin_family = AF_INET;
+                serv.sin_port = htons(skt_port);
+                serv.sin_addr.s_addr = htonl(INADDR_ANY);
 
-                    eth->listenfd[eth->listenfd_map[n]] = eth->sockfd[n];
-                    if (bind(eth->listenfd[eth->listenfd_map[n]], (sockaddr*)&serv, sizeof(serv))) {
-                        printf("eth_w5500: bind error : %s \n", strerror(errno));
-                        close(eth->sockfd[n]);
-                        eth->sockfd[n] = INVALID_SOCKET_VALUE;
-                        eth->Socket[n][Sn_SR] = SOCK_CLOSED;
-                        eth->status[n] = ER_BIND;
-                        eth->bindp[n] = 0;
-                        eth->listenfd[eth->listenfd_map[n]] = INVALID_SOCKET_VALUE;
-                        eth->listenfd_port[eth->listenfd_map[n]] = 0;
-                        break;
-                    }
-                    dsprintf("Socket %i listen on port %i \n", n, skt_port);
+                eth->listenfd[eth->listenfd_map[n]] = eth->sockfd[n];
+                if (bind(eth->listenfd[eth->listenfd_map[n]], (sockaddr*)&serv, sizeof(serv))) {
+                    printf("eth_w5500: bind error : %s \n", strerror(errno));
+                    close(eth->sockfd[n]);
+                    eth->sockfd[n] = INVALID_SOCKET_VALUE;
+                    eth->Socket[n][Sn_SR] = SOCK_CLOSED;
+                    eth->status[n] = ER_BIND;
+                    eth->bindp[n] = 0;
+                    eth->listenfd[eth->listenfd_map[n]] = INVALID_SOCKET_VALUE;
+                    eth->listenfd_port[eth->listenfd_map[n]] = 0;
+                    break;
                 }
+                dsprintf("Socket %i listen on port %i \n", n, skt_port);
+            }
 
-                size = (eth->Socket[n][Sn_RXBUF_SIZE] * 1024);
-                if (size < 0)
-                    size = 0;
+            size = eth->RX_size[n] - readWord(eth->Socket[n], Sn_RX_RSR0) - 8;  // free space less the header
+            if (size < 0)
+                size = 0;
 
-                if (size) {
-                    len = sizeof(serv);
+            if (size) {
+                len = sizeof(serv);
 
-                    if ((s = recvfrom(eth->sockfd[n], &temp_buff[8],
-                                      eth->RX_size[n] - readWord(eth->Socket[n], Sn_RX_RSR0),
-                                      0 /*MSG_DONTWAIT MSG_WAITALL*/, (struct sockaddr*)&serv, &len)) < 0) {
+                if ((s = recvfrom(eth->sockfd[n], &temp_buff[8], size, 0 /*MSG_DONTWAIT MSG_WAITALL*/,
+                                  (struct sockaddr*)&serv, &len)) < 0) {
 #ifndef _WIN_
-                        if (errno != EAGAIN)
+                    if (errno != EAGAIN)
 #else
-                        if ((WSAGetLastError() != WSAEWOULDBLOCK) && (WSAGetLastError() != WSAEINVAL))
+                    if ((WSAGetLastError() != WSAEWOULDBLOCK) && (WSAGetLastError() != WSAEINVAL))
 #endif
-                        {
-                            printf("eth_w5500: recv udp error : %s \n", strerror(errno));
-                            eth->Socket[n][Sn_SR] = SOCK_CLOSED;
-                            eth->status[n] = ER_RECV;
-                        }
+                    {
+                        printf("eth_w5500: recv udp error : %s \n", strerror(errno));
+                        eth->Socket[n][Sn_SR] = SOCK_CLOSED;
+                        eth->status[n] = ER_RECV;
                     }
+                }
 
-                    if (s > 0) {
-                        eth->active = 2;
-                        eth->Socket[n][Sn_IR] |= 0x04;
+                if (s > 0) {
+                    eth->active = 2;
+                    eth->Socket[n][Sn_IR] |= 0x04;
 
-                        strncpy(skt_addr, inet_ntoa(serv.sin_addr), 29);
-                        skt_port = ntohs(serv.sin_port);
+                    strncpy(skt_addr, inet_ntoa(serv.sin_addr), 29);
+                    skt_port = ntohs(serv.sin_port);
 
-                        eth->Socket[n][Sn_DIPR0] = (serv.sin_addr.s_addr & 0x000000FF);
-                        eth->Socket[n][Sn_DIPR1] = (serv.sin_addr.s_addr & 0x0000FF00) >> 8;
-                        eth->Socket[n][Sn_DIPR2] = (serv.sin_addr.s_addr & 0x00FF0000) >> 16;
-                        eth->Socket[n][Sn_DIPR3] = (serv.sin_addr.s_addr & 0xFF000000) >> 24;
-                        eth->Socket[n][Sn_DPORT0] = skt_port >> 8;
-                        eth->Socket[n][Sn_DPORT1] = skt_port & 0xFF;
+                    eth->Socket[n][Sn_DIPR0] = (serv.sin_addr.s_addr & 0x000000FF);
+                    eth->Socket[n][Sn_DIPR1] = (serv.sin_addr.s_addr & 0x0000FF00) >> 8;
+                    eth->Socket[n][Sn_DIPR2] = (serv.sin_addr.s_addr & 0x00FF0000) >> 16;
+                    eth->Socket[n][Sn_DIPR3] = (serv.sin_addr.s_addr & 0xFF000000) >> 24;
+                    eth->Socket[n][Sn_DPORT0] = skt_port >> 8;
+                    eth->Socket[n][Sn_DPORT1] = skt_port & 0xFF;
 
-                        dsprintf("eth_w5500: Socket %i Received %i from %s:%i\n", n, s, skt_addr, skt_port);
+                    dsprintf("eth_w5500: Socket %i Received %i from %s:%i\n", n, s, skt_addr, skt_port);
 
-                        temp_buff[0] = eth->Socket[n][Sn_DIPR0];
-                        temp_buff[1] = eth->Socket[n][Sn_DIPR1];
-                        temp_buff[2] = eth->Socket[n][Sn_DIPR2];
-                        temp_buff[3] = eth->Socket[n][Sn_DIPR3];
-                        temp_buff[4] = eth->Socket[n][Sn_DPORT0];
-                        temp_buff[5] = eth->Socket[n][Sn_DPORT1];
-                        temp_buff[6] = s >> 8;
-                        temp_buff[7] = s & 0x00FF;
+                    temp_buff[0] = eth->Socket[n][Sn_DIPR0];
+                    temp_buff[1] = eth->Socket[n][Sn_DIPR1];
+                    temp_buff[2] = eth->Socket[n][Sn_DIPR2];
+                    temp_buff[3] = eth->Socket[n][Sn_DIPR3];
+                    temp_buff[4] = eth->Socket[n][Sn_DPORT0];
+                    temp_buff[5] = eth->Socket[n][Sn_DPORT1];
+                    temp_buff[6] = s >> 8;
+                    temp_buff[7] = s & 0x00FF;
 
-                        s += 8;  // add header size to total size
+                    s += 8;  // add header size to total size
 
-                        addr_base = (readWord(eth->Socket[n], Sn_RX_WR0));
+                    addr_base = (readWord(eth->Socket[n], Sn_RX_WR0));
 
-                        for (i = 0; i < s; i++) {
-                            addr = (addr_base + i) & eth->RX_mask[n];
-                            eth->RX_Mem[eth->RX_ptr[n] + addr] = temp_buff[i];
-                        }
+                    for (i = 0; i < s; i++) {
+                        addr = (addr_base + i) & eth->RX_mask[n];
+                        eth->RX_Mem[eth->RX_ptr[n] + addr] = temp_buff[i];
+                    }
 
-                        writeWord(eth->Socket[n], Sn_RX_WR0, readWord(eth->Socket[n], Sn_RX_WR0) + s);
+                    writeWord(eth->Socket[n], Sn_RX_WR0, readWord(eth->Socket[n], Sn_RX_WR0) + s);
 
-                        size = readWord(eth->Socket[n], Sn_RX_WR0);
-                        size -= readWord(eth->Socket[n], Sn_RX_RD0);
+                    size = readWord(eth->Socket[n], Sn_RX_WR0);
+                    size -= readWord(eth->Socket[n], Sn_RX_RD0);
 
-                        if (size < 0) {
-                            size += eth->RX_size[n];
-                        }
-                        writeWord(eth->Socket[n], Sn_RX_RSR0, size);
+                    if (size < 0) {
+                        size += 0x10000;  // 16 bits pointers
+                    }
+                    writeWord(eth->Socket[n], Sn_RX_RSR0, size);
 
 #ifdef DUMP
-                        sprintf(sfname, "/tmp/%03i_recv_udp.bin", scont++);
-                        fouts = fopen(sfname, "w");
-                        fwrite(temp_buff, s, 1, fouts);
-                        fclose(fouts);
+                    sprintf(sfname, "/tmp/%03i_recv_udp.bin", scont++);
+                    fouts = fopen(sfname, "w");
+                    fwrite(temp_buff, s, 1, fouts);
+                    fclose(fouts);
 #endif
 #ifdef TEXTDUMP
-                        temp_buff[s] = 0;
-                        printf(temp_buff);
+                    temp_buff[s] = 0;
+                    printf(temp_buff);
 #endif
-                    }
                 }
-                break;
-        }
+            }
+            break;
+    }
+}
+
+void eth_w5500_process(eth_w5500_t* eth) {
+    if (eth->active)
+        eth->active--;
+
+    if (!eth->link)
+        return;
+
+    for (int n = 0; n < 8; n++) {
+        eth_w5500_socket_process(eth, n, 1);
     }
 }
 
@@ -1088,6 +1130,15 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                     case Sn_TX_WR1:
                                         eth->bb_spi.outsr = 0;
                                         break;
+                                    case Sn_SR:
+                                    case Sn_RX_RSR0:
+                                        // firmware is polling, service the host socket now instead of waiting for
+                                        // the next slice
+                                        if (eth->link && !((++eth->poll_cnt[n]) & 0x0F)) {
+                                            eth_w5500_socket_process(eth, n, 0);
+                                        }
+                                        eth->bb_spi.outsr = eth->Socket[n][eth->addr & 0x2F];
+                                        break;
                                     default:
                                         eth->bb_spi.outsr = eth->Socket[n][eth->addr & 0x2F];
                                         break;
@@ -1102,8 +1153,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                             case B_SCK6RX:
                             case B_SCK7RX:
                                 n = (BSB - B_SCK0RX) / 4;
-                                size = (eth->Socket[n][Sn_RXBUF_SIZE] * 1024);
-                                addr = eth->addr & (size - 1);
+                                addr = eth->addr & eth->RX_mask[n];
                                 eth->bb_spi.outsr = eth->RX_Mem[eth->RX_ptr[n] + addr];
                                 break;
                             case B_SCK0TX:
@@ -1115,8 +1165,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                             case B_SCK6TX:
                             case B_SCK7TX:
                                 n = (BSB - B_SCK0TX) / 4;
-                                size = (eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
-                                addr = eth->addr & (size - 1);
+                                addr = eth->addr & eth->TX_mask[n];
                                 eth->bb_spi.outsr = eth->TX_Mem[eth->TX_ptr[n] + addr];
                                 break;
                             default:
@@ -1162,6 +1211,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                 dprintf("eth_w5500: socket cmd = 0x%02X\n", eth->Socket[n][Sn_CR]);
                                                 switch (eth->Socket[n][Sn_CR]) {
                                                     case OPEN:
+                                                        eth_w5500_buffers_cfg(eth);
                                                         dsprintf("eth_w5500: Socket %i Open type(%i)\n", n,
                                                                  eth->Socket[n][Sn_MR] & 0x0F);
 
@@ -1199,7 +1249,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                         writeWord(eth->Socket[n], Sn_RX_RD0, 0);
                                                         writeWord(eth->Socket[n], Sn_RX_WR0, 0);
                                                         writeWord(eth->Socket[n], Sn_TX_FSR0,
-                                                                  eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
+                                                                  eth->TX_size[n]);
                                                         writeWord(eth->Socket[n], Sn_RX_RSR0, 0);
                                                         eth->status[n] = 0;
                                                         setnblock(eth->sockfd[n]);
@@ -1352,7 +1402,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                                     dsprintf(".");
                                                                     eth->Socket[n][Sn_IR] |= 0x10;
 
-                                                                    size = (eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
+                                                                    size = eth->TX_size[n];
                                                                     writeWord(eth->Socket[n], Sn_TX_FSR0, (size));
                                                                     writeWord(eth->Socket[n], Sn_TX_WR0, 0);
                                                                     writeWord(eth->Socket[n], Sn_TX_RD0, 0);
@@ -1400,7 +1450,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                                            (const struct sockaddr*)&serv, sizeof(serv));
                                                                 }
 
-                                                                size = (eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
+                                                                size = eth->TX_size[n];
                                                                 writeWord(eth->Socket[n], Sn_TX_FSR0, (size));
                                                                 writeWord(eth->Socket[n], Sn_TX_WR0, 0);
                                                                 writeWord(eth->Socket[n], Sn_TX_RD0, 0);
@@ -1425,9 +1475,13 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                         size = readWord(eth->Socket[n], Sn_RX_WR0);
                                                         size -= readWord(eth->Socket[n], Sn_RX_RD0);
                                                         if (size < 0) {
-                                                            size += eth->RX_size[n];
+                                                            size += 0x10000;  // 16 bits pointers
                                                         }
                                                         writeWord(eth->Socket[n], Sn_RX_RSR0, size);
+                                                        // refill the freed buffer space
+                                                        if (eth->link) {
+                                                            eth_w5500_socket_process(eth, n, 0);
+                                                        }
                                                         break;
                                                 }
                                                 eth->Socket[n][Sn_CR] = 0;
@@ -1451,8 +1505,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                             case B_SCK6TX:
                             case B_SCK7TX:
                                 n = (BSB - B_SCK0TX) / 4;
-                                size = (eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
-                                addr = (eth->addr + offset) % size;
+                                addr = (eth->addr + offset) & eth->TX_mask[n];
                                 // printf ("TX write 0x%04X 0x%04X 0x%04X 0x%04X\n", addr, eth->addr + offset, size,
                                 // readWord (eth->Socket[n], Sn_TX_WR0));
                                 eth->TX_Mem[eth->TX_ptr[n] + addr] = eth->bb_spi.insr & 0x00FF;
@@ -1499,8 +1552,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                             case B_SCK6RX:
                             case B_SCK7RX:
                                 n = (BSB - B_SCK0RX) / 4;
-                                size = (eth->Socket[n][Sn_RXBUF_SIZE] * 1024);
-                                addr = (eth->addr + offset + 1) % size;
+                                addr = (eth->addr + offset + 1) & eth->RX_mask[n];
                                 eth->bb_spi.outsr = eth->RX_Mem[eth->RX_ptr[n] + addr];
                                 break;
                             case B_SCK0TX:
@@ -1512,8 +1564,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                             case B_SCK6TX:
                             case B_SCK7TX:
                                 n = (BSB - B_SCK0TX) / 4;
-                                size = (eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
-                                addr = (eth->addr + offset + 1) & (size - 1);
+                                addr = (eth->addr + offset + 1) & eth->TX_mask[n];
                                 eth->bb_spi.outsr = eth->TX_Mem[eth->TX_ptr[n] + addr];
                                 break;
                             default:
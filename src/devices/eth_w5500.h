@@ -215,6 +215,7 @@ typedef struct {
     unsigned short TX_mask[8];
     unsigned char status[8];
     unsigned short bindp[8];
+    unsigned char poll_cnt[8];
 } eth_w5500_t;
 
 void eth_w5500_rst(eth_w5500_t* eth);
@@ -0,0 +1,249 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "i2c_bus.h"
+
+#include <stdio.h>
+
+#define ACK 0
+#define NACK 1
+
+#define dprintf \
+    if (1) {    \
+    } else      \
+        printf
+
+void i2c_bus_rst(i2c_bus_t* bus) {
+    bus->sel = -1;
+    bus->byte = 0xFF;
+    bus->reading = 0;
+    bus->datab = 0;
+    bus->sdao = 0;
+    bus->sclo = 1;
+    bus->ret = 0;
+    bus->bit = 0xFF;
+    dprintf("i2c_bus rst\n");
+}
+
+void i2c_bus_init(i2c_bus_t* bus) {
+    bus->devc = 0;
+    bus->dup = 0;
+    i2c_bus_rst(bus);
+}
+
+int i2c_bus_attach(i2c_bus_t* bus, bitbang_i2c_t* i2c, i2c_bus_event_t event, void* arg) {
+    for (int i = 0; i < bus->devc; i++) {
+        if (bus->devs[i].i2c == i2c) {
+            bus->devs[i].event = event;
+            bus->devs[i].arg = arg;
+            return i;
+        }
+    }
+
+    if (bus->devc >= I2C_BUS_MAX_DEVS) {
+        printf("i2c_bus: too many devices!\n");
+        return -1;
+    }
+
+    bus->devs[bus->devc].i2c = i2c;
+    bus->devs[bus->devc].event = event;
+    bus->devs[bus->devc].arg = arg;
+    dprintf("i2c_bus attach %02x\n", i2c->addr >> 1);
+    return bus->devc++;
+}
+
+void i2c_bus_detach(i2c_bus_t* bus, bitbang_i2c_t* i2c) {
+    for (int i = 0; i < bus->devc; i++) {
+        if (bus->devs[i].i2c == i2c) {
+            dprintf("i2c_bus detach %02x\n", i2c->addr >> 1);
+            bus->devc--;
+            for (int j = i; j < bus->devc; j++) {
+                bus->devs[j] = bus->devs[j + 1];
+            }
+            if (bus->sel == i) {
+                // the transfer is lost, wait the next start
+                bus->sel = -1;
+                bus->byte = 0xFF;
+                bus->reading = 0;
+                bus->bit = 0xFF;
+            } else if (bus->sel > i) {
+                bus->sel--;
+            }
+            return;
+        }
+    }
+}
+
+static int i2c_bus_match(i2c_bus_t* bus, const unsigned char addr) {
+    int sel = -1;
+
+    for (int i = 0; i < bus->devc; i++) {
+        // read the device address on every start, the parts can change it at any time
+        if ((addr & bus->devs[i].i2c->addr_mask) == bus->devs[i].i2c->addr) {
+            if (sel >= 0) {
+                printf("i2c_bus: address 0x%02X is shared by two devices, only the first one answers!\n", addr >> 1);
+                bus->dup = 1;
+                break;
+            }
+            sel = i;
+            if (bus->dup) {
+                break;
+            }
+        }
+    }
+    return sel;
+}
+
+static void i2c_bus_dispatch(i2c_bus_t* bus, const unsigned char status, const unsigned char data) {
+    i2c_bus_dev_t* dev = &bus->devs[bus->sel];
+
+    dev->i2c->datar = data;
+    dev->i2c->status = status;
+    dev->event(dev->arg);
+}
+
+void i2c_bus_start(i2c_bus_t* bus) {
+    bus->sel = -1;
+    bus->byte = 0;
+    bus->reading = 0;
+    dprintf("---->i2c_bus start\n");
+}
+
+void i2c_bus_stop(i2c_bus_t* bus) {
+    if (bus->sel >= 0) {
+        bus->devs[bus->sel].i2c->data_reading = 0;
+    }
+    bus->sel = -1;
+    bus->byte = 0xFF;
+    bus->reading = 0;
+    dprintf("---> i2c_bus stop\n");
+}
+
+unsigned char i2c_bus_write(i2c_bus_t* bus, const unsigned char data) {
+    if (bus->byte == 0) {  // ADDR
+        bus->sel = i2c_bus_match(bus, data);
+        if (bus->sel < 0) {
+            dprintf("i2c_bus addr NOK %02X\n", data >> 1);
+            bus->byte = 0xFF;
+            return NACK;
+        }
+
+        bitbang_i2c_t* i2c = bus->devs[bus->sel].i2c;
+        bus->byte = 1;
+        bus->reading = data & 0x01;
+        i2c->byte = 1;
+        i2c->data_reading = bus->reading;
+        dprintf("i2c_bus addr OK %02X %s\n", data >> 1, bus->reading ? "READ" : "WRITE");
+        i2c_bus_dispatch(bus, bus->reading ? I2C_DATAR : I2C_ADDR, data);
+        return ACK;
+    }
+
+    if ((bus->sel < 0) || bus->reading) {
+        return NACK;
+    }
+
+    bus->devs[bus->sel].i2c->byte++;
+    i2c_bus_dispatch(bus, I2C_DATAW, data);
+    return ACK;
+}
+
+unsigned char i2c_bus_read(i2c_bus_t* bus) {
+    if ((bus->sel < 0) || !bus->reading) {
+        return 0xFF;
+    }
+
+    bitbang_i2c_t* i2c = bus->devs[bus->sel].i2c;
+    unsigned char data = i2c->datas;
+
+    // the device prepares the next byte, like it does at the ACK of the line level transfer
+    i2c->byte++;
+    i2c_bus_dispatch(bus, I2C_DATAR, data);
+    return data;
+}
+
+unsigned char i2c_bus_io(i2c_bus_t* bus, const unsigned char scl, const unsigned char sda) {
+    if ((bus->sdao == sda) && (bus->sclo == scl)) {
+        // No edge, return the last value
+        return bus->ret;
+    }
+
+    if ((bus->sdao == 1) && (sda == 0) && (scl == 1) && (bus->sclo == 1)) {
+        // start
+        i2c_bus_start(bus);
+        bus->bit = 0;
+        bus->datab = 0;
+        bus->ret = 0;
+    }
+
+    if ((bus->sdao == 0) && (sda == 1) && (scl == 1) && (bus->sclo == 1)) {
+        // stop
+        i2c_bus_stop(bus);
+        bus->bit = 0xFF;
+        bus->ret = 0;
+    }
+
+    if ((bus->bit < 9) && (bus->sclo == 0) && (scl == 1)) {
+        // data in
+        if (bus->bit < 8) {
+            bus->datab |= (sda << (7 - bus->bit));
+        }
+        bus->bit++;
+    }
+
+    if ((bus->bit < 9) && (bus->sclo == 1) && (scl == 0) && bus->reading) {
+        // data out
+        if (bus->bit < 8) {
+            bus->ret = ((bus->devs[bus->sel].i2c->datas & (1 << (7 - bus->bit))) > 0);
+        } else {
+            bus->ret = ACK;
+        }
+    }
+
+    if (bus->bit == 8) {
+        if (bus->byte == 0) {  // ADDR
+            bus->ret = (i2c_bus_match(bus, bus->datab) >= 0) ? ACK : NACK;
+        } else if (!bus->reading) {
+            // data
+            bus->ret = ACK;
+        }
+    }
+
+    if (bus->bit == 9) {
+        if (bus->reading) {
+            i2c_bus_read(bus);
+            bus->bit = 0;
+        } else if (i2c_bus_write(bus, bus->datab) == ACK) {
+            bus->bit = 0;
+        } else {
+            // invalid address
+            bus->bit = 0xFF;
+        }
+        bus->datab = 0;
+    }
+
+    bus->sdao = sda;
+    bus->sclo = scl;
+    return bus->ret;
+}
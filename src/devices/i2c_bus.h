@@ -0,0 +1,81 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef I2C_BUS
+#define I2C_BUS
+
+#include "bitbang_i2c.h"
+
+#define I2C_BUS_MAX_DEVS 16
+
+// byte level callback of a device, the operation is read with bitbang_i2c_get_status
+typedef void (*i2c_bus_event_t)(void* arg);
+
+typedef struct {
+    bitbang_i2c_t* i2c;     // device address and transfer state
+    i2c_bus_event_t event;  // byte level callback
+    void* arg;              // callback argument
+} i2c_bus_dev_t;
+
+/**
+ * @brief I2C bus shared by several devices
+ *
+ * The line is decoded once for all attached devices and each byte is dispatched only to the
+ * addressed one. The master can also drive the bus with whole transactions, without the
+ * SCL/SDA edges.
+ *
+ * Only the first attached device answers an address shared by two devices, a warning is
+ * printed once per bus. On a real bus both would drive SDA.
+ */
+typedef struct {
+    i2c_bus_dev_t devs[I2C_BUS_MAX_DEVS];
+    int devc;               // number of attached devices
+    int sel;                // addressed device or -1
+    unsigned char byte;     // 0 = address, 0xFF = not addressed
+    unsigned char reading;  // reading operation
+    // line decoder
+    unsigned char datab;  // input data shift register
+    unsigned char sclo;   // previous scl
+    unsigned char sdao;   // previous sda
+    unsigned char ret;    // last returned value
+    unsigned char bit;    // bit counter
+    unsigned char dup;    // shared address already reported
+} i2c_bus_t;
+
+void i2c_bus_init(i2c_bus_t* bus);
+void i2c_bus_rst(i2c_bus_t* bus);
+int i2c_bus_attach(i2c_bus_t* bus, bitbang_i2c_t* i2c, i2c_bus_event_t event, void* arg);
+void i2c_bus_detach(i2c_bus_t* bus, bitbang_i2c_t* i2c);
+
+// line level, returns the sda value driven by the devices
+unsigned char i2c_bus_io(i2c_bus_t* bus, const unsigned char scl, const unsigned char sda);
+
+// transaction level, the first byte written after a start is the address. ACK = 0, NACK = 1
+void i2c_bus_start(i2c_bus_t* bus);
+void i2c_bus_stop(i2c_bus_t* bus);
+unsigned char i2c_bus_write(i2c_bus_t* bus, const unsigned char data);
+unsigned char i2c_bus_read(i2c_bus_t* bus);
+
+#endif  // I2C_BUS
@@ -24,6 +24,7 @@
    ######################################################################## */
 
 #include "io_74xx595.h"
+#include "../lib/board.h"
 
 void io_74xx595_rst(io_74xx595_t* sr) {
     sr->asclk = 1;
@@ -64,3 +65,11 @@ unsigned short io_74xx595_io(io_74xx595_t* sr, unsigned char A, unsigned char sc
 
     return (sr->dsr & 0x0100) | sr->out;
 }
+
+int io_74xx595_snapshot_write(io_74xx595_t* sr, FILE* fout) {
+    return snapshot_write(fout, sr, sizeof(io_74xx595_t));
+}
+
+int io_74xx595_snapshot_read(io_74xx595_t* sr, FILE* fin) {
+    return snapshot_read(fin, sr, sizeof(io_74xx595_t));
+}
@@ -26,6 +26,8 @@
 #ifndef IO_74XX595
 #define IO_74XX595
 
+#include <stdio.h>
+
 /*
  pinout
 1  QB
@@ -60,4 +62,7 @@ void io_74xx595_init(io_74xx595_t* sr);
 unsigned short io_74xx595_io(io_74xx595_t* sr, unsigned char A, unsigned char sclk, unsigned char lclk,
                              unsigned char rst);
 
+int io_74xx595_snapshot_write(io_74xx595_t* sr, FILE* fout);
+int io_74xx595_snapshot_read(io_74xx595_t* sr, FILE* fin);
+
 #endif  // IO_74XX595
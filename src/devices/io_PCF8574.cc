@@ -56,8 +56,8 @@ void io_PCF8574_end(io_PCF8574_t* ioe8) {
     dprintf("ioe8 end\n");
 }
 
-unsigned char io_PCF8574_I2C_io(io_PCF8574_t* ioe8, unsigned char scl, unsigned char sda) {
-    unsigned char ret = bitbang_i2c_io(&ioe8->bb_i2c, scl, sda);
+static void io_PCF8574_I2C_event(void* arg) {
+    io_PCF8574_t* ioe8 = (io_PCF8574_t*)arg;
 
     switch (bitbang_i2c_get_status(&ioe8->bb_i2c)) {
         case I2C_DATAW:
@@ -69,6 +69,16 @@ unsigned char io_PCF8574_I2C_io(io_PCF8574_t* ioe8, unsigned char scl, unsigned
             dprintf("ioe8 read =%02X\n", ioe8->dataOut);
             break;
     }
+}
+
+unsigned char io_PCF8574_I2C_io(io_PCF8574_t* ioe8, unsigned char scl, unsigned char sda) {
+    unsigned char ret = bitbang_i2c_io(&ioe8->bb_i2c, scl, sda);
+
+    io_PCF8574_I2C_event(ioe8);
 
     return ret;
 }
+
+void io_PCF8574_I2C_attach(io_PCF8574_t* ioe8, i2c_bus_t* bus) {
+    i2c_bus_attach(bus, &ioe8->bb_i2c, io_PCF8574_I2C_event, ioe8);
+}
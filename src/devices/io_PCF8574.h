@@ -24,6 +24,7 @@
    ######################################################################## */
 
 #include "bitbang_i2c.h"
+#include "i2c_bus.h"
 
 typedef struct {
     bitbang_i2c_t bb_i2c;
@@ -37,3 +38,4 @@ void io_PCF8574_end(io_PCF8574_t* ioe8);
 void io_PCF8574_set_addr(io_PCF8574_t* ioe8, unsigned char addr);
 
 unsigned char io_PCF8574_I2C_io(io_PCF8574_t* ioe8, unsigned char scl, unsigned char sda);
+void io_PCF8574_I2C_attach(io_PCF8574_t* ioe8, i2c_bus_t* bus);
@@ -0,0 +1,66 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "lcd_fb.h"
+
+void lcd_fb_clean(lcd_fb_span_t* spans, const int rows) {
+    for (int i = 0; i < rows; i++) {
+        spans[i].start = LCD_FB_CLEAN;
+    }
+}
+
+void lcd_fb_mark_all(lcd_fb_span_t* spans, const int rows, const int cols) {
+    for (int i = 0; i < rows; i++) {
+        spans[i].start = 0;
+        spans[i].end = cols - 1;
+    }
+}
+
+// draws the dirty span of a row at canvas position (x + col, y), one rectangle per run of equal color
+void lcd_fb_flush_row(const uint32_t* row, lcd_fb_span_t* span, CCanvas* canvas, const int x, const int y) {
+    if (span->start == LCD_FB_CLEAN) {
+        return;
+    }
+
+    int col = span->start;
+    const int end = span->end;
+    span->start = LCD_FB_CLEAN;
+
+    while (col <= end) {
+        const uint32_t color = row[col];
+        int len = 1;
+        while (((col + len) <= end) && (row[col + len] == color)) {
+            len++;
+        }
+
+        canvas->SetColor((color & 0xFF0000) >> 16, (color & 0x00FF00) >> 8, color & 0x0000FF);
+        if (len == 1) {
+            canvas->Point(x + col, y);
+        } else {
+            canvas->Rectangle(1, x + col, y, len, 1);
+        }
+        col += len;
+    }
+}
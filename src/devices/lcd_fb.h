@@ -0,0 +1,73 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef LCD_FB
+#define LCD_FB
+
+#include <lxrad.h>
+#include <stdint.h>
+
+#define LCD_FB_CLEAN 0xFFFF
+
+/**
+ * @brief Dirty span of one framebuffer row
+ *
+ * Columns start..end were written since the last flush. A clean row has
+ * start == LCD_FB_CLEAN.
+ */
+typedef struct {
+    unsigned short start;
+    unsigned short end;
+} lcd_fb_span_t;
+
+/**
+ * @brief Marks column col of a row as dirty
+ */
+static inline void lcd_fb_mark(lcd_fb_span_t* span, const unsigned short col) {
+    if (span->start == LCD_FB_CLEAN) {
+        span->start = col;
+        span->end = col;
+    } else if (col < span->start) {
+        span->start = col;
+    } else if (col > span->end) {
+        span->end = col;
+    }
+}
+
+/**
+ * @brief Writes a packed RGB888 pixel, marking it dirty only if it changed
+ */
+static inline void lcd_fb_set(uint32_t* row, lcd_fb_span_t* span, const unsigned short col, const uint32_t color) {
+    if (row[col] != color) {
+        row[col] = color;
+        lcd_fb_mark(span, col);
+    }
+}
+
+void lcd_fb_clean(lcd_fb_span_t* spans, const int rows);
+void lcd_fb_mark_all(lcd_fb_span_t* spans, const int rows, const int cols);
+void lcd_fb_flush_row(const uint32_t* row, lcd_fb_span_t* span, CCanvas* canvas, const int x, const int y);
+
+#endif  // LCD_FB
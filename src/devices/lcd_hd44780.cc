@@ -296,12 +296,17 @@ void lcd_cmd(lcd_t* lcd, char cmd) {
         }
 
         lcd->update = 1;
+        if (lcd->flags & L_CD)
+            lcd->redraw = 1;
         return;
     }
 
     // Display On/Off control
     if (cmd & 0x08) {
         // Sets On/Off of all display
+        if (!(cmd & 0x04) != !(lcd->flags & L_DON)) {
+            lcd->redraw = 1;
+        }
         if (cmd & 0x04) {
             lcd->flags |= L_DON;
         } else {
@@ -347,6 +352,8 @@ void lcd_cmd(lcd_t* lcd, char cmd) {
 
     // Cursor home
     if (cmd & 0x02) {
+        if (lcd->shift)
+            lcd->redraw = 1;
         lcd->addr_counter = 0;
         lcd->shift = 0;
         lcd->update = 1;
@@ -356,6 +363,9 @@ void lcd_cmd(lcd_t* lcd, char cmd) {
     // Clear display
     if (cmd & 0x01) {
         memset(lcd->ddram_char, ' ', DDRMAX);
+        memset(lcd->dirty, 1, DDRMAX);
+        if (lcd->shift)
+            lcd->redraw = 1;
         lcd->addr_counter = 0;
         lcd->shift = 0;
         lcd->flags |= L_DID;
@@ -397,6 +407,9 @@ void lcd_data(lcd_t* lcd, char data) {
 #endif
     if (lcd->addr_mode == LCD_ADDR_DDRAM) {
         lcd->ddram_char[lcd->addr_counter] = data;
+        lcd->dirty[lcd->addr_counter] = 1;
+        if (lcd->flags & L_DSH)
+            lcd->redraw = 1;
 
         if (lcd->flags & L_DID) {
             lcd->addr_counter++;
@@ -421,6 +434,7 @@ void lcd_data(lcd_t* lcd, char data) {
         lcd->update = 1;
     } else {
         lcd->cgram_char[lcd->addr_counter >> 3] = data;
+        lcd->cgram_dirty |= 0x01 << ((lcd->addr_counter >> 3) & 0x07);
         for (j = 0; j < 5; j++) {
             if ((data & (0x01 << (4 - j))) > 0) {
                 lcd->cgram[lcd->addr_counter >> 3][j] |= (0x01 << (lcd->addr_counter & 0x07));
@@ -525,10 +539,14 @@ void lcd_rst(lcd_t* lcd) {
 
     memset(lcd->ddram_char, ' ', DDRMAX);
     memset(lcd->cgram_char, 0, 64);
+    memset(lcd->dirty, 0, DDRMAX);
+    lcd->cgram_dirty = 0xFF;
+    lcd->cursor_addr = 0xFF;
 
     lcd->addr_counter = 0;
     lcd->addr_mode = LCD_ADDR_DDRAM;
     lcd->update = 1;
+    lcd->redraw = 1;
     lcd->bc = 0;
 
     lcd->blink = 0;
@@ -548,9 +566,40 @@ static void lcd_callback(void* arg) {
     }
 }
 
+// builds the rectangles needed to draw a 5x8 glyph, merging the vertical runs of lit dots of each column
+static void lcd_glyph_build(lcd_glyph_t* glyph, const unsigned char* font) {
+    glyph->count = 0;
+    for (int x = 0; x < 5; x++) {
+        int y = 0;
+        while (y < 8) {
+            if (font[x] & (0x01 << y)) {
+                int start = y;
+                while ((y < 8) && (font[x] & (0x01 << y)))
+                    y++;
+                glyph->run[glyph->count][0] = x;
+                glyph->run[glyph->count][1] = start;
+                glyph->run[glyph->count][2] = y - start;
+                glyph->count++;
+            } else {
+                y++;
+            }
+        }
+    }
+}
+
+static lcd_glyph_t font_glyph[224];
+static int font_glyph_ok = 0;
+
 void lcd_init(lcd_t* lcd, unsigned char cnum, unsigned char lnum, board* pboard_) {
     lcd->pboard = pboard_;
 
+    if (!font_glyph_ok) {
+        for (int i = 0; i < 224; i++) {
+            lcd_glyph_build(&font_glyph[i], LCDfont[i]);
+        }
+        font_glyph_ok = 1;
+    }
+
     if ((cnum > 15) && (cnum <= 20))
         lcd->cnum = cnum;
     else
@@ -561,6 +610,7 @@ void lcd_init(lcd_t* lcd, unsigned char cnum, unsigned char lnum, board* pboard_
     else
         lcd->lnum = 2;
     lcd->update = 1;
+    lcd->picpwr = -1;
 
     lcd_rst(lcd);
 
@@ -579,20 +629,50 @@ void lcd_on(lcd_t* lcd, int onoff) {
 }
 
 void lcd_draw(lcd_t* lcd, CCanvas* canvas, int x1, int y1, int w1, int h1, int picpwr) {
-    int l, c, x, y;
+    int l, c, i;
     int loff = 0;
     int w;
+    int cursor = 0xFF;
+    int cells = 0;
+    unsigned char cell_l[DDRMAX];
+    unsigned char cell_c[DDRMAX];
+    const lcd_glyph_t* cell_glyph[DDRMAX];
+
+    if (picpwr != lcd->picpwr) {
+        lcd->picpwr = picpwr;
+        lcd->redraw = 1;
+    }
 
-    if (lcd->cnum == 16)
-        w = w1;
-    else
-        w = (int)(w1 * 1.25);
+    if (lcd->redraw) {
+        if (lcd->cnum == 16)
+            w = w1;
+        else
+            w = (int)(w1 * 1.25);
 
-    if (lcd->lnum == 2)
-        canvas->Rectangle(1, x1, y1, w, h1);
-    else
-        canvas->Rectangle(1, x1, y1, w, (h1 * 2) - 14);
-    lcd->update = 0;
+        if (lcd->lnum == 2)
+            canvas->Rectangle(1, x1, y1, w, h1);
+        else
+            canvas->Rectangle(1, x1, y1, w, (h1 * 2) - 14);
+    }
+
+    // cells under the old and the new cursor position must be redrawn
+    if ((lcd->flags & L_DON) && (lcd->flags & L_CON)) {
+        cursor = lcd->addr_counter;
+    }
+    if ((cursor != lcd->cursor_addr) || (lcd->blink != lcd->cursor_blink)) {
+        if (lcd->cursor_addr < DDRMAX)
+            lcd->dirty[lcd->cursor_addr] = 1;
+        if (cursor < DDRMAX)
+            lcd->dirty[cursor] = 1;
+        lcd->cursor_addr = cursor;
+        lcd->cursor_blink = lcd->blink;
+    }
+
+    for (i = 0; i < 8; i++) {
+        if (lcd->cgram_dirty & (0x01 << i)) {
+            lcd_glyph_build(&lcd->cgram_glyph[i], (const unsigned char*)lcd->cgram[i]);
+        }
+    }
 
     for (l = 0; l < lcd->lnum; l++) {
         switch (l) {
@@ -610,43 +690,63 @@ void lcd_draw(lcd_t* lcd, CCanvas* canvas, int x1, int y1, int w1, int h1, int p
                 break;
         }
         for (c = 0; c < lcd->cnum; c++) {
-            for (x = 0; x < 5; x++) {
-                for (y = 0; y < 8; y++) {
-                    int cs = c - lcd->shift;
-                    if (cs < 0)
-                        cs = 40 + (cs % 40);
-                    if (cs >= 40)
-                        cs = cs % 40;
-                    char ram;
-                    int fp = ((unsigned char)lcd->ddram_char[(cs + loff) % DDRMAX]);
-
-                    if (fp >= 0x20) {
-                        ram = LCDfont[fp - 0x20][x];
-                    } else {
-                        ram = lcd->cgram[fp & 0x07][x];
-                    }
-                    if ((ram & (0x01 << y)) && (lcd->flags & L_DON)) {
-                        canvas->SetFgColor(0, 35, 0);
-                        canvas->SetColor(0, 35, 0);
-                    } else {
-                        canvas->SetFgColor(0, 90 * picpwr + 35, 0);
-                        canvas->SetColor(0, 90 * picpwr + 35, 0);
-                    }
-                    //          canvas.Rectangle (1, output[i].x1+12+(x*4)+(c*22), output[i].y1+8+(y*4)+(l*38), 4,4 );
-                    canvas->Rectangle(1, x1 + 2 + (x * 4) + (c * 23), y1 + 10 + (y * 4) + (l * 35), 4, 4);
-                }
+            int cs = c - lcd->shift;
+            if (cs < 0)
+                cs = 40 + (cs % 40);
+            if (cs >= 40)
+                cs = cs % 40;
+            int addr = (cs + loff) % DDRMAX;
+            int fp = ((unsigned char)lcd->ddram_char[addr]);
+
+            if (!lcd->redraw && !lcd->dirty[addr] && ((fp >= 0x20) || !(lcd->cgram_dirty & (0x01 << (fp & 0x07)))))
+                continue;
+
+            cell_l[cells] = l;
+            cell_c[cells] = c;
+            if (fp >= 0x20) {
+                cell_glyph[cells] = &font_glyph[fp - 0x20];
+            } else {
+                cell_glyph[cells] = &lcd->cgram_glyph[fp & 0x07];
+            }
+            cells++;
+        }
+    }
+
+    lcd->update = 0;
+    lcd->redraw = 0;
+    lcd->cgram_dirty = 0;
+    memset(lcd->dirty, 0, DDRMAX);
+
+    // clear changed cells
+    canvas->SetFgColor(0, 90 * picpwr + 35, 0);
+    canvas->SetColor(0, 90 * picpwr + 35, 0);
+    for (i = 0; i < cells; i++) {
+        canvas->Rectangle(1, x1 + 2 + (cell_c[i] * 23), y1 + 10 + (cell_l[i] * 35), 20, 32);
+    }
+
+    // and draw lit dots
+    if (lcd->flags & L_DON) {
+        canvas->SetFgColor(0, 35, 0);
+        canvas->SetColor(0, 35, 0);
+        for (i = 0; i < cells; i++) {
+            const lcd_glyph_t* glyph = cell_glyph[i];
+            int cx = x1 + 2 + (cell_c[i] * 23);
+            int cy = y1 + 10 + (cell_l[i] * 35);
+            for (int r = 0; r < glyph->count; r++) {
+                canvas->Rectangle(1, cx + (glyph->run[r][0] * 4), cy + (glyph->run[r][1] * 4), 4,
+                                  glyph->run[r][2] * 4);
             }
         }
     }
 
     // cursor
-    if ((lcd->flags & L_DON) && (lcd->flags & L_CON)) {
-        if (lcd->addr_counter < 40) {
+    if (cursor < DDRMAX) {
+        if (cursor < 40) {
             l = 0;
-            c = (lcd->addr_counter + lcd->shift);
+            c = (cursor + lcd->shift);
         } else {
             l = 1;
-            c = lcd->addr_counter - 40 + lcd->shift;
+            c = cursor - 40 + lcd->shift;
         }
 
         if (c < 0)
@@ -666,3 +766,22 @@ void lcd_draw(lcd_t* lcd, CCanvas* canvas, int x1, int y1, int w1, int h1, int p
         }
     }
 }
+
+int lcd_snapshot_write(lcd_t* lcd, FILE* fout) {
+    return snapshot_write(fout, lcd, sizeof(lcd_t));
+}
+
+int lcd_snapshot_read(lcd_t* lcd, FILE* fin) {
+    lcd_t slcd;
+
+    if (snapshot_read(fin, &slcd, sizeof(slcd))) {
+        return -1;
+    }
+
+    slcd.pboard = lcd->pboard;
+    slcd.TimerID = lcd->TimerID;
+    *lcd = slcd;
+    lcd->update = 1;
+    lcd->redraw = 1;
+    return 0;
+}
@@ -63,16 +63,30 @@ BF  	0 = Can accept instruction  	1 = Internal operation in progress
 #define LCD_ADDR_CGRAM 0
 #define LCD_ADDR_DDRAM 1
 
+#define LCD_GLYPH_RUNS 20  // 5 columns with at most 4 vertical runs of dots each
+
+typedef struct {
+    unsigned char count;
+    unsigned char run[LCD_GLYPH_RUNS][3];  // column, first row, number of rows
+} lcd_glyph_t;
+
 typedef struct {
     unsigned short int flags;
     unsigned char addr_counter;
     unsigned char addr_mode;
     unsigned char update;     // redraw
+    unsigned char redraw;     // full redraw, background must be repainted
     unsigned char blink;      // cursor state
     char shift;               // display shift
     char ddram_char[DDRMAX];  // ddram
     char cgram[8][5];         // cgram font mapped
     char cgram_char[64];      // cgram
+    unsigned char dirty[DDRMAX];  // ddram cells changed since last draw
+    unsigned char cgram_dirty;    // cgram glyphs changed since last draw (bit mask)
+    unsigned char cursor_addr;    // cursor drawn on last draw, 0xFF if none
+    unsigned char cursor_blink;
+    int picpwr;
+    lcd_glyph_t cgram_glyph[8];  // pre-rendered cgram glyphs
     char bc;
     char buff;
     unsigned char cnum;  // number of columns 16 or 20
@@ -91,4 +105,7 @@ void lcd_end(lcd_t* lcd);
 void lcd_on(lcd_t* lcd, int onoff);
 void lcd_draw(lcd_t* lcd, CCanvas* canvas, int x1, int y1, int w1, int h1, int picpwr);
 
+int lcd_snapshot_write(lcd_t* lcd, FILE* fout);
+int lcd_snapshot_read(lcd_t* lcd, FILE* fin);
+
 #endif
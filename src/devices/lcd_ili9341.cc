@@ -32,13 +32,12 @@
     } else      \
         printf
 
+#include <string.h>
 #include "lcd_ili9341.h"
 
 void lcd_ili9341_rst(lcd_ili9341_t* lcd) {
-    int i, j;
-    for (i = 0; i < 240; i++)
-        for (j = 0; j < 320; j++)
-            lcd->ram[i][j] = 0xFF000000;
+    memset(lcd->ram, 0, sizeof(lcd->ram));
+    lcd_fb_mark_all(lcd->dirty, 240, 320);
 
     bitbang_spi_rst(&lcd->bb_spi);
     lcd->pwr = -1;
@@ -69,11 +68,8 @@ void lcd_ili9341_init(lcd_ili9341_t* lcd) {
 }
 
 void lcd_ili9341_update(lcd_ili9341_t* lcd) {
-    int i, j;
     lcd->update = 1;
-    for (i = 0; i < 240; i++)
-        for (j = 0; j < 320; j++)
-            lcd->ram[i][j] |= 0xFF000000;
+    lcd_fb_mark_all(lcd->dirty, 240, 320);
 }
 
 static void lcd_ili9341_readdata(lcd_ili9341_t* lcd) {
@@ -91,7 +87,7 @@ static void lcd_ili9341_readdata(lcd_ili9341_t* lcd) {
 
             dcprint("data[%i][%i]:%#08lX  \n", lcd->x, lcd->y, lcd->color);
 
-            lcd->ram[lcd->x % 240][lcd->y % 320] = lcd->color;
+            lcd_fb_set(lcd->ram[lcd->x % 240], &lcd->dirty[lcd->x % 240], lcd->y % 320, lcd->color & 0x00FFFFFF);
             lcd->update = 1;
 
             lcd->x++;
@@ -133,7 +129,7 @@ static void lcd_ili9341_readdata(lcd_ili9341_t* lcd) {
                     lx = 239 - lx;
                 }
 
-                lcd->ram[lx][ly] = lcd->color;
+                lcd_fb_set(lcd->ram[lx], &lcd->dirty[lx], ly, lcd->color & 0x00FFFFFF);
             }
             lcd->update = 1;
 
@@ -594,38 +590,13 @@ unsigned short lcd_ili9341_8_io(lcd_ili9341_t* lcd, const unsigned char** pins_v
 
 void lcd_ili9341_draw(lcd_ili9341_t* lcd, CCanvas* canvas, const int x1, const int y1, const int w1, const int h1,
                       const int picpwr) {
-    unsigned short x, y;
-    unsigned char r, g, b;
-
     lcd->update = 0;
 
     if (!lcd->on)
         return;
 
-    for (x = 0; x < 240; x++) {
-        for (y = 0; y < 320; y++) {
-            if (lcd->ram[x][y] & 0xFF000000) {
-                lcd->ram[x][y] &= 0x00FFFFFF;  // clear draw
-
-                r = (lcd->ram[x][y] & 0xFF0000) >> 16;
-                g = (lcd->ram[x][y] & 0x00FF00) >> 8;
-                b = (lcd->ram[x][y] & 0x0000FF);
-
-                /*
-                r = (lcd->ram[x][y] & 0x00F800) >> 8;
-                g = (lcd->ram[x][y] & 0x0007E0) >> 3;
-                b = (lcd->ram[x][y] & 0x00001F) << 3;
-                r = ((lcd->ram[x][y] & 0x00F800) >> 11)*8.23;
-                g = ((lcd->ram[x][y] & 0x0007E0) >> 5)*4.05;
-                b = (lcd->ram[x][y] & 0x00001F)*8.23;
-                 */
-
-                canvas->SetColor(r, g, b);
-
-                // canvas->Rectangle (1, x1 + (x * 2), y1 + (y * 8 * 2)+(z * 2), 2, 2);
-
-                canvas->Point(x1 + y, y1 + (239 - x));
-            }
-        }
+    // ram row x is the display line 239 - x
+    for (int x = 0; x < 240; x++) {
+        lcd_fb_flush_row(lcd->ram[x], &lcd->dirty[x], canvas, x1, y1 + (239 - x));
     }
 }
@@ -28,6 +28,7 @@
 
 #include <lxrad.h>
 #include "bitbang_spi.h"
+#include "lcd_fb.h"
 
 /* pinout
   1 /RST
@@ -41,7 +42,8 @@
 */
 
 typedef struct {
-    unsigned long int ram[240][320];
+    uint32_t ram[240][320];      // packed RGB888
+    lcd_fb_span_t dirty[240];  // dirty columns of each ram row
     unsigned char pwr;  // previous wr
     unsigned char prd;  // previous rw
     bitbang_spi_t bb_spi;
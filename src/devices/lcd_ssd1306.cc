@@ -355,8 +355,8 @@ unsigned char lcd_ssd1306_SPI_io(lcd_ssd1306_t* lcd, unsigned char din, unsigned
     return 1;
 }
 
-unsigned char lcd_ssd1306_I2C_io(lcd_ssd1306_t* lcd, unsigned char sda, unsigned char scl) {
-    unsigned char ret = bitbang_i2c_io(&lcd->bb_i2c, scl, sda);
+static void lcd_ssd1306_I2C_event(void* arg) {
+    lcd_ssd1306_t* lcd = (lcd_ssd1306_t*)arg;
 
     switch (bitbang_i2c_get_status(&lcd->bb_i2c)) {
         case I2C_DATAW:
@@ -375,10 +375,20 @@ unsigned char lcd_ssd1306_I2C_io(lcd_ssd1306_t* lcd, unsigned char sda, unsigned
             }
             break;
     }
+}
+
+unsigned char lcd_ssd1306_I2C_io(lcd_ssd1306_t* lcd, unsigned char sda, unsigned char scl) {
+    unsigned char ret = bitbang_i2c_io(&lcd->bb_i2c, scl, sda);
+
+    lcd_ssd1306_I2C_event(lcd);
 
     return ret;
 }
 
+void lcd_ssd1306_I2C_attach(lcd_ssd1306_t* lcd, i2c_bus_t* bus) {
+    i2c_bus_attach(bus, &lcd->bb_i2c, lcd_ssd1306_I2C_event, lcd);
+}
+
 void lcd_ssd1306_draw(lcd_ssd1306_t* lcd, CCanvas* canvas, int x1, int y1, int w1, int h1, int picpwr) {
     unsigned char x, y, z;
 
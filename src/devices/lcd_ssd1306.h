@@ -28,6 +28,7 @@
 
 #include <lxrad.h>
 #include "bitbang_i2c.h"
+#include "i2c_bus.h"
 #include "bitbang_spi.h"
 
 /* pinout
@@ -72,6 +73,7 @@ void lcd_ssd1306_update(lcd_ssd1306_t* lcd);
 unsigned char lcd_ssd1306_SPI_io(lcd_ssd1306_t* lcd, unsigned char din, unsigned char clk, unsigned char ncs,
                                  unsigned char nrst, unsigned char dc);
 unsigned char lcd_ssd1306_I2C_io(lcd_ssd1306_t* lcd, unsigned char sda, unsigned char scl);
+void lcd_ssd1306_I2C_attach(lcd_ssd1306_t* lcd, i2c_bus_t* bus);
 
 void lcd_ssd1306_draw(lcd_ssd1306_t* lcd, CCanvas* canvas, int x1, int y1, int w1, int h1, int picpwr);
 
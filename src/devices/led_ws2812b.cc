@@ -37,7 +37,7 @@ void led_ws2812b_rst(led_ws2812b_t* led) {
     led->update = 1;
     led->dat = 0;
     led->adin = 0;
-    led->ccounter = 0;
+    led->ltime = 0;
     led->bit = 0;
 }
 
@@ -65,10 +65,11 @@ void led_ws2812b_prepare(led_ws2812b_t* led, float freq) {
     led->TRES = freq * 50e-6;
 }
 
-unsigned char led_ws2812b_io(led_ws2812b_t* led, const unsigned char din) {
-    led->ccounter++;
+// called on DIN changes, time is the InstCounter value of the call
+unsigned char led_ws2812b_io(led_ws2812b_t* led, const unsigned char din, const uint32_t time) {
+    const uint32_t elapsed = time - led->ltime;
 
-    if (led->ccounter > led->TRES) {
+    if (elapsed > (uint32_t)led->TRES) {
         led->bit = 0;
         led->dat = 0;
         led->ledc = 0;
@@ -77,16 +78,16 @@ unsigned char led_ws2812b_io(led_ws2812b_t* led, const unsigned char din) {
     if (led->bit < led->nbits) {
         if ((!led->adin) && (din))  // DIN rising edge
         {
-            led->ccounter = 0;
+            led->ltime = time;
         }
         if ((led->adin) && (!din))  // DIN falling edge
         {
             led->dat = led->dat << 1;
-            if (led->ccounter > led->T0H) {
+            if (elapsed > (uint32_t)led->T0H) {
                 led->dat |= 1;
             }
             led->bit++;
-            led->ccounter = 0;
+            led->ltime = time;
         }
 
         led->adin = din;
@@ -102,7 +103,8 @@ unsigned char led_ws2812b_io(led_ws2812b_t* led, const unsigned char din) {
 
     if ((led->adin) != (din))  // DIN rising/falling edge
     {
-        led->ccounter = 0;
+        led->ltime = time;
+        led->adin = din;
     }
     // bit > 24 * nleds
     return din;
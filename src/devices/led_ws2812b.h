@@ -27,6 +27,7 @@
 #define LED_WS2812B
 
 #include <lxrad.h>
+#include <stdint.h>
 
 /* pinout
   1 VDD
@@ -53,7 +54,7 @@ typedef struct {
 typedef struct {
     int T0H;
     int TRES;
-    int ccounter;      // cycle counter
+    uint32_t ltime;    // InstCounter of last DIN edge
     unsigned int bit;  // bit counter
     unsigned int nrows;
     unsigned int ncols;
@@ -72,7 +73,7 @@ void led_ws2812b_init(led_ws2812b_t* led, const int rows, const int cols, const
 void led_ws2812b_end(led_ws2812b_t* led);
 void led_ws2812b_prepare(led_ws2812b_t* led, const float freq);
 
-unsigned char led_ws2812b_io(led_ws2812b_t* led, const unsigned char din);
+unsigned char led_ws2812b_io(led_ws2812b_t* led, const unsigned char din, const uint32_t time);
 
 void led_ws2812b_draw(led_ws2812b_t* led, CCanvas* canvas, const int x1, const int y1, const int w1, const int h1,
                       const int picpwr);
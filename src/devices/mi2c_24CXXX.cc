@@ -24,6 +24,7 @@
    ######################################################################## */
 
 #include "mi2c_24CXXX.h"
+#include "../lib/board.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -80,8 +81,8 @@ void mi2c_end(mi2c_t* mem) {
     mem->data = NULL;
 }
 
-unsigned char mi2c_io(mi2c_t* mem, unsigned char scl, unsigned char sda) {
-    unsigned char ret = bitbang_i2c_io(&mem->bb_i2c, scl, sda);
+static void mi2c_event(void* arg) {
+    mi2c_t* mem = (mi2c_t*)arg;
 
     switch (bitbang_i2c_get_status(&mem->bb_i2c)) {
         case I2C_ADDR:
@@ -129,6 +130,43 @@ unsigned char mi2c_io(mi2c_t* mem, unsigned char scl, unsigned char sda) {
             }
             break;
     }
+}
+
+unsigned char mi2c_io(mi2c_t* mem, unsigned char scl, unsigned char sda) {
+    unsigned char ret = bitbang_i2c_io(&mem->bb_i2c, scl, sda);
+
+    mi2c_event(mem);
 
     return ret;
 }
+
+void mi2c_attach(mi2c_t* mem, i2c_bus_t* bus) {
+    i2c_bus_attach(bus, &mem->bb_i2c, mi2c_event, mem);
+}
+
+int mi2c_snapshot_write(mi2c_t* mem, FILE* fout) {
+    int ret = snapshot_write(fout, &mem->bb_i2c, sizeof(mem->bb_i2c));
+    ret |= snapshot_write(fout, &mem->addr, sizeof(mem->addr));
+    ret |= snapshot_write(fout, mem->data, mem->SIZE);
+    return ret;
+}
+
+int mi2c_snapshot_read(mi2c_t* mem, FILE* fin) {
+    bitbang_i2c_t bb_i2c;
+    unsigned short addr;
+    unsigned char* data = (unsigned char*)malloc(mem->SIZE);
+
+    if (!data || snapshot_read(fin, &bb_i2c, sizeof(bb_i2c)) || snapshot_read(fin, &addr, sizeof(addr)) ||
+        (addr >= mem->SIZE) || snapshot_read(fin, data, mem->SIZE)) {
+        free(data);
+        return -1;
+    }
+
+    bb_i2c.pboard = mem->bb_i2c.pboard;
+    bb_i2c.TimerID = mem->bb_i2c.TimerID;
+    mem->bb_i2c = bb_i2c;
+    mem->addr = addr;
+    memcpy(mem->data, data, mem->SIZE);
+    free(data);
+    return 0;
+}
@@ -23,7 +23,9 @@
    For e-mail suggestions :  lcgamboa@yahoo.com
    ######################################################################## */
 
+#include <stdio.h>
 #include "bitbang_i2c.h"
+#include "i2c_bus.h"
 
 typedef struct {
     bitbang_i2c_t bb_i2c;
@@ -43,3 +45,7 @@ void mi2c_end(mi2c_t* mem);
 void mi2c_set_addr(mi2c_t* mem, unsigned char addr);
 
 unsigned char mi2c_io(mi2c_t* mem, unsigned char scl, unsigned char sda);
+void mi2c_attach(mi2c_t* mem, i2c_bus_t* bus);
+
+int mi2c_snapshot_write(mi2c_t* mem, FILE* fout);
+int mi2c_snapshot_read(mi2c_t* mem, FILE* fin);
@@ -120,6 +120,68 @@ static unsigned char* ramreceived = NULL;
 void setnblock(int sock_descriptor);
 void setblock(int sock_descriptor);
 
+enum { BKCODE = 1, BKWDATA, BKRDATA };
+
+// code
+static int bpc = 0;
+static unsigned int bp[100];
+// data write
+static int bpdwc = 0;
+static unsigned int bpdw[100];
+// data read
+static int bpdrc = 0;
+static unsigned int bpdr[100];
+
+// breakpoint address bitmaps, one bit per address
+typedef struct {
+    unsigned char* bits;
+    unsigned int size;  // in addresses
+} bp_map_t;
+
+static bp_map_t bpmap[3];  // indexed by BKCODE - 1, BKWDATA - 1, BKRDATA - 1
+static int bpany = 0;      // any breakpoint set
+
+static inline int bp_map_test(const bp_map_t* map, const unsigned int addr) {
+    return (addr < map->size) && (map->bits[addr >> 3] & (1 << (addr & 7)));
+}
+
+static void bp_map_alloc(const int type, const unsigned int size) {
+    bp_map_t* map = &bpmap[type - 1];
+
+    map->bits = (unsigned char*)calloc((size + 7) >> 3, 1);
+    map->size = map->bits ? size : 0;
+}
+
+// rebuild the bitmap of one breakpoint type, the bitmap is updated in place because the simulation thread reads it
+static void bp_map_build(const int type, const unsigned int* addrs, const int count) {
+    bp_map_t* map = &bpmap[type - 1];
+
+    if (map->bits) {
+        memset(map->bits, 0, (map->size + 7) >> 3);
+        for (int i = 0; i < count; i++) {
+            if (addrs[i] < map->size) {
+                map->bits[addrs[i] >> 3] |= 1 << (addrs[i] & 7);
+            } else {
+                dprint("breakpoint 0x%04X out of range!\n", addrs[i]);
+            }
+        }
+    }
+
+    bpany = (bpc > 0) || (bpdwc > 0) || (bpdrc > 0);
+}
+
+static void bp_map_free(void) {
+    bpany = 0;
+    bpc = 0;
+    bpdwc = 0;
+    bpdrc = 0;
+    for (int i = 0; i < 3; i++) {
+        free(bpmap[i].bits);
+        bpmap[i].bits = NULL;
+        bpmap[i].size = 0;
+    }
+}
+
 int mplabxd_init(board* mboard, unsigned short tcpport) {
     struct sockaddr_in serv;
 
@@ -160,6 +222,9 @@ int mplabxd_init(board* mboard, unsigned short tcpport) {
     if (!ramsend) {
         ramsend = (unsigned char*)malloc(dbg_board->DBGGetRAMSize());
         ramreceived = (unsigned char*)malloc(dbg_board->DBGGetRAMSize());
+        bp_map_alloc(BKCODE, dbg_board->DBGGetROMSize());
+        bp_map_alloc(BKWDATA, dbg_board->DBGGetRAMSize());
+        bp_map_alloc(BKRDATA, dbg_board->DBGGetRAMSize());
     }
     return 0;
 }
@@ -193,6 +258,7 @@ void mplabxd_stop(void) {
 
 void mplabxd_end(void) {
     mplabxd_stop();
+    bp_map_free();
     if (ramsend) {
         free(ramsend);
         free(ramreceived);
@@ -212,49 +278,38 @@ void mplabxd_server_end(void) {
     server_started = 0;
 }
 
-enum { BKCODE = 1, BKWDATA, BKRDATA };
+static unsigned short dbuff[2];
 
-// code
-static int bpc = 0;
-static unsigned int bp[100];
-// data write
-static int bpdwc = 0;
-static unsigned int bpdw[100];
-// data read
-static int bpdrc = 0;
-static unsigned int bpdr[100];
+static int bp_hit(const char* type, const unsigned int addr) {
+    dprint("breakpoint %s0x%04X!!!!!=========================\n", type, addr);
+    PICSimLab.SetCpuState(CPU_BREAKPOINT);
+    PICSimLab.Set_mcudbg(1);
+    return PICSimLab.GetMcuDbg();
+}
 
-static unsigned short dbuff[2];
+int mplabxd_testbp_needed(void) {
+    // breakpoints and the debug halt state only change in mplabxd_loop or in a breakpoint hit
+    return bpany;
+}
 
 int mplabxd_testbp(void) {
-    int i;
-    if (!PICSimLab.GetMcuDbg()) {
-        for (i = 0; i < bpc; i++) {
-            if (dbg_board->DBGGetPC() == bp[i]) {
-                dprint("breakpoint 0x%04X!!!!!=========================\n", bp[i]);
-                PICSimLab.SetCpuState(CPU_BREAKPOINT);
-                PICSimLab.Set_mcudbg(1);
-                return PICSimLab.GetMcuDbg();
-            }
-        }
-        for (i = 0; i < bpdwc; i++) {
-            if (dbg_board->DBGGetRAMLAWR() == bpdw[i]) {
-                dprint("breakpoint data wr 0x%04X!!!!!=========================\n", bpdw[i]);
-                PICSimLab.SetCpuState(CPU_BREAKPOINT);
-                PICSimLab.Set_mcudbg(1);
-                return PICSimLab.GetMcuDbg();
-            }
-        }
-        for (i = 0; i < bpdrc; i++) {
-            if (dbg_board->DBGGetRAMLARD() == bpdr[i]) {
-                dprint("breakpoint data rd 0x%04X!!!!!=========================\n", bpdr[i]);
-                PICSimLab.SetCpuState(CPU_BREAKPOINT);
-                PICSimLab.Set_mcudbg(1);
-                return PICSimLab.GetMcuDbg();
-            }
-        }
+    unsigned int addr;
+
+    // fast path, called for every instruction
+    if (!bpany || PICSimLab.GetMcuDbg()) {
+        return PICSimLab.GetMcuDbg();
     }
-    return PICSimLab.GetMcuDbg();
+
+    if (bpc && bp_map_test(&bpmap[BKCODE - 1], (addr = dbg_board->DBGGetPC()))) {
+        return bp_hit("", addr);
+    }
+    if (bpdwc && bp_map_test(&bpmap[BKWDATA - 1], (addr = dbg_board->DBGGetRAMLAWR()))) {
+        return bp_hit("data wr ", addr);
+    }
+    if (bpdrc && bp_map_test(&bpmap[BKRDATA - 1], (addr = dbg_board->DBGGetRAMLARD()))) {
+        return bp_hit("data rd ", addr);
+    }
+    return 0;
 }
 
 int mplabxd_loop(void) {
@@ -299,6 +354,7 @@ int mplabxd_loop(void) {
                 bpc = 0;
                 bpdwc = 0;
                 bpdrc = 0;
+                bpany = 0;
                 break;
             case STEP:
                 dprint("STEP cmd\n");
@@ -362,6 +418,7 @@ int mplabxd_loop(void) {
                         printf("bp %i = %#06X\n", i, bp[i]);
 #endif
                 }
+                bp_map_build(BKCODE, bp, bpc);
                 dprint("SETBK cmd\n");
                 break;
             case STRUN:
@@ -393,6 +450,7 @@ int mplabxd_loop(void) {
                         printf("bpdw %i = %#06X\n", i, bpdw[i]);
 #endif
                 }
+                bp_map_build(BKWDATA, bpdw, bpdwc);
                 dprint("SDWBK cmd\n");
                 break;
             case SDRBK:
@@ -415,6 +473,7 @@ int mplabxd_loop(void) {
                         printf("bpdr %i = %#06X\n", i, bpdr[i]);
 #endif
                 }
+                bp_map_build(BKRDATA, bpdr, bpdrc);
                 dprint("SDRBK cmd\n");
                 break;
             case GETID:
@@ -33,6 +33,8 @@ int mplabxd_init(board* mboard, unsigned short tcpport);
 int mplabxd_loop(void);
 void mplabxd_end(void);
 int mplabxd_testbp(void);
+// 1 if mplabxd_testbp must be called on each step, 0 if it returns GetMcuDbg() until the next mplabxd_loop
+int mplabxd_testbp_needed(void);
 void mplabxd_server_end(void);
 
 #endif /* MPLABXD_H */
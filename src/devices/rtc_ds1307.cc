@@ -236,8 +236,8 @@ void rtc_ds1307_end(rtc_ds1307_t* rtc) {
     rtc->pboard->TimerUnregister(rtc->TimerID);
 }
 
-unsigned char rtc_ds1307_I2C_io(rtc_ds1307_t* rtc, unsigned char scl, unsigned char sda) {
-    unsigned char ret = bitbang_i2c_io(&rtc->bb_i2c, scl, sda);
+static void rtc_ds1307_I2C_event(void* arg) {
+    rtc_ds1307_t* rtc = (rtc_ds1307_t*)arg;
 
     switch (bitbang_i2c_get_status(&rtc->bb_i2c)) {
         case I2C_DATAW:
@@ -293,8 +293,36 @@ unsigned char rtc_ds1307_I2C_io(rtc_ds1307_t* rtc, unsigned char scl, unsigned c
             }
             break;
     }
+}
+
+unsigned char rtc_ds1307_I2C_io(rtc_ds1307_t* rtc, unsigned char scl, unsigned char sda) {
+    unsigned char ret = bitbang_i2c_io(&rtc->bb_i2c, scl, sda);
+
+    rtc_ds1307_I2C_event(rtc);
 
     return ret;
 }
 
-// TODO int output
\ No newline at end of file
+void rtc_ds1307_I2C_attach(rtc_ds1307_t* rtc, i2c_bus_t* bus) {
+    i2c_bus_attach(bus, &rtc->bb_i2c, rtc_ds1307_I2C_event, rtc);
+}
+
+// TODO int output
+int rtc_ds1307_snapshot_write(rtc_ds1307_t* rtc, FILE* fout) {
+    return snapshot_write(fout, rtc, sizeof(rtc_ds1307_t));
+}
+
+int rtc_ds1307_snapshot_read(rtc_ds1307_t* rtc, FILE* fin) {
+    rtc_ds1307_t srtc;
+
+    if (snapshot_read(fin, &srtc, sizeof(srtc)) || (srtc.addr >= sizeof(srtc.data))) {
+        return -1;
+    }
+
+    srtc.bb_i2c.pboard = rtc->bb_i2c.pboard;
+    srtc.bb_i2c.TimerID = rtc->bb_i2c.TimerID;
+    srtc.pboard = rtc->pboard;
+    srtc.TimerID = rtc->TimerID;
+    *rtc = srtc;
+    return 0;
+}
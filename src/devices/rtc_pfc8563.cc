@@ -215,8 +215,8 @@ void rtc_pfc8563_end(rtc_pfc8563_t* rtc) {
     rtc->pboard->TimerUnregister(rtc->TimerID);
 }
 
-unsigned char rtc_pfc8563_I2C_io(rtc_pfc8563_t* rtc, unsigned char scl, unsigned char sda) {
-    unsigned char ret = bitbang_i2c_io(&rtc->bb_i2c, scl, sda);
+static void rtc_pfc8563_I2C_event(void* arg) {
+    rtc_pfc8563_t* rtc = (rtc_pfc8563_t*)arg;
 
     switch (bitbang_i2c_get_status(&rtc->bb_i2c)) {
         case I2C_DATAW:
@@ -275,8 +275,37 @@ unsigned char rtc_pfc8563_I2C_io(rtc_pfc8563_t* rtc, unsigned char scl, unsigned
             }
             break;
     }
+}
+
+unsigned char rtc_pfc8563_I2C_io(rtc_pfc8563_t* rtc, unsigned char scl, unsigned char sda) {
+    unsigned char ret = bitbang_i2c_io(&rtc->bb_i2c, scl, sda);
+
+    rtc_pfc8563_I2C_event(rtc);
 
     return ret;
 }
 
+void rtc_pfc8563_I2C_attach(rtc_pfc8563_t* rtc, i2c_bus_t* bus) {
+    i2c_bus_attach(bus, &rtc->bb_i2c, rtc_pfc8563_I2C_event, rtc);
+}
+
 // TODO int output and countdown timer
+
+int rtc_pfc8563_snapshot_write(rtc_pfc8563_t* rtc, FILE* fout) {
+    return snapshot_write(fout, rtc, sizeof(rtc_pfc8563_t));
+}
+
+int rtc_pfc8563_snapshot_read(rtc_pfc8563_t* rtc, FILE* fin) {
+    rtc_pfc8563_t srtc;
+
+    if (snapshot_read(fin, &srtc, sizeof(srtc)) || (srtc.addr >= sizeof(srtc.data))) {
+        return -1;
+    }
+
+    srtc.bb_i2c.pboard = rtc->bb_i2c.pboard;
+    srtc.bb_i2c.TimerID = rtc->bb_i2c.TimerID;
+    srtc.pboard = rtc->pboard;
+    srtc.TimerID = rtc->TimerID;
+    *rtc = srtc;
+    return 0;
+}
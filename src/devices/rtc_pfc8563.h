@@ -23,8 +23,10 @@
    For e-mail suggestions :  lcgamboa@yahoo.com
    ######################################################################## */
 
+#include <stdio.h>
 #include <time.h>
 #include "bitbang_i2c.h"
+#include "i2c_bus.h"
 
 typedef struct {
     bitbang_i2c_t bb_i2c;
@@ -48,3 +50,7 @@ void rtc_pfc8563_setUtime(rtc_pfc8563_t* rtc, time_t utime);
 time_t rtc_pfc8563_getUtime(rtc_pfc8563_t* rtc);
 
 unsigned char rtc_pfc8563_I2C_io(rtc_pfc8563_t* rtc, unsigned char scl, unsigned char sda);
+void rtc_pfc8563_I2C_attach(rtc_pfc8563_t* rtc, i2c_bus_t* bus);
+
+int rtc_pfc8563_snapshot_write(rtc_pfc8563_t* rtc, FILE* fout);
+int rtc_pfc8563_snapshot_read(rtc_pfc8563_t* rtc, FILE* fin);
@@ -26,9 +26,15 @@
 #include "sdcard.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#ifdef _WIN_
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
 
 #define dprintf \
     if (1) {    \
@@ -85,20 +91,69 @@ void sdcard_init(sdcard_t* sd) {
     sd->card_present = 0;
     bitbang_spi_init(&sd->bb_spi);
     sdcard_rst(sd);
-    sd->fd = NULL;
+    sd->map = NULL;
+    sd->map_size = 0;
+    sd->map_cow = 0;
+#ifdef _WIN_
+    sd->map_fh = INVALID_HANDLE_VALUE;
+    sd->map_mh = NULL;
+#else
+    sd->map_fd = -1;
+#endif
+    sd->rd_ptr = NULL;
+    sd->wr_addr = 0;
     sd->disk_size = 0;
     dprintf("init sdcard\n");
 }
 
-void sdcard_end(sdcard_t* sd) {
-    if (sd->fd) {
-        fclose(sd->fd);
-        sd->fd = NULL;
+// write back the changed blocks of the image
+static void sdcard_flush(sdcard_t* sd) {
+    if (sd->map && !sd->map_cow) {
+#ifdef _WIN_
+        FlushViewOfFile(sd->map, 0);
+#else
+        msync(sd->map, sd->map_size, MS_SYNC);
+#endif
     }
 }
 
+static void sdcard_unmap(sdcard_t* sd) {
+    sdcard_flush(sd);
+#ifdef _WIN_
+    if (sd->map) {
+        UnmapViewOfFile(sd->map);
+    }
+    if (sd->map_mh) {
+        CloseHandle(sd->map_mh);
+    }
+    if (sd->map_fh != INVALID_HANDLE_VALUE) {
+        CloseHandle(sd->map_fh);
+    }
+    sd->map_fh = INVALID_HANDLE_VALUE;
+    sd->map_mh = NULL;
+#else
+    if (sd->map) {
+        munmap(sd->map, sd->map_size);
+    }
+    if (sd->map_fd >= 0) {
+        close(sd->map_fd);
+    }
+    sd->map_fd = -1;
+#endif
+    sd->map = NULL;
+    sd->map_size = 0;
+    sd->rd_ptr = NULL;
+}
+
+void sdcard_end(sdcard_t* sd) {
+    sdcard_unmap(sd);
+}
+
 void sdcard_set_card_present(sdcard_t* sd, unsigned char cp) {
-    if (sd->fd) {
+    if (sd->map) {
+        if (sd->card_present && !cp) {
+            sdcard_flush(sd);  // eject
+        }
         sd->card_present = cp;
     } else {
         sd->card_present = 0;
@@ -106,6 +161,15 @@ void sdcard_set_card_present(sdcard_t* sd, unsigned char cp) {
 }
 
 static unsigned char buff[512];
+static const unsigned char blank[512] = {0};
+
+// block read straight from the image
+static const unsigned char* sdcard_block(sdcard_t* sd, const unsigned long addr) {
+    if ((addr + 512) <= sd->map_size) {
+        return sd->map + addr;
+    }
+    return blank;
+}
 
 unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, unsigned char ss) {
     unsigned int offset = 0;
@@ -164,8 +228,11 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                     buff[512 - (sd->data_wc - 2)] = sd->bb_spi.insr & 0xFF;
                     dsprintf("sdcard write buff[%i]= 0x%02X \n", 512 - (sd->data_wc - 2), sd->bb_spi.insr & 0xFF);
                     if ((sd->data_wc - 3) == 0) {
-                        fwrite(buff, 512, 1, sd->fd);
-                        dprintf("sdcard 512 bytes writed end %li \n", ftell(sd->fd) / 512);
+                        if ((sd->wr_addr + 512) <= sd->map_size) {
+                            memcpy(sd->map + sd->wr_addr, buff, 512);
+                        }
+                        sd->wr_addr += 512;
+                        dprintf("sdcard 512 bytes writed end %li \n", sd->wr_addr / 512);
                     }
                 }
 
@@ -417,8 +484,7 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                                     sd->replyc = 3;
                                     sd->data_rc = 512;
 
-                                    fseek(sd->fd, sd->arg /* 512*/, SEEK_SET);
-                                    fread(buff, 512, 1, sd->fd);
+                                    sd->rd_ptr = sdcard_block(sd, sd->arg /* 512*/);
                                     dprintf("sdcard reading block %li\n", sd->arg / 512);
                                     break;
                                 case CMD18:  // READ_MULTIPLE_BLOCK - read a multiple data blocks from the card
@@ -429,8 +495,7 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                                     sd->data_rc = 512;
                                     sd->multi_rd = 1;
 
-                                    fseek(sd->fd, sd->arg /* 512*/, SEEK_SET);
-                                    fread(buff, 512, 1, sd->fd);
+                                    sd->rd_ptr = sdcard_block(sd, sd->arg /* 512*/);
                                     dprintf("sdcard reading multiple blocks start at %li\n", sd->arg / 512);
                                     break;
                                 case CMD24:                   // WRITE_BLOCK - write a single data block to the card
@@ -438,7 +503,7 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                                     sd->reply[0] = sd->R1;
                                     sd->replyc = 2;
                                     sd->data_wc = 515;  // include 0xFE initial token and crc
-                                    fseek(sd->fd, sd->arg /* 512*/, SEEK_SET);
+                                    sd->wr_addr = sd->arg /* 512*/;
                                     dprintf("sdcard writing block %li\n", sd->arg / 512);
                                     break;
                                 case CMD25:  // WRITE_MULTIPLE_BLOCK - write blocks of data until a STOP_TRANSMISSION
@@ -447,7 +512,7 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                                     sd->replyc = 2;
                                     sd->data_wc = 515;  // include 0xFC initial token and crc
                                     sd->multi_wr = 1;
-                                    fseek(sd->fd, sd->arg /* 512*/, SEEK_SET);
+                                    sd->wr_addr = sd->arg /* 512*/;
                                     dprintf("sdcard writing multiple blocks start at %li\n", sd->arg / 512);
                                     break;
                                 case CMD32:  // ERASE_WR_BLK_START - sets the address of the first block to be erased
@@ -470,10 +535,10 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                                     sd->reply[0] = sd->R1;
                                     sd->replyc = 2;
                                     dprintf("sdcard erasing blocks %li to %li\n", sd->ebstart, sd->ebend);
-                                    fseek(sd->fd, sd->ebstart, SEEK_SET);
-                                    memset(buff, 0, 512);
-                                    for (offset = sd->ebstart; offset < sd->ebend; offset++) {
-                                        fwrite(buff, 512, 1, sd->fd);
+                                    for (offset = sd->ebstart; offset <= sd->ebend; offset++) {
+                                        if (((offset + 1) * 512UL) <= sd->map_size) {
+                                            memset(sd->map + offset * 512UL, 0, 512);
+                                        }
                                     }
                                     break;
                                 case CMD55:                   // APP_CMD - escape for application specific command
@@ -536,12 +601,12 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                                 sd->bb_spi.outsr = (sd->bb_spi.outsr & 0xFF00) | sd->reply[offset - 1];
                             } else {
                                 if (sd->data_rc) {
-                                    sd->bb_spi.outsr = (sd->bb_spi.outsr & 0xFF00) | buff[512 - sd->data_rc];
+                                    sd->bb_spi.outsr = (sd->bb_spi.outsr & 0xFF00) | sd->rd_ptr[512 - sd->data_rc];
                                     sd->data_rc--;
                                     if (!sd->data_rc) {
                                         unsigned short crc16 = 0xFFFF;
                                         if (sd->crc_on) {
-                                            crc16 = CRC16(buff, 512);
+                                            crc16 = CRC16(sd->rd_ptr, 512);
                                         }
                                         sd->bb_spi.byte = 6;
                                         sd->reply[0] = crc16 >> 8;
@@ -554,7 +619,7 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                                             sd->replyc = 5;
                                             sd->data_rc = 512;
                                             sd->arg += 512;
-                                            fread(buff, 512, 1, sd->fd);
+                                            sd->rd_ptr = sdcard_block(sd, sd->arg);
                                             dprintf("sdcard reading next block at %li\n", sd->arg / 512);
                                         }
                                     }
@@ -576,25 +641,67 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
     return sd->bb_spi.ret;
 }
 
-void sdcard_set_filename(sdcard_t* sd, const char* fname) {
-    if (sd->fd) {
-        fclose(sd->fd);
+void sdcard_set_filename(sdcard_t* sd, const char* fname, const unsigned char cow) {
+    struct stat sb;
+
+    sdcard_unmap(sd);
+    sd->card_present = 0;
+
+    sb.st_size = 0;
+    if (stat(fname, &sb) || (sb.st_size < 512)) {
+        return;
     }
+    sd->map_size = sb.st_size;
 
-    sd->fd = fopen(fname, "r+");
-    if (sd->fd) {
-        struct stat sb;
+    // with cow (or a read only image) writes are kept in memory only, so many simulations can share the same
+    // golden image
+    sd->map_cow = cow;
+#ifdef _WIN_
+    if (!sd->map_cow) {
+        sd->map_fh = CreateFileA(fname, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    }
+    if (sd->map_fh == INVALID_HANDLE_VALUE) {
+        sd->map_cow = 1;
+        sd->map_fh = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL, NULL);
+    }
+    if (sd->map_fh != INVALID_HANDLE_VALUE) {
+        sd->map_mh = CreateFileMappingA(sd->map_fh, NULL, sd->map_cow ? PAGE_WRITECOPY : PAGE_READWRITE, 0, 0, NULL);
+    }
+    if (sd->map_mh) {
+        sd->map = (unsigned char*)MapViewOfFile(sd->map_mh, sd->map_cow ? FILE_MAP_COPY : FILE_MAP_WRITE, 0, 0, 0);
+    }
+#else
+    if (!sd->map_cow) {
+        sd->map_fd = open(fname, O_RDWR);
+    }
+    if (sd->map_fd < 0) {
+        sd->map_cow = 1;
+        sd->map_fd = open(fname, O_RDONLY);
+    }
+    if (sd->map_fd >= 0) {
+        void* map = mmap(NULL, sd->map_size, PROT_READ | PROT_WRITE, sd->map_cow ? MAP_PRIVATE : MAP_SHARED,
+                         sd->map_fd, 0);
+        if (map != MAP_FAILED) {
+            sd->map = (unsigned char*)map;
+        }
+    }
+#endif
 
-        sb.st_mode = 0;
+    if (!sd->map) {
+        printf("sdcard: can't map image %s : %s \n", fname, strerror(errno));
+        sdcard_unmap(sd);
+        return;
+    }
 
-        stat(fname, &sb);
-        sd->card_present = 1;
+    sd->card_present = 1;
+    sd->rd_ptr = blank;
 
-        sd->disk_size = sb.st_size >> 10;
+    sd->disk_size = sb.st_size >> 10;
 #ifdef _WIN_
-        dprintf("sdcard size=%li kb  ->  %lli blocks\n", sd->disk_size, sb.st_size / 512);
+    dprintf("sdcard size=%li kb  ->  %lli blocks\n", sd->disk_size, sb.st_size / 512);
 #else
-        dprintf("sdcard size=%li kb  ->  %li blocks\n", sd->disk_size, sb.st_size / 512);
+    dprintf("sdcard size=%li kb  ->  %li blocks\n", sd->disk_size, sb.st_size / 512);
 #endif
-    }
 }
@@ -62,7 +62,17 @@
 #define MAX_REPLY 72
 
 typedef struct {
-    FILE* fd;
+    unsigned char* map;         // memory mapped card image
+    unsigned long map_size;     // in bytes
+    unsigned char map_cow;      // read only image, writes are kept in memory only
+#ifdef _WIN_
+    void* map_fh;
+    void* map_mh;
+#else
+    int map_fd;
+#endif
+    const unsigned char* rd_ptr;  // block being read
+    unsigned long wr_addr;        // next block to write
     unsigned char card_present;
     bitbang_spi_t bb_spi;
     unsigned long arg;
@@ -89,7 +99,7 @@ void sdcard_rst(sdcard_t* sd);
 void sdcard_init(sdcard_t* sd);
 void sdcard_end(sdcard_t* sd);
 void sdcard_set_card_present(sdcard_t* sd, unsigned char cp);
-void sdcard_set_filename(sdcard_t* sd, const char* fname);
+void sdcard_set_filename(sdcard_t* sd, const char* fname, const unsigned char cow = 0);
 
 unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, unsigned char ss);
 
@@ -83,8 +83,8 @@ static void adxl345_regwrited(adxl345_t* adxl) {
     }
 }
 
-unsigned char adxl345_io_I2C(adxl345_t* adxl, unsigned char scl, unsigned char sda) {
-    unsigned char ret = bitbang_i2c_io(&adxl->bb_i2c, scl, sda);
+static void adxl345_event_I2C(void* arg) {
+    adxl345_t* adxl = (adxl345_t*)arg;
 
     switch (bitbang_i2c_get_status(&adxl->bb_i2c)) {
         case I2C_ADDR:
@@ -114,10 +114,20 @@ unsigned char adxl345_io_I2C(adxl345_t* adxl, unsigned char scl, unsigned char s
             }
             break;
     }
+}
+
+unsigned char adxl345_io_I2C(adxl345_t* adxl, unsigned char scl, unsigned char sda) {
+    unsigned char ret = bitbang_i2c_io(&adxl->bb_i2c, scl, sda);
+
+    adxl345_event_I2C(adxl);
 
     return ret;
 }
 
+void adxl345_attach_I2C(adxl345_t* adxl, i2c_bus_t* bus) {
+    i2c_bus_attach(bus, &adxl->bb_i2c, adxl345_event_I2C, adxl);
+}
+
 unsigned short adxl345_io_SPI(adxl345_t* adxl, unsigned char mosi, unsigned char clk, unsigned char ss) {
     if (!ss)
         adxl->i2c_mode = 0;
@@ -24,6 +24,7 @@
    ######################################################################## */
 
 #include "bitbang_i2c.h"
+#include "i2c_bus.h"
 #include "bitbang_spi.h"
 
 typedef struct {
@@ -45,6 +46,7 @@ void adxl345_set_accel(adxl345_t* adxl, double x, double y, double z);   // g
 void adxl345_set_accel_raw(adxl345_t* adxl, short x, short y, short z);  // g
 
 unsigned char adxl345_io_I2C(adxl345_t* adxl, unsigned char scl, unsigned char sda);
+void adxl345_attach_I2C(adxl345_t* adxl, i2c_bus_t* bus);
 unsigned short adxl345_io_SPI(adxl345_t* adxl, unsigned char mosi, unsigned char clk, unsigned char ss);
 
 // clang-format off
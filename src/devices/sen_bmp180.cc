@@ -85,8 +85,8 @@ void sen_bmp180_end(sen_bmp180_t* bmp180) {
     dprintf("bmp180 end\n");
 }
 
-unsigned char sen_bmp180_I2C_io(sen_bmp180_t* bmp180, const unsigned char scl, const unsigned char sda) {
-    unsigned char ret = bitbang_i2c_io(&bmp180->bb_i2c, scl, sda);
+static void sen_bmp180_I2C_event(void* arg) {
+    sen_bmp180_t* bmp180 = (sen_bmp180_t*)arg;
     int temp;
 
     switch (bitbang_i2c_get_status(&bmp180->bb_i2c)) {
@@ -152,10 +152,20 @@ unsigned char sen_bmp180_I2C_io(sen_bmp180_t* bmp180, const unsigned char scl, c
             bmp180->addr++;
             break;
     }
+}
+
+unsigned char sen_bmp180_I2C_io(sen_bmp180_t* bmp180, const unsigned char scl, const unsigned char sda) {
+    unsigned char ret = bitbang_i2c_io(&bmp180->bb_i2c, scl, sda);
+
+    sen_bmp180_I2C_event(bmp180);
 
     return ret;
 }
 
+void sen_bmp180_I2C_attach(sen_bmp180_t* bmp180, i2c_bus_t* bus) {
+    i2c_bus_attach(bus, &bmp180->bb_i2c, sen_bmp180_I2C_event, bmp180);
+}
+
 void sen_bmp180_setPressTemp(sen_bmp180_t* bmp180, const float pressureh, const float temp) {
     const float pressure = pressureh * 100.0;  // pressure in Pa
 
@@ -24,6 +24,7 @@
    ######################################################################## */
 
 #include "bitbang_i2c.h"
+#include "i2c_bus.h"
 
 typedef struct {
     bitbang_i2c_t bb_i2c;
@@ -39,3 +40,4 @@ void sen_bmp180_end(sen_bmp180_t* bmp180);
 void sen_bmp180_setPressTemp(sen_bmp180_t* bmp180, const float pressure, const float temp);
 
 unsigned char sen_bmp180_I2C_io(sen_bmp180_t* bmp180, const unsigned char scl, const unsigned char sda);
+void sen_bmp180_I2C_attach(sen_bmp180_t* bmp180, i2c_bus_t* bus);
@@ -143,8 +143,8 @@ static unsigned char bmp280_read(sen_bmp280_t* bmp280) {
     }
 }
 
-unsigned char sen_bmp280_I2C_io(sen_bmp280_t* bmp280, const unsigned char scl, const unsigned char sda) {
-    unsigned char ret = bitbang_i2c_io(&bmp280->bb_i2c, scl, sda);
+static void sen_bmp280_I2C_event(void* arg) {
+    sen_bmp280_t* bmp280 = (sen_bmp280_t*)arg;
 
     switch (bitbang_i2c_get_status(&bmp280->bb_i2c)) {
         case I2C_DATAW:
@@ -173,10 +173,20 @@ unsigned char sen_bmp280_I2C_io(sen_bmp280_t* bmp280, const unsigned char scl, c
             bmp280->addr++;
             break;
     }
+}
+
+unsigned char sen_bmp280_I2C_io(sen_bmp280_t* bmp280, const unsigned char scl, const unsigned char sda) {
+    unsigned char ret = bitbang_i2c_io(&bmp280->bb_i2c, scl, sda);
+
+    sen_bmp280_I2C_event(bmp280);
 
     return ret;
 }
 
+void sen_bmp280_I2C_attach(sen_bmp280_t* bmp280, i2c_bus_t* bus) {
+    i2c_bus_attach(bus, &bmp280->bb_i2c, sen_bmp280_I2C_event, bmp280);
+}
+
 unsigned short sen_bmp280_io_SPI(sen_bmp280_t* bmp280, unsigned char mosi, unsigned char clk, unsigned char ss) {
     if (!ss)
         bmp280->i2c_mode = 0;
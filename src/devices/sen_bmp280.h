@@ -24,6 +24,7 @@
    ######################################################################## */
 
 #include "bitbang_i2c.h"
+#include "i2c_bus.h"
 #include "bitbang_spi.h"
 
 typedef struct {
@@ -44,4 +45,5 @@ void sen_bmp280_setPressTemp(sen_bmp280_t* bmp280, const float pressure, const f
 void sen_bmp280_set_addr(sen_bmp280_t* bmp280, unsigned char addr);
 
 unsigned char sen_bmp280_I2C_io(sen_bmp280_t* bmp280, const unsigned char scl, const unsigned char sda);
+void sen_bmp280_I2C_attach(sen_bmp280_t* bmp280, i2c_bus_t* bus);
 unsigned short sen_bmp280_io_SPI(sen_bmp280_t* bmp280, unsigned char mosi, unsigned char clk, unsigned char ss);
@@ -54,7 +54,7 @@ static void sen_dhtxx_callback(void* arg) {
     if (state < 84) {
         dhtxx->out = state & 0x01;  // odd values are logic one
         dhtxx->pboard->TimerChange_us(dhtxx->TimerID, dhtxx->uvalues[state]);
-        ioupdated = 1;
+        dhtxx->pboard->ioupdated = 1;
         dhtxx->state++;
     } else {
         dhtxx->pboard->TimerSetState(dhtxx->TimerID, 0);
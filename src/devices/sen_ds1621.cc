@@ -63,8 +63,8 @@ void sen_ds1621_end(sen_ds1621_t* ds1621) {
     dprintf("ds1621 end\n");
 }
 
-unsigned char sen_ds1621_I2C_io(sen_ds1621_t* ds1621, unsigned char scl, unsigned char sda) {
-    unsigned char ret = bitbang_i2c_io(&ds1621->bb_i2c, scl, sda);
+static void sen_ds1621_I2C_event(void* arg) {
+    sen_ds1621_t* ds1621 = (sen_ds1621_t*)arg;
 
     switch (bitbang_i2c_get_status(&ds1621->bb_i2c)) {
         case I2C_DATAW:
@@ -147,10 +147,20 @@ unsigned char sen_ds1621_I2C_io(sen_ds1621_t* ds1621, unsigned char scl, unsigne
             }
             break;
     }
+}
+
+unsigned char sen_ds1621_I2C_io(sen_ds1621_t* ds1621, unsigned char scl, unsigned char sda) {
+    unsigned char ret = bitbang_i2c_io(&ds1621->bb_i2c, scl, sda);
+
+    sen_ds1621_I2C_event(ds1621);
 
     return ret;
 }
 
+void sen_ds1621_I2C_attach(sen_ds1621_t* ds1621, i2c_bus_t* bus) {
+    i2c_bus_attach(bus, &ds1621->bb_i2c, sen_ds1621_I2C_event, ds1621);
+}
+
 void sen_ds1621_setTemp(sen_ds1621_t* ds1621, float temp) {
     ds1621->Temp = (temp * 2);
     ds1621->Temp = ds1621->Temp << 7;
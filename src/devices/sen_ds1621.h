@@ -25,6 +25,7 @@
 
 #include <time.h>
 #include "bitbang_i2c.h"
+#include "i2c_bus.h"
 
 typedef struct {
     bitbang_i2c_t bb_i2c;
@@ -42,3 +43,4 @@ void sen_ds1621_setTemp(sen_ds1621_t* ds1621, float temp);
 void sen_ds1621_set_addr(sen_ds1621_t* ds1621, unsigned char addr);
 
 unsigned char sen_ds1621_I2C_io(sen_ds1621_t* ds1621, unsigned char scl, unsigned char sda);
+void sen_ds1621_I2C_attach(sen_ds1621_t* ds1621, i2c_bus_t* bus);
@@ -103,5 +103,5 @@ void sen_hx711_setWeight(sen_hx711_t* hx711, const float weight) {
         hx711->bb_spi.ret = 1;
     }
 
-    ioupdated = 1;
+    hx711->pboard->ioupdated = 1;
 }
@@ -64,8 +64,8 @@ void mpu6050_end(mpu6050_t* mpu) {
     dprintf("mpu6050 end\n");
 }
 
-unsigned char mpu6050_io_I2C(mpu6050_t* mpu, unsigned char scl, unsigned char sda) {
-    unsigned char ret = bitbang_i2c_io(&mpu->bb_i2c, scl, sda);
+static void mpu6050_event_I2C(void* arg) {
+    mpu6050_t* mpu = (mpu6050_t*)arg;
 
     switch (bitbang_i2c_get_status(&mpu->bb_i2c)) {
         case I2C_ADDR:
@@ -114,10 +114,20 @@ unsigned char mpu6050_io_I2C(mpu6050_t* mpu, unsigned char scl, unsigned char sd
             }
             break;
     }
+}
+
+unsigned char mpu6050_io_I2C(mpu6050_t* mpu, unsigned char scl, unsigned char sda) {
+    unsigned char ret = bitbang_i2c_io(&mpu->bb_i2c, scl, sda);
+
+    mpu6050_event_I2C(mpu);
 
     return ret;
 }
 
+void mpu6050_attach_I2C(mpu6050_t* mpu, i2c_bus_t* bus) {
+    i2c_bus_attach(bus, &mpu->bb_i2c, mpu6050_event_I2C, mpu);
+}
+
 void mpu6050_set_temp(mpu6050_t* mpu, double temp) {
     // Temperature in degrees C = (TEMP_OUT Register Value as a signed quantity)/340 + 36.53
 
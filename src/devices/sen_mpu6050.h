@@ -24,6 +24,7 @@
    ######################################################################## */
 
 #include "bitbang_i2c.h"
+#include "i2c_bus.h"
 
 typedef struct {
     unsigned char regs[0x76];
@@ -44,6 +45,7 @@ void mpu6050_set_accel_raw(mpu6050_t* mpu, short x, short y, short z);  // g
 void mpu6050_set_gyro_raw(mpu6050_t* mpu, short x, short y, short z);   // degrees/s
 
 unsigned char mpu6050_io_I2C(mpu6050_t* mpu, unsigned char scl, unsigned char sda);
+void mpu6050_attach_I2C(mpu6050_t* mpu, i2c_bus_t* bus);
 
 // REGISTERS ADDRESS
 #define SELF_TEST_X 0x0D
@@ -44,7 +44,7 @@ static void uart_rx_callback(bitbang_uart_t* bu, void* arg) {
     uart_t* sr = (uart_t*)arg;
     unsigned char data = bitbang_uart_recv(&sr->bb_uart);
     if (sr->connected) {
-        serial_port_send(sr->serialfd, data);
+        serial_port_buff_send(&sr->serialbuff, data);
     }
 }
 
@@ -53,11 +53,13 @@ void uart_init(uart_t* sr, board* pboard) {
     sr->connected = 0;
     uart_rst(sr);
     sr->serialfd = INVALID_SERIAL;
+    serial_port_buff_init(&sr->serialbuff);
     dprintf("init uart\n");
 }
 
 void uart_end(uart_t* sr) {
     if (sr->connected) {
+        serial_port_buff_stop(&sr->serialbuff);
         serial_port_close(&sr->serialfd);
         sr->connected = 0;
     }
@@ -71,7 +73,7 @@ unsigned char uart_io(uart_t* sr, const unsigned char rx) {
 
     if (!bitbang_uart_transmitting(&sr->bb_uart)) {
         unsigned char data;
-        if (serial_port_rec(sr->serialfd, &data)) {
+        if (serial_port_buff_rec(&sr->serialbuff, &data)) {
             bitbang_uart_send(&sr->bb_uart, data);
         }
     }
@@ -80,6 +82,7 @@ unsigned char uart_io(uart_t* sr, const unsigned char rx) {
 
 void uart_set_port(uart_t* sr, const char* port, const unsigned int speed) {
     if (sr->connected) {
+        serial_port_buff_stop(&sr->serialbuff);
         serial_port_close(&sr->serialfd);
         sr->connected = 0;
     }
@@ -88,6 +91,7 @@ void uart_set_port(uart_t* sr, const char* port, const unsigned int speed) {
         sr->connected = 1;
         bitbang_uart_set_speed(&sr->bb_uart, speed);
         serial_port_cfg(sr->serialfd, speed);
+        serial_port_buff_start(&sr->serialbuff, sr->serialfd);
         dprintf("uart serial open: %s  speed %i\n", port, speed);
     } else {
         sr->connected = 0;
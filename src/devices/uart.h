@@ -33,6 +33,7 @@
 typedef struct {
     unsigned char connected;
     serialfd_t serialfd;
+    serial_port_buff_t serialbuff;
     bitbang_uart_t bb_uart;
 } uart_t;
 
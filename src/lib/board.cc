@@ -24,12 +24,13 @@
    ######################################################################## */
 
 #include "board.h"
+#include "oscilloscope.h"
 #include "picsimlab.h"
-
-int ioupdated = 0;
+#include "spareparts.h"
 
 board::board(void) {
     ioupdated = 1;
+    memset(ioupdated_pins, 0, sizeof(ioupdated_pins));
     inputc = 0;
     outputc = 0;
     use_oscope = 0;
@@ -39,18 +40,32 @@ board::board(void) {
     Scale = PICSimLab.GetScale();
     InstCounter = 0;
     TimersCount = 0;
+    TimersHeapCount = 0;
+    TimersUpdateNext();
     for (int i = 0; i < MAX_TIMERS; i++) {
         Timers[i].Arg = NULL;
         Timers[i].Callback = NULL;
         Timers[i].Enabled = 0;
+        Timers[i].HeapPos = -1;
     }
+    EdgesCount = 0;
+    memset(Edges, 0, sizeof(Edges));
+    alm_pins = NULL;
+    alm_pinc = 0;
+    alm_start = 0;
     for (int i = 0; i < MAX_IDS; i++) {
         input_ids[i] = &input[i];
         output_ids[i] = &output[i];
     }
 }
 
-board::~board(void) {}
+board::~board(void) {
+    for (int i = 0; i < 256; i++) {
+        if (Edges[i]) {
+            delete Edges[i];
+        }
+    }
+}
 
 void board::ReadMaps(void) {
     inputc = 0;
@@ -58,12 +73,13 @@ void board::ReadMaps(void) {
     ReadInputMap(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("boards/") + GetMapFile()));
     ReadOutputMap(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("boards/") + GetMapFile()));
 
+    // ids are resolved once by the map readers
     for (int i = 0; i < inputc; i++) {
-        input_ids[GetInputId(input[i].name)] = &input[i];
+        input_ids[input[i].id] = &input[i];
     }
 
     for (int i = 0; i < outputc; i++) {
-        output_ids[GetOutputId(output[i].name)] = &output[i];
+        output_ids[output[i].id] = &output[i];
     }
 }
 
@@ -377,17 +393,92 @@ void board::StartThread(void) {
 #endif
 }
 
-void board::InstCounterInc(void) {
-    InstCounter++;
-    for (int t = 0; t < TimersCount; t++) {
-        if (TimersList[t]->Enabled) {
-            TimersList[t]->Timer--;
-            if (!TimersList[t]->Timer) {
-                (*TimersList[t]->Callback)(TimersList[t]->Arg);
-                TimersList[t]->Timer = TimersList[t]->Reload;
-            }
+// Timers are kept in a binary min-heap ordered by the expiration instruction
+// count, so InstCounterInc only needs to compare InstCounter with the heap top.
+// The InstCounter is free running, then expirations are compared relative to it.
+
+#define TIMER_LEFT(t) ((t)->Timer - InstCounter)
+
+void board::TimersHeapFix(int pos) {
+    Timers_t* timer = TimersHeap[pos];
+    const uint32_t left = TIMER_LEFT(timer);
+
+    // sift up
+    while (pos > 0) {
+        int parent = (pos - 1) >> 1;
+        if (TIMER_LEFT(TimersHeap[parent]) <= left) {
+            break;
         }
+        TimersHeap[pos] = TimersHeap[parent];
+        TimersHeap[pos]->HeapPos = pos;
+        pos = parent;
+    }
+
+    // sift down
+    while (1) {
+        int child = (pos << 1) + 1;
+        if (child >= TimersHeapCount) {
+            break;
+        }
+        if (((child + 1) < TimersHeapCount) && (TIMER_LEFT(TimersHeap[child + 1]) < TIMER_LEFT(TimersHeap[child]))) {
+            child++;
+        }
+        if (left <= TIMER_LEFT(TimersHeap[child])) {
+            break;
+        }
+        TimersHeap[pos] = TimersHeap[child];
+        TimersHeap[pos]->HeapPos = pos;
+        pos = child;
+    }
+
+    TimersHeap[pos] = timer;
+    timer->HeapPos = pos;
+}
+
+void board::TimersUpdateNext(void) {
+    if (TimersHeapCount) {
+        TimersNext = TimersHeap[0]->Timer;
+    } else {
+        // no timer active, the run only checks the empty heap on counter overflow
+        TimersNext = InstCounter;
+    }
+}
+
+void board::TimerSchedule(Timers_t* timer) {
+    timer->Timer = InstCounter + timer->Reload;
+    if (timer->HeapPos < 0) {
+        timer->HeapPos = TimersHeapCount;
+        TimersHeap[TimersHeapCount] = timer;
+        TimersHeapCount++;
+    }
+    TimersHeapFix(timer->HeapPos);
+    TimersUpdateNext();
+}
+
+void board::TimerUnschedule(Timers_t* timer) {
+    int pos = timer->HeapPos;
+    if (pos < 0) {
+        return;
+    }
+    timer->HeapPos = -1;
+    TimersHeapCount--;
+    if (pos < TimersHeapCount) {
+        TimersHeap[pos] = TimersHeap[TimersHeapCount];
+        TimersHeap[pos]->HeapPos = pos;
+        TimersHeapFix(pos);
+    }
+    TimersHeap[TimersHeapCount] = NULL;
+    TimersUpdateNext();
+}
+
+void board::TimersRun(void) {
+    while (TimersHeapCount && (TimersHeap[0]->Timer == InstCounter)) {
+        Timers_t* timer = TimersHeap[0];
+        // reschedule before callback, the callback can change or disable the timer
+        TimerSchedule(timer);
+        (*timer->Callback)(timer->Arg);
     }
+    TimersUpdateNext();
 }
 
 int board::TimerRegister_us(const double micros, void (*Callback)(void* arg), void* arg) {
@@ -405,6 +496,7 @@ int board::TimerRegister_us(const double micros, void (*Callback)(void* arg), vo
         Timers[timern - 1].Enabled = 1;
         TimersList[TimersCount] = &Timers[timern - 1];
         TimersCount++;
+        TimerSchedule(&Timers[timern - 1]);
         return timern;
     }
     return -1;
@@ -425,6 +517,7 @@ int board::TimerRegister_ms(const double miles, void (*Callback)(void* arg), voi
         Timers[timern - 1].Enabled = 1;
         TimersList[TimersCount] = &Timers[timern - 1];
         TimersCount++;
+        TimerSchedule(&Timers[timern - 1]);
         return timern;
     }
     return -1;
@@ -433,6 +526,7 @@ int board::TimerRegister_ms(const double miles, void (*Callback)(void* arg), voi
 int board::TimerUnregister(const int timer) {
     if (timer <= MAX_TIMERS) {
         Timers[timer - 1].Callback = NULL;  // free timer
+        TimerUnschedule(&Timers[timer - 1]);
 
         int tltimer = 0;
         for (int t = 0; t < TimersCount; t++) {
@@ -457,8 +551,10 @@ int board::TimerChange_us(const int timer, const double micros) {
         if (Timers[timer - 1].Reload <= 0) {
             Timers[timer - 1].Reload = 1;
         }
-        Timers[timer - 1].Timer = Timers[timer - 1].Reload;
         Timers[timer - 1].Tout = micros;
+        if (Timers[timer - 1].HeapPos >= 0) {
+            TimerSchedule(&Timers[timer - 1]);
+        }
         return 0;
     }
     return -1;
@@ -470,8 +566,10 @@ int board::TimerChange_ms(const int timer, const double miles) {
         if (Timers[timer - 1].Reload <= 0) {
             Timers[timer - 1].Reload = 1;
         }
-        Timers[timer - 1].Timer = Timers[timer - 1].Reload;
         Timers[timer - 1].Tout = miles * 1e3;
+        if (Timers[timer - 1].HeapPos >= 0) {
+            TimerSchedule(&Timers[timer - 1]);
+        }
         return 0;
     }
     return -1;
@@ -481,7 +579,11 @@ int board::TimerSetState(const int timer, const int enabled) {
     if (timer <= MAX_TIMERS) {
         Timers[timer - 1].Enabled = enabled;
         if (enabled) {
-            Timers[timer - 1].Timer = Timers[timer - 1].Reload;
+            if (Timers[timer - 1].Callback) {
+                TimerSchedule(&Timers[timer - 1]);
+            }
+        } else {
+            TimerUnschedule(&Timers[timer - 1]);
         }
         return 0;
     }
@@ -495,6 +597,492 @@ uint64_t board::TimerGet_ns(const int timer) {
     return -1;
 }
 
+uint32_t board::EdgeWatch(const unsigned char pin) {
+    if (!pin) {
+        return 0;
+    }
+    pin_edges_t* log = Edges[pin];
+    if (!log) {
+        log = new pin_edges_t;
+        log->watch = 0;
+        log->head = 0;
+        Edges[pin] = log;
+    }
+    if (!log->watch) {
+        log->value = MGetPinsValues()[pin - 1].value;
+        EdgesList[EdgesCount] = pin;
+        EdgesCount++;
+    }
+    log->watch++;
+    return log->head;
+}
+
+void board::EdgeUnwatch(const unsigned char pin) {
+    pin_edges_t* log = Edges[pin];
+    if (!pin || !log || !log->watch) {
+        return;
+    }
+    log->watch--;
+    if (!log->watch) {
+        for (int i = 0; i < EdgesCount; i++) {
+            if (EdgesList[i] == pin) {
+                EdgesCount--;
+                EdgesList[i] = EdgesList[EdgesCount];
+                break;
+            }
+        }
+    }
+}
+
+int board::EdgeRead(const unsigned char pin, uint32_t* pos, pin_edge_t* edges, const int max) {
+    const pin_edges_t* log = Edges[pin];
+    int count = 0;
+
+    if (!pin || !log) {
+        return 0;
+    }
+
+    // reader too slow, skip the overwritten edges
+    if ((log->head - *pos) > EDGE_LOG_SIZE) {
+        *pos = log->head - EDGE_LOG_SIZE;
+    }
+
+    while ((*pos != log->head) && (count < max)) {
+        edges[count] = log->edges[*pos & (EDGE_LOG_SIZE - 1)];
+        (*pos)++;
+        count++;
+    }
+    return count;
+}
+
+void board::EdgesLog(const picpin* pins) {
+    for (int i = 0; i < EdgesCount; i++) {
+        const unsigned char pin = EdgesList[i];
+        pin_edges_t* log = Edges[pin];
+        if (pins[pin - 1].value != log->value) {
+            log->value = pins[pin - 1].value;
+            pin_edge_t* edge = &log->edges[log->head & (EDGE_LOG_SIZE - 1)];
+            edge->time = InstCounter;
+            edge->value = log->value;
+            log->head++;
+        }
+    }
+}
+
+uint64_t board::IdleSteps(const uint64_t max) {
+    uint64_t steps = max;
+
+    // always updated parts run on every step
+    if (use_spare && SpareParts.GetAlwaysUpdateCount()) {
+        return 0;
+    }
+
+    // next timer expiration
+    if (InstCounterIdle() < steps) {
+        steps = InstCounterIdle();
+    }
+
+    // next oscilloscope sample
+    if (use_oscope) {
+        const uint64_t osteps = Oscilloscope.GetIdleSteps();
+        if (osteps < steps) {
+            steps = osteps;
+        }
+    }
+
+    return steps;
+}
+
+// The mean value of each pin is its exact high time in the slice. Pins are only compared after the steps that
+// change some IO, the time of a pulse is added on its falling edge or at the end of the slice.
+void board::AlmStart(const picpin* pins, const int pinc) {
+    alm_pins = pins;
+    alm_pinc = (pinc < ALM_MAX_PINS) ? pinc : ALM_MAX_PINS;
+    alm_start = InstCounter;
+    for (int p = 0; p < alm_pinc; p++) {
+        alm[p] = 0;
+        alm_rise[p] = InstCounter;
+        alm_value[p] = (pins[p].value != 0);
+    }
+}
+
+void board::AlmScan(void) {
+    for (int p = 0; p < alm_pinc; p++) {
+        const unsigned char value = (alm_pins[p].value != 0);
+        if (value != alm_value[p]) {
+            if (value) {
+                alm_rise[p] = InstCounter;
+            } else {
+                alm[p] += InstCounter - alm_rise[p];
+            }
+            alm_value[p] = value;
+        }
+    }
+    EdgesUpdate(alm_pins);
+}
+
+void board::AlmEnd(picpin* pins) {
+    unsigned char oavalue[ALM_MAX_PINS];
+    const uint32_t now = InstCounter;
+    const uint32_t elapsed = now - alm_start;
+    const float scale = elapsed ? 200.0f / elapsed : 0;
+
+    AlmScan();
+
+    // branchless on contiguous arrays to let the compiler vectorize it
+    for (int p = 0; p < alm_pinc; p++) {
+        const uint32_t high = alm[p] + ((now - alm_rise[p]) & -(uint32_t)alm_value[p]);
+        float value = high * scale + 55;
+        value = (value < 255) ? value : 255;
+        oavalue[p] = (unsigned char)value;
+    }
+
+    for (int p = 0; p < alm_pinc; p++) {
+        pins[p].oavalue = oavalue[p];
+    }
+}
+
+// Snapshot file: header, InstCounter, timers, pins, cpu, board devices and parts state. Every item is a size
+// tagged block, so a snapshot of a different workspace or simulator version is refused instead of misread. The cpu,
+// board devices and each part are written as sections (a size tagged block of size tagged blocks), so the whole file
+// is checked before any state is changed.
+
+#define SNAPSHOT_MAGIC "PSLSNAP"
+#define SNAPSHOT_VERSION 3
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    char board[64];
+    char proc[64];
+    int32_t pinc;
+    int32_t partsc;
+} snapshot_header_t;
+
+typedef struct {
+    uint32_t left;  ///< steps to the next expiration
+    uint32_t reload;
+    int32_t registered;
+    int32_t enabled;
+    double tout;
+} snapshot_timer_t;
+
+typedef struct {
+    unsigned char dir;
+    unsigned char value;
+    unsigned char lvalue;
+    unsigned char ovalue;
+    unsigned char lsvalue;
+    float avalue;
+    float oavalue;
+} snapshot_pin_t;
+
+static void snapshot_header(snapshot_header_t* header, board* pboard) {
+    memset(header, 0, sizeof(snapshot_header_t));
+    strcpy(header->magic, SNAPSHOT_MAGIC);
+    header->version = SNAPSHOT_VERSION;
+    strncpy(header->board, (const char*)pboard->GetName().c_str(), 63);
+    strncpy(header->proc, (const char*)pboard->GetProcessorName().c_str(), 63);
+    header->pinc = pboard->MGetPinCount();
+    header->partsc = SpareParts.GetCount();
+}
+
+// write a zero size placeholder, returns its position or -1 on error
+static long snapshot_section_begin(FILE* fout) {
+    const uint32_t size = 0;
+    const long pos = ftell(fout);
+    if ((pos < 0) || (fwrite(&size, sizeof(size), 1, fout) != 1)) {
+        return -1;
+    }
+    return pos;
+}
+
+// write the section size in the placeholder
+static int snapshot_section_end(FILE* fout, const long pos) {
+    const long end = ftell(fout);
+    if ((pos < 0) || (end < 0)) {
+        return -1;
+    }
+    const uint32_t size = end - pos - sizeof(uint32_t);
+    if (fseek(fout, pos, SEEK_SET) || (fwrite(&size, sizeof(size), 1, fout) != 1) || fseek(fout, end, SEEK_SET)) {
+        return -1;
+    }
+    return 0;
+}
+
+// skip a section checking that its blocks fill it exactly
+static int snapshot_section_check(FILE* fin) {
+    uint32_t size;
+    uint32_t bsize;
+    if (fread(&size, sizeof(size), 1, fin) != 1) {
+        return -1;
+    }
+    while (size >= sizeof(bsize)) {
+        if (fread(&bsize, sizeof(bsize), 1, fin) != 1) {
+            return -1;
+        }
+        size -= sizeof(bsize);
+        if ((bsize > size) || fseek(fin, bsize, SEEK_CUR)) {
+            return -1;
+        }
+        size -= bsize;
+    }
+    return size ? -1 : 0;
+}
+
+// read the section size, returns the position of the section end or -1 on error
+static long snapshot_section_start(FILE* fin) {
+    uint32_t size;
+    if (fread(&size, sizeof(size), 1, fin) != 1) {
+        return -1;
+    }
+    const long pos = ftell(fin);
+    return (pos < 0) ? -1 : pos + size;
+}
+
+int board::SnapshotSave(const char* fname) {
+    snapshot_header_t header;
+    snapshot_timer_t timers[MAX_TIMERS];
+    snapshot_pin_t spins[256];
+    long section;
+    int ret = 0;
+
+    const picpin* pins = MGetPinsValues();
+    const int pinc = (MGetPinCount() < 256) ? MGetPinCount() : 256;
+
+    FILE* fout = fopen(fname, "wb");
+    if (!fout) {
+        printf("PICSimLab: Error creating snapshot file \"%s\"!\n", fname);
+        return -1;
+    }
+
+    snapshot_header(&header, this);
+    ret |= snapshot_write(fout, &header, sizeof(header));
+    ret |= snapshot_write(fout, &InstCounter, sizeof(InstCounter));
+
+    memset(timers, 0, sizeof(timers));
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        timers[i].reload = Timers[i].Reload;
+        timers[i].registered = (Timers[i].Callback != NULL);
+        timers[i].enabled = Timers[i].Enabled;
+        timers[i].tout = Timers[i].Tout;
+        if (Timers[i].HeapPos >= 0) {
+            timers[i].left = TIMER_LEFT(&Timers[i]);
+        }
+    }
+    ret |= snapshot_write(fout, timers, sizeof(timers));
+
+    for (int i = 0; i < pinc; i++) {
+        spins[i].dir = pins[i].dir;
+        spins[i].value = pins[i].value;
+        spins[i].lvalue = pins[i].lvalue;
+        spins[i].ovalue = pins[i].ovalue;
+        spins[i].lsvalue = pins[i].lsvalue;
+        spins[i].avalue = pins[i].avalue;
+        spins[i].oavalue = pins[i].oavalue;
+    }
+    ret |= snapshot_write(fout, spins, pinc * sizeof(snapshot_pin_t));
+
+    section = snapshot_section_begin(fout);
+    if (MSnapshotWrite(fout)) {
+        printf("PICSimLab: Snapshot not supported by board %s!\n", (const char*)GetName().c_str());
+        ret = -1;
+    }
+    ret |= snapshot_section_end(fout, section);
+
+    section = snapshot_section_begin(fout);
+    ret |= SnapshotWrite(fout);
+    ret |= snapshot_section_end(fout, section);
+
+    for (int i = 0; i < SpareParts.GetCount(); i++) {
+        char name[64];
+        memset(name, 0, sizeof(name));
+        strncpy(name, (const char*)SpareParts.GetPart(i)->GetName().c_str(), 63);
+        ret |= snapshot_write(fout, name, sizeof(name));
+        section = snapshot_section_begin(fout);
+        if (SpareParts.GetPart(i)->SnapshotWrite(fout)) {
+            printf("PICSimLab: Snapshot not supported by part %s!\n", name);
+            ret = -1;
+        }
+        ret |= snapshot_section_end(fout, section);
+    }
+
+    fclose(fout);
+
+    if (ret) {
+        printf("PICSimLab: Error writing snapshot file \"%s\"!\n", fname);
+        remove(fname);
+        return -1;
+    }
+    return 0;
+}
+
+int board::SnapshotLoad(const char* fname) {
+    snapshot_header_t header;
+    snapshot_header_t lheader;
+    snapshot_timer_t timers[MAX_TIMERS];
+    snapshot_pin_t spins[256];
+    uint32_t counter;
+    char name[64];
+    long end;
+    int ret = 0;
+
+    picpin* pins = (picpin*)MGetPinsValues();
+    const int pinc = (MGetPinCount() < 256) ? MGetPinCount() : 256;
+
+    FILE* fin = fopen(fname, "rb");
+    if (!fin) {
+        printf("PICSimLab: Error open snapshot file \"%s\"!\n", fname);
+        return -1;
+    }
+
+    // file size, a truncated section is found by the position after the check
+    fseek(fin, 0, SEEK_END);
+    const long fsize = ftell(fin);
+    rewind(fin);
+
+    snapshot_header(&header, this);
+    if (snapshot_read(fin, &lheader, sizeof(lheader)) || memcmp(&header, &lheader, sizeof(header))) {
+        printf("PICSimLab: Snapshot file \"%s\" is not of this workspace!\n", fname);
+        fclose(fin);
+        return -1;
+    }
+
+    // check the whole file before changing any state
+    ret |= snapshot_read(fin, &counter, sizeof(counter));
+    ret |= snapshot_read(fin, timers, sizeof(timers));
+    ret |= snapshot_read(fin, spins, pinc * sizeof(snapshot_pin_t));
+
+    // the callbacks are registered again by the same parts of the workspace, in the same order
+    for (int i = 0; (i < MAX_TIMERS) && !ret; i++) {
+        if ((Timers[i].Callback != NULL) != (timers[i].registered != 0)) {
+            ret = -1;
+        }
+    }
+
+    const long sections = ftell(fin);
+    ret |= snapshot_section_check(fin);  // cpu
+    ret |= snapshot_section_check(fin);  // board devices
+    for (int i = 0; (i < SpareParts.GetCount()) && !ret; i++) {
+        ret |= snapshot_read(fin, name, sizeof(name));
+        name[63] = 0;
+        if (!ret && strcmp(name, (const char*)SpareParts.GetPart(i)->GetName().c_str())) {
+            ret = -1;
+        }
+        ret |= snapshot_section_check(fin);
+    }
+
+    if (ret || (sections < 0) || (ftell(fin) != fsize)) {
+        printf("PICSimLab: Snapshot file \"%s\" is invalid!\n", fname);
+        fclose(fin);
+        return -1;
+    }
+
+    InstCounter = counter;
+
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        Timers_t* timer = &Timers[i];
+        if (!timer->Callback) {
+            continue;
+        }
+        timer->Reload = timers[i].reload;
+        timer->Tout = timers[i].tout;
+        timer->Enabled = timers[i].enabled;
+        if (timer->Enabled && timers[i].left) {
+            TimerSchedule(timer);
+            timer->Timer = InstCounter + timers[i].left;
+            TimersHeapFix(timer->HeapPos);
+        } else {
+            TimerUnschedule(timer);
+        }
+    }
+    TimersUpdateNext();
+
+    for (int i = 0; i < pinc; i++) {
+        pins[i].dir = spins[i].dir;
+        pins[i].value = spins[i].value;
+        pins[i].lvalue = spins[i].lvalue;
+        pins[i].ovalue = spins[i].ovalue;
+        pins[i].lsvalue = spins[i].lsvalue;
+        pins[i].avalue = spins[i].avalue;
+        pins[i].oavalue = spins[i].oavalue;
+    }
+
+    fseek(fin, sections, SEEK_SET);
+
+    end = snapshot_section_start(fin);
+    ret |= MSnapshotRead(fin);
+    ret |= (ftell(fin) != end);
+
+    end = snapshot_section_start(fin);
+    ret |= SnapshotRead(fin);
+    ret |= (ftell(fin) != end);
+
+    for (int i = 0; (i < SpareParts.GetCount()) && !ret; i++) {
+        ret |= snapshot_read(fin, name, sizeof(name));
+        end = snapshot_section_start(fin);
+        ret |= SpareParts.GetPart(i)->SnapshotRead(fin);
+        ret |= (ftell(fin) != end);
+    }
+
+    fclose(fin);
+
+    // wake up all parts
+    ioupdated = IOUPDATED_ALL;
+
+    if (ret) {
+        printf("PICSimLab: Error reading snapshot file \"%s\"!\n", fname);
+        return -1;
+    }
+    return 0;
+}
+
+int board::SnapshotWriteMemories(FILE* fout) {
+    const uint32_t pc = DBGGetPC();
+    int ret = snapshot_write(fout, &pc, sizeof(pc));
+    ret |= snapshot_write(fout, DBGGetRAM_p(), DBGGetRAM_p() ? DBGGetRAMSize() : 0);
+    ret |= snapshot_write(fout, DBGGetROM_p(), DBGGetROM_p() ? DBGGetROMSize() : 0);
+    ret |= snapshot_write(fout, DBGGetCONFIG_p(), DBGGetCONFIG_p() ? DBGGetCONFIGSize() : 0);
+    ret |= snapshot_write(fout, DBGGetID_p(), DBGGetID_p() ? DBGGetIDSize() : 0);
+    ret |= snapshot_write(fout, DBGGetEEPROM_p(), DBGGetEEPROM_p() ? DBGGetEEPROM_Size() : 0);
+    return ret;
+}
+
+int board::SnapshotReadMemories(FILE* fin) {
+    const uint32_t sizes[6] = {
+        sizeof(uint32_t),
+        DBGGetRAM_p() ? DBGGetRAMSize() : 0,
+        DBGGetROM_p() ? DBGGetROMSize() : 0,
+        DBGGetCONFIG_p() ? DBGGetCONFIGSize() : 0,
+        DBGGetID_p() ? DBGGetIDSize() : 0,
+        DBGGetEEPROM_p() ? DBGGetEEPROM_Size() : 0,
+    };
+    const long pos = ftell(fin);
+    uint32_t pc;
+
+    // check all the blocks sizes before changing any memory
+    for (int i = 0; i < 6; i++) {
+        uint32_t bsize;
+        if ((fread(&bsize, sizeof(bsize), 1, fin) != 1) || (bsize != sizes[i]) || fseek(fin, bsize, SEEK_CUR)) {
+            return -1;
+        }
+    }
+    if ((pos < 0) || fseek(fin, pos, SEEK_SET)) {
+        return -1;
+    }
+
+    int ret = snapshot_read(fin, &pc, sizeof(pc));
+    ret |= snapshot_read(fin, DBGGetRAM_p(), DBGGetRAM_p() ? DBGGetRAMSize() : 0);
+    ret |= snapshot_read(fin, DBGGetROM_p(), DBGGetROM_p() ? DBGGetROMSize() : 0);
+    ret |= snapshot_read(fin, DBGGetCONFIG_p(), DBGGetCONFIG_p() ? DBGGetCONFIGSize() : 0);
+    ret |= snapshot_read(fin, DBGGetID_p(), DBGGetID_p() ? DBGGetIDSize() : 0);
+    ret |= snapshot_read(fin, DBGGetEEPROM_p(), DBGGetEEPROM_p() ? DBGGetEEPROM_Size() : 0);
+    if (!ret) {
+        DBGSetPC(pc);
+    }
+    return ret;
+}
+
 uint32_t board::GetInstCounter_us(const uint32_t start) {
     return ((InstCounter - start) * 1e6) / MGetInstClockFreq();
 }
@@ -509,7 +1097,9 @@ void board::TimerUpdateFrequency(float freq) {
         if (TimersList[t]->Reload <= 0) {
             TimersList[t]->Reload = 1;
         }
-        TimersList[t]->Timer = TimersList[t]->Reload;
+        if (TimersList[t]->HeapPos >= 0) {
+            TimerSchedule(TimersList[t]);
+        }
     }
 }
 
@@ -29,6 +29,7 @@
 #include <lxrad.h>
 #include <picsim/picsim.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #define INCOMPLETE                                                      \
     printf("Incomplete: %s -> %s :%i\n", __func__, __FILE__, __LINE__); \
@@ -83,8 +84,12 @@ typedef struct {
 
 #define MAX_TIMERS 256
 
+#define EDGE_LOG_SIZE 256  // must be a power of 2
+
 #define MAX_IDS 128
 
+#define ALM_MAX_PINS 256
+
 #define INVALID_ID (MAX_IDS - 1)
 
 /**
@@ -92,14 +97,45 @@ typedef struct {
  *
  */
 typedef struct {
-    uint32_t Timer;
+    uint32_t Timer;  ///< absolute InstCounter value of next expiration
     uint32_t Reload;
     void* Arg;
     void (*Callback)(void* arg);
     int Enabled;
     double Tout;  // in us
+    int HeapPos;  ///< position in TimersHeap (-1 if not scheduled)
 } Timers_t;
 
+/**
+ * @brief pin edge record
+ *
+ */
+typedef struct {
+    uint32_t time;        ///< InstCounter value of the edge
+    unsigned char value;  ///< pin value after the edge
+} pin_edge_t;
+
+/**
+ * @brief ring buffer with the last edges of one pin
+ *
+ */
+typedef struct {
+    int watch;            ///< number of readers
+    unsigned char value;  ///< last logged pin value
+    uint32_t head;        ///< number of edges logged
+    pin_edge_t edges[EDGE_LOG_SIZE];
+} pin_edges_t;
+
+/**
+ * @brief IO updated flag values
+ *
+ * IOUPDATED_ALL: unknown change, wake all spare parts
+ * IOUPDATED_PINS: only the pins marked in ioupdated_pins changed
+ */
+enum { IOUPDATED_ALL = 1, IOUPDATED_PINS = 2 };
+
+#define IOUPDATED_WORDS (256 / 32)
+
 /**
  * @brief Board class
  *
@@ -612,6 +648,67 @@ public:
      */
     void TimerUpdateFrequency(float freq);
 
+    /**
+     * @brief Start logging the edges of a pin (1 to 255), returns the read position of the new reader
+     */
+    uint32_t EdgeWatch(const unsigned char pin);
+
+    /**
+     * @brief Stop logging the edges of a pin when it has no more readers
+     */
+    void EdgeUnwatch(const unsigned char pin);
+
+    /**
+     * @brief Copy up to max edges logged after position pos, returns the number of edges copied
+     *
+     * pos is advanced past the copied edges. Edges overwritten before being read are lost.
+     */
+    int EdgeRead(const unsigned char pin, uint32_t* pos, pin_edge_t* edges, const int max);
+
+    /**
+     * @brief Return true if the edges of the pin have some reader
+     */
+    bool EdgeWatched(const unsigned char pin) { return pin && Edges[pin] && Edges[pin]->watch; };
+
+    /**
+     * @brief Log the edges of the watched pins, called from AlmScan and AlmUpdate on every step
+     */
+    void EdgesUpdate(const picpin* pins) {
+        if (EdgesCount && pins) {
+            EdgesLog(pins);
+        }
+    };
+
+    /**
+     * @brief Save the simulation state (cpu, pins, timers and parts) to a binary snapshot file, return 0 on success
+     */
+    int SnapshotSave(const char* fname);
+
+    /**
+     * @brief Restore a simulation state saved with the same workspace, return 0 on success
+     */
+    int SnapshotLoad(const char* fname);
+
+    /**
+     * @brief board microcontroller write cpu state to snapshot, return 0 on success (-1 if not supported)
+     */
+    virtual int MSnapshotWrite(FILE* fout) { return -1; };
+
+    /**
+     * @brief board microcontroller read cpu state from snapshot, return 0 on success
+     */
+    virtual int MSnapshotRead(FILE* fin) { return -1; };
+
+    /**
+     * @brief Write the state of the board devices to snapshot, return 0 on success
+     */
+    virtual int SnapshotWrite(FILE* fout) { return 0; };
+
+    /**
+     * @brief Read the state of the board devices from snapshot, return 0 on success
+     */
+    virtual int SnapshotRead(FILE* fin) { return 0; };
+
     /**
      * @brief Lock IO to others threads access
      */
@@ -637,6 +734,26 @@ public:
      */
     virtual lxString GetClkLabel(void) { return "Clk (Mhz)"; };
 
+    /**
+     * @brief Mark one pin (1 to 255) as changed
+     */
+    void ioupdated_pin(const unsigned char pin) {
+        ioupdated_pins[pin >> 5] |= 1U << (pin & 0x1F);
+        if (!ioupdated) {
+            ioupdated = IOUPDATED_PINS;
+        }
+    };
+
+    /**
+     * @brief IO updated flag of this board simulation (0, IOUPDATED_ALL or IOUPDATED_PINS)
+     */
+    int ioupdated;
+
+    /**
+     * @brief pins changed since the last spare parts process, valid when ioupdated is IOUPDATED_PINS
+     */
+    uint32_t ioupdated_pins[IOUPDATED_WORDS];
+
 protected:
     /**
      * @brief Register remote control variables
@@ -646,7 +763,68 @@ protected:
     /**
      * @brief Increment the Intructions Counter
      */
-    void InstCounterInc(void);
+    void InstCounterInc(void) {
+        InstCounter++;
+        if (InstCounter == TimersNext) {
+            TimersRun();
+        }
+    };
+
+    /**
+     * @brief Number of InstCounterInc calls that don't expire any timer (UINT32_MAX if no timer is enabled)
+     */
+    uint32_t InstCounterIdle(void) { return TimersHeapCount ? (TimersNext - InstCounter - 1) : UINT32_MAX; };
+
+    /**
+     * @brief Write the memories and PC read by the DBGGet* functions to snapshot
+     */
+    int SnapshotWriteMemories(FILE* fout);
+
+    /**
+     * @brief Read the memories and PC written by SnapshotWriteMemories
+     */
+    int SnapshotReadMemories(FILE* fin);
+
+    /**
+     * @brief Advance the Intructions Counter by steps lower or equal to InstCounterIdle()
+     */
+    void InstCounterSkip(const uint32_t steps) { InstCounter += steps; };
+
+    /**
+     * @brief Number of steps (up to max) that can be skipped without changing the simulation
+     */
+    uint64_t IdleSteps(const uint64_t max);
+
+    /**
+     * @brief Start the pins mean value (brightness) integration of a new time slice
+     */
+    void AlmStart(const picpin* pins, const int pinc);
+
+    /**
+     * @brief Integrate the pins changed in the last step (signaled by ioupdated), call it after InstCounterInc
+     */
+    inline void AlmUpdate(void);
+
+    /**
+     * @brief Integrate the pins changed since the last scan and log the watched pins edges, for simulators that don't
+     * signal ioupdated
+     */
+    void AlmScan(void);
+
+    /**
+     * @brief End the time slice and write the pins mean value (55 to 255) to oavalue
+     */
+    void AlmEnd(picpin* pins);
+
+    /**
+     * @brief Run nstep steps of the time slice (defined in board_run.h)
+     *
+     * step(i, run) executes the cpu instruction (if run is not zero) up to InstCounterInc and post(i) the board
+     * work after the oscilloscope, spare parts and mean value updates. The oscilloscope, spare parts and
+     * breakpoint tests are selected once per call and compiled out of the loop when not used.
+     */
+    template <typename Step, typename Post>
+    void Run_CPU_Steps(const long int nstep, Step step, Post post);
 
     lxString Proc;                  ///< Name of processor in use
     lxString DProc;                 ///< Name of default board processor
@@ -672,10 +850,55 @@ protected:
     void StartThread(void);
 
 private:
+    template <int flags, typename Step, typename Post>
+    void Run_CPU_StepsK(const long int nstep, Step& step, Post& post);
+
     uint32_t InstCounter;
+    uint32_t TimersNext;  ///< InstCounter value of the nearest timer expiration
     int TimersCount;
     Timers_t Timers[MAX_TIMERS];
     Timers_t* TimersList[MAX_TIMERS];
+    int TimersHeapCount;
+    Timers_t* TimersHeap[MAX_TIMERS];  ///< enabled timers min-heap ordered by expiration
+    pin_edges_t* Edges[256];           ///< edge logs of watched pins
+    unsigned char EdgesList[256];      ///< watched pins
+    int EdgesCount;
+    const picpin* alm_pins;                 ///< integrated pins
+    int alm_pinc;                           ///< number of integrated pins
+    uint32_t alm_start;                     ///< InstCounter value of the time slice start
+    uint32_t alm[ALM_MAX_PINS];             ///< pins high time of closed pulses
+    uint32_t alm_rise[ALM_MAX_PINS];        ///< InstCounter value of the last pins rising edge
+    unsigned char alm_value[ALM_MAX_PINS];  ///< pins value of the last scan (0 or 1)
+
+    /**
+     * @brief Log the new edges of watched pins
+     */
+    void EdgesLog(const picpin* pins);
+
+    /**
+     * @brief Run the callbacks of expired timers
+     */
+    void TimersRun(void);
+
+    /**
+     * @brief Schedule timer expiration to InstCounter + Reload
+     */
+    void TimerSchedule(Timers_t* timer);
+
+    /**
+     * @brief Remove timer from the expiration heap
+     */
+    void TimerUnschedule(Timers_t* timer);
+
+    /**
+     * @brief Restore heap order after a timer expiration change
+     */
+    void TimersHeapFix(int pos);
+
+    /**
+     * @brief Update TimersNext with the heap top
+     */
+    void TimersUpdateNext(void);
 
     /**
      * @brief Read the Input Map
@@ -688,7 +911,41 @@ private:
     void ReadOutputMap(lxString fname);
 };
 
-extern int ioupdated;
+/**
+ * @brief Write a size tagged block to a snapshot file, return 0 on success
+ */
+static inline int snapshot_write(FILE* fout, const void* data, const uint32_t size) {
+    if (fwrite(&size, sizeof(size), 1, fout) != 1) {
+        return -1;
+    }
+    if (size && (fwrite(data, size, 1, fout) != 1)) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Read a size tagged block from a snapshot file, return 0 on success or -1 if the size doesn't match
+ */
+static inline int snapshot_read(FILE* fin, void* data, const uint32_t size) {
+    uint32_t bsize;
+    if ((fread(&bsize, sizeof(bsize), 1, fin) != 1) || (bsize != size)) {
+        return -1;
+    }
+    if (size && (fread(data, size, 1, fin) != 1)) {
+        return -1;
+    }
+    return 0;
+}
+
+inline void board::AlmUpdate(void) {
+    if (ioupdated) {
+        AlmScan();
+    } else {
+        // edges are checked on every step, pins can change without ioupdated
+        EdgesUpdate(alm_pins);
+    }
+}
 
 #endif /* BOARD_H */
 
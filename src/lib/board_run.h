@@ -0,0 +1,91 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef BOARD_RUN_H
+#define BOARD_RUN_H
+
+#include "../devices/mplabxd.h"
+#include "board.h"
+#include "oscilloscope.h"
+#include "picsimlab.h"
+#include "spareparts.h"
+
+#define RUN_OSCOPE 0x01
+#define RUN_SPARE 0x02
+#define RUN_BP 0x04
+
+template <int flags, typename Step, typename Post>
+void board::Run_CPU_StepsK(const long int nstep, Step& step, Post& post) {
+    // without breakpoints mplabxd_testbp() returns the debug halt state, constant in the time slice
+    const int run = !PICSimLab.GetMcuDbg();
+
+    for (long int i = 0; i < nstep; i++) {
+        step(i, (flags & RUN_BP) ? !mplabxd_testbp() : run);
+        if (flags & RUN_OSCOPE)
+            Oscilloscope.SetSample();
+        if (flags & RUN_SPARE)
+            SpareParts.Process();
+
+        // integrate mean value of changed pins
+        AlmUpdate();
+
+        post(i);
+    }
+}
+
+template <typename Step, typename Post>
+void board::Run_CPU_Steps(const long int nstep, Step step, Post post) {
+    const int flags = (use_oscope ? RUN_OSCOPE : 0) | (use_spare ? RUN_SPARE : 0) |
+                      (mplabxd_testbp_needed() ? RUN_BP : 0);
+
+    switch (flags) {
+        case 0:
+            Run_CPU_StepsK<0>(nstep, step, post);
+            break;
+        case RUN_OSCOPE:
+            Run_CPU_StepsK<RUN_OSCOPE>(nstep, step, post);
+            break;
+        case RUN_SPARE:
+            Run_CPU_StepsK<RUN_SPARE>(nstep, step, post);
+            break;
+        case RUN_OSCOPE | RUN_SPARE:
+            Run_CPU_StepsK<RUN_OSCOPE | RUN_SPARE>(nstep, step, post);
+            break;
+        case RUN_BP:
+            Run_CPU_StepsK<RUN_BP>(nstep, step, post);
+            break;
+        case RUN_BP | RUN_OSCOPE:
+            Run_CPU_StepsK<RUN_BP | RUN_OSCOPE>(nstep, step, post);
+            break;
+        case RUN_BP | RUN_SPARE:
+            Run_CPU_StepsK<RUN_BP | RUN_SPARE>(nstep, step, post);
+            break;
+        case RUN_BP | RUN_OSCOPE | RUN_SPARE:
+            Run_CPU_StepsK<RUN_BP | RUN_OSCOPE | RUN_SPARE>(nstep, step, post);
+            break;
+    }
+}
+
+#endif /* BOARD_RUN_H */
@@ -31,23 +31,76 @@
 
 COscilloscope Oscilloscope;
 
+// samples are stored as 16 bits codes from -8V to +8V
+#define OSC_VOFFSET 8.0f
+#define OSC_VSCALE 4096.0f
+
+static inline uint16_t osc_quantize(const float v) {
+    const float code = (v + OSC_VOFFSET) * OSC_VSCALE;
+    if (code <= 0)
+        return 0;
+    if (code >= 65535)
+        return 65535;
+    return (uint16_t)code;
+}
+
+static inline float osc_volts(const uint16_t code) {
+    return (code / OSC_VSCALE) - OSC_VOFFSET;
+}
+
+static inline float osc_pin_value(const picpin* pin, const float vmax) {
+    if ((pin->ptype == PT_ANALOG) && (pin->dir == PD_IN))
+        return pin->avalue;
+    return pin->value * vmax;
+}
+
+static inline void osc_merge(osc_minmax_t* mm, const uint16_t min, const uint16_t max) {
+    if (min < mm->min)
+        mm->min = min;
+    if (max > mm->max)
+        mm->max = max;
+}
+
 COscilloscope::COscilloscope() {
+    Window = NULL;
+    pboard = NULL;
     Dt = 0;
     Rt = 0;
+    Ct = 0;
     usetrigger = 1;
     triggerlv = 2.5;
-    chpin[0] = 0;
-    chpin[1] = 1;
+    for (int c = 0; c < OSC_MAX_CHANNELS; c++) {
+        chpin[c] = (c < 2) ? c : -1;
+        samples[c] = NULL;
+        for (int l = 0; l < OSC_LEVELS; l++) {
+            pyramid[c][l] = NULL;
+        }
+    }
     toffset = 250;
     run = 1;
 
-    fp = 0;
+    // same amplitude of the old rand() noise, but cheap and repeatable
+    uint32_t seed = 1;
+    for (int i = 0; i < OSC_NOISE_SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+        noise[i] = ((((seed >> 16) & 0x7FFF) / 32767.0f) - 0.5f) * 0.1f;
+    }
+    nidx = 0;
+
     tch = 0;
-    is = 0;
+    wcount = 0;
+    trpos = 0;
+    frame_trig = 0;
+    frame_ct = 0;
+    vtrg = 0;
     t = 0;
     tr = 0;
     update = 0;
 
+    memset(acc, 0, sizeof(acc));
+    memset(ch_meas, 0, sizeof(ch_meas));
+    memset(ch_status, 0, sizeof(ch_status));
+
     measures[0] = 1;
     measures[1] = 2;
     measures[2] = 0;
@@ -58,67 +111,284 @@ COscilloscope::COscilloscope() {
 
     tbstop = NULL;
     tbsingle = NULL;
+
+    StartFrame();
 }
 
-void COscilloscope::SetSample(void) {
-    double pins[2];
+COscilloscope::~COscilloscope() {
+    for (int c = 0; c < OSC_MAX_CHANNELS; c++) {
+        free(samples[c]);
+        free(pyramid[c][0]);
+    }
+}
 
-    const picpin* ppins = pboard->MGetPinsValues();
+void COscilloscope::SetRT(double rt) {
+    Rt = rt;
+    tr = 0;
+    StartFrame();
+}
 
-    if ((!run) || (tbsingle == NULL))
+void COscilloscope::SetDT(double dt) {
+    Dt = dt;
+    tr = 0;
+    StartFrame();
+}
+
+void COscilloscope::StartFrame(void) {
+    // capture OSC_OVERSAMPLE samples per screen column, but at most one per step
+    Ct = Rt / OSC_OVERSAMPLE;
+    if (Ct < Dt)
+        Ct = Dt;
+
+    // pre and post trigger screens
+    if (Ct > 0) {
+        frame_len = (uint64_t)ceil((2 * WMAX * Rt) / Ct);
+    } else {
+        frame_len = 2 * WMAX;
+    }
+    if (frame_len < 2)
+        frame_len = 2;
+    frame_pre = frame_len / 2;
+    acq_start = wcount;
+}
+
+void COscilloscope::EndFrame(const uint64_t trig) {
+    if (tr && tbsingle->GetCheck()) {
+        tbstop->SetCheck(1);
+    }
+    frame_trig = trig;
+    frame_ct = Ct;
+    for (int c = 0; c < OSC_MAX_CHANNELS; c++) {
+        if (chpin[c] >= 0) {
+            PublishStats(c);
+        }
+    }
+    tr = 0;
+    update = 1;  // Request redraw screen
+    StartFrame();
+}
+
+void COscilloscope::Capture(const int channel, float value) {
+    value += noise[nidx++ & (OSC_NOISE_SIZE - 1)];
+
+    const uint32_t p = wcount & OSC_DEPTH_MASK;
+    uint16_t* s = samples[channel];
+    s[p] = osc_quantize(value);
+
+    // block completed, update the pyramid up to the first incomplete level
+    if ((p & OSC_BLOCK_MASK) == OSC_BLOCK_MASK) {
+        osc_minmax_t mm = {0xFFFF, 0};
+        for (uint32_t i = p - OSC_BLOCK_MASK; i <= p; i++) {
+            osc_merge(&mm, s[i], s[i]);
+        }
+        uint32_t idx = p >> OSC_BLOCK_BITS;
+        pyramid[channel][0][idx] = mm;
+        for (int l = 1; (l < OSC_LEVELS) && (idx & 1); l++) {
+            const osc_minmax_t prev = pyramid[channel][l - 1][idx - 1];
+            osc_merge(&mm, prev.min, prev.max);
+            idx >>= 1;
+            pyramid[channel][l][idx] = mm;
+        }
+    }
+
+    // measures
+    osc_acc_t* a = &acc[channel];
+    if (a->n == 0) {
+        a->vmax = value;
+        a->vmin = value;
+        a->down = (value < a->vavr);
+    }
+    if (a->vmax < value)
+        a->vmax = value;
+    if (a->vmin > value)
+        a->vmin = value;
+    a->sum += value;
+    a->sum2 += value * value;
+
+    // find out frequency (using previous Vavr)
+    if (a->down && (value > a->vavr))  // transition UP
+    {
+        if (a->upseen) {
+            a->sumfcw += (a->n - a->lup);
+            a->nfc++;
+        } else {
+            a->upseen = 1;
+        }
+        a->down = 0;
+        a->lup = a->n;
+    } else if (!a->down && (value < a->vavr))  // transition Down
+    {
+        if (a->upseen) {
+            a->sumpcw += (a->n - a->lup);
+            a->npc++;
+        }
+        a->down = 1;
+    }
+    a->n++;
+}
+
+void COscilloscope::PublishStats(const int channel) {
+    osc_acc_t* a = &acc[channel];
+    ch_status_t* st = &ch_meas[channel];
+
+    if (!a->n) {
+        memset(st, 0, sizeof(ch_status_t));
         return;
+    }
 
-    if ((ppins[chpin[0]].ptype == PT_ANALOG) && (ppins[chpin[0]].dir == PD_IN))
-        pins[0] = ppins[chpin[0]].avalue;
-    else
-        pins[0] = ppins[chpin[0]].value * vmax;
+    st->Vmax = a->vmax;
+    st->Vmin = a->vmin;
+    st->Vavr = a->sum / a->n;  // Voltage average
+    st->Vrms = sqrt(a->sum2 / a->n);
 
-    if ((ppins[chpin[1]].ptype == PT_ANALOG) && (ppins[chpin[1]].dir == PD_IN))
-        pins[1] = ppins[chpin[1]].avalue;
-    else
-        pins[1] = ppins[chpin[1]].value * vmax;
+    const double avgFCycleWidth = a->nfc ? (a->sumfcw * Ct / a->nfc) : 0;
+    const double avgPCycleWidth = a->npc ? (a->sumpcw * Ct / a->npc) : 0;
+
+    const int pulseValid =
+        (a->nfc > 0) && (avgFCycleWidth != 0) && (avgPCycleWidth != 0) && ((st->Vmax - st->Vmin) > 0.2);
+
+    if (pulseValid) {
+        st->PCycle_ms = avgPCycleWidth * 1000;
+        st->FCycle_ms = avgFCycleWidth * 1000;
+        st->Freq = 1.0 / avgFCycleWidth;
+        st->Duty = avgPCycleWidth * 100 / avgFCycleWidth;
+    } else {
+        st->PCycle_ms = -1;
+        st->FCycle_ms = -1;
+        st->Freq = -1;
+        st->Duty = -1;
+    }
+
+    const float vavr = st->Vavr;
+    memset(a, 0, sizeof(osc_acc_t));
+    a->vavr = vavr;
+}
+
+void COscilloscope::SetSample(void) {
+    if ((!run) || (tbsingle == NULL))
+        return;
+
+    const picpin* ppins = pboard->MGetPinsValues();
 
     // sampling
-    if (t > Rt) {
-        t -= Rt;
-        databuffer[fp][0][is] = -pins[0] + ((1.0 * rand() / RAND_MAX) - 0.5) * 0.1;
-        databuffer[fp][1][is] = -pins[1] + ((1.0 * rand() / RAND_MAX) - 0.5) * 0.1;
-        is++;
-        if (is >= NPOINTS)  // buffer full
-        {
-            if (tr && tbsingle->GetCheck()) {
-                tbstop->SetCheck(1);
+    if (t >= Ct) {
+        t -= Ct;
+        for (int c = 0; c < OSC_MAX_CHANNELS; c++) {
+            if (chpin[c] >= 0) {
+                Capture(c, osc_pin_value(&ppins[chpin[c]], vmax));
+            }
+        }
+        wcount++;
+
+        if (tr) {
+            if (wcount >= (trpos + frame_len - frame_pre)) {
+                EndFrame(trpos);
             }
-            is = 0;
-            tr = 0;
-            t = 0;
-            ch[0] = &databuffer[fp][0][toffset];
-            ch[1] = &databuffer[fp][1][toffset];
-            fp = !fp;    // togle fp
-            update = 1;  // Request redraw screen
+        } else if ((wcount - acq_start) >= frame_len) {  // buffer full
+            EndFrame(acq_start + frame_pre);
         }
     }
     t += Dt;
 
     // trigger
-    if (usetrigger) {
-        if ((!tr) && (is >= NPOINTS / 2)) {
-            if ((pins_[tch] < triggerlv) && (pins[tch] >= triggerlv)) {
+    if (usetrigger && (chpin[tch] >= 0)) {
+        const float value = osc_pin_value(&ppins[chpin[tch]], vmax);
+        if ((!tr) && ((wcount - acq_start) >= frame_pre)) {
+            if ((vtrg < triggerlv) && (value >= triggerlv)) {
                 tr = 1;
+                trpos = wcount;
+            }
+        }
+        vtrg = value;
+    }
+}
 
-                is = is - (NPOINTS / 2);
+uint64_t COscilloscope::GetIdleSteps(void) {
+    if ((!run) || (tbsingle == NULL)) {
+        return UINT64_MAX;
+    }
+    if (t >= Ct) {
+        return 0;
+    }
+    if (Dt <= 0) {
+        return UINT64_MAX;
+    }
+    // one step less to be safe with rounding
+    const double steps = floor((Ct - t) / Dt);
+    return (steps > 1) ? (uint64_t)(steps - 1) : 0;
+}
 
-                for (int i = 0; i < NPOINTS / 2; i++) {
-                    databuffer[fp][0][i] = databuffer[fp][0][i + is];
-                    databuffer[fp][1][i] = databuffer[fp][1][i + is];
-                }
-                is = (NPOINTS / 2);
-            }
+void COscilloscope::SkipIdleSteps(const uint64_t steps) {
+    if ((!run) || (tbsingle == NULL)) {
+        return;
+    }
+    // the pins don't change while idle, so no trigger can happen
+    t += steps * Dt;
+}
+
+void COscilloscope::RangeMinMax(const int channel, uint32_t a, uint32_t b, osc_minmax_t* mm) {
+    const uint16_t* s = samples[channel];
+
+    // partial blocks at the edges
+    while ((a < b) && (a & OSC_BLOCK_MASK)) {
+        osc_merge(mm, s[a], s[a]);
+        a++;
+    }
+    while ((a < b) && (b & OSC_BLOCK_MASK)) {
+        b--;
+        osc_merge(mm, s[b], s[b]);
+    }
+
+    a >>= OSC_BLOCK_BITS;
+    b >>= OSC_BLOCK_BITS;
+    for (int l = 0; a < b; l++) {
+        if (a & 1) {
+            osc_merge(mm, pyramid[channel][l][a].min, pyramid[channel][l][a].max);
+            a++;
         }
+        if (b & 1) {
+            b--;
+            osc_merge(mm, pyramid[channel][l][b].min, pyramid[channel][l][b].max);
+        }
+        a >>= 1;
+        b >>= 1;
     }
+}
 
-    pins_[0] = pins[0];
-    pins_[1] = pins[1];
+void COscilloscope::GetEnvelope(const int channel, const int col0, const int ncols, float* vmin, float* vmax) {
+    const uint64_t wc = wcount;
+    const int64_t first = (wc > OSC_DEPTH) ? (int64_t)(wc - OSC_DEPTH) : 0;
+    const int64_t last = wc;
+    const double spc = (frame_ct > 0) ? (Rt / frame_ct) : 0;  // samples per column
+
+    for (int i = 0; i < ncols; i++) {
+        int64_t s0 = frame_trig + (int64_t)floor((col0 + i) * spc);
+        int64_t s1 = frame_trig + (int64_t)floor((col0 + i + 1) * spc);
+        if (s1 <= s0)
+            s1 = s0 + 1;
+        if (s0 < first)
+            s0 = first;
+        if (s1 > last)
+            s1 = last;
+
+        if ((spc <= 0) || (s0 >= s1) || (samples[channel] == NULL)) {
+            vmin[i] = 1;
+            vmax[i] = -1;
+            continue;
+        }
+
+        osc_minmax_t mm = {0xFFFF, 0};
+        const uint32_t a = s0 & OSC_DEPTH_MASK;
+        const uint32_t n = s1 - s0;
+        if (a + n <= OSC_DEPTH) {
+            RangeMinMax(channel, a, a + n, &mm);
+        } else {
+            RangeMinMax(channel, a, OSC_DEPTH, &mm);
+            RangeMinMax(channel, 0, a + n - OSC_DEPTH, &mm);
+        }
+        vmin[i] = osc_volts(mm.min);
+        vmax[i] = osc_volts(mm.max);
+    }
 }
 
 void COscilloscope::NextMeasure(int mn) {
@@ -137,82 +407,8 @@ void COscilloscope::SetMeasure(int nm, int value) {
 }
 
 void COscilloscope::CalculateStats(int channel) {
-    ch_status[channel].Vmax = -1000;
-    ch_status[channel].Vmin = 1000;
-    double sumSamples = 0;
-    double sumSquares = 0;
-    double val = -ch[channel][0];
-    int i = 1;
-    bool ltr_down = (val < ch_status[channel].Vavr);  // last transition down
-    bool firstUp = true;
-    unsigned short ltrsHigh = 0;    // last transition sample high number
-    unsigned short sumFCW = 0;      // Full cycle width sum
-    unsigned short sumPCW = 0;      // Positive semi-cycle width sum
-    unsigned short numFCycles = 0;  // Number of full cycles
-    unsigned short numPCycles = 0;  // Number of positive semi-cycles
-
-    for (i = 1; i < (NPOINTS / 2) - 1; i++) {
-        val = -ch[channel][i];
-
-        if (ch_status[channel].Vmax < val)
-            ch_status[channel].Vmax = val;
-        if (ch_status[channel].Vmin > val)
-            ch_status[channel].Vmin = val;
-        sumSamples += val;
-        sumSquares += (val * val);
-
-        // find out frequency (using previous Vavr)
-        if (ltr_down && (val > ch_status[channel].Vavr))  // transition UP
-        {
-            if (!firstUp) {
-                sumFCW += (i - 1 - ltrsHigh);
-                numFCycles++;
-            } else {
-                firstUp = false;
-            }
-            ltr_down = false;
-            ltrsHigh = i - 1;
-        } else if (!ltr_down && (val < ch_status[channel].Vavr))  // transition Down
-        {
-            if (!firstUp) {
-                sumPCW += (i - 1 - ltrsHigh);
-                numPCycles++;
-            }
-            ltr_down = true;
-        }
-    }
-
-    ch_status[channel].Vavr = sumSamples / (NPOINTS / 2);  // Voltage average
-    ch_status[channel].Vrms = sqrt(sumSquares / (NPOINTS / 2));
-
-    double avgFCycleWidth = sumFCW * Rt / numFCycles;
-    double avgPCycleWidth = sumPCW * Rt / numPCycles;
-
-    int pulseValid = (numFCycles > 0) && (avgFCycleWidth != 0) && (avgPCycleWidth != 0) &&
-                     ((ch_status[channel].Vmax - ch_status[channel].Vmin) > 0.2);
-
-    if (pulseValid) {
-        ch_status[channel].PCycle_ms = avgPCycleWidth * 1000;
-        ch_status[channel].FCycle_ms = avgFCycleWidth * 1000;
-        ch_status[channel].Freq = 1.0 / avgFCycleWidth;
-        ch_status[channel].Duty = avgPCycleWidth * 100 / avgFCycleWidth;
-    } else {
-        ch_status[channel].PCycle_ms = -1;
-        ch_status[channel].FCycle_ms = -1;
-        ch_status[channel].Freq = -1;
-        ch_status[channel].Duty = -1;
-    }
-    /*
-    printf ("================\n");
-    printf ("avgPW %lf ms\n", ch_status[channel].PCycle_ms);
-    printf ("duty %lf %%\n", ch_status[channel].Duty);
-    printf ("freq %lf Hz\n", ch_status[channel].Freq);
-    printf ("cycle %lf ms\n", ch_status[channel].FCycle_ms);
-    printf ("Vrms %lf V\n", ch_status[channel].Vrms);
-    printf ("Vavr %lf V\n", ch_status[channel].Vavr);
-    printf ("Vmax %lf V\n", ch_status[channel].Vmax);
-    printf ("Vmin %lf V\n", ch_status[channel].Vmax);
-     */
+    // measures are taken while sampling, just show the last complete frame
+    ch_status[channel] = ch_meas[channel];
 }
 
 void COscilloscope::ClearStats(int channel) {
@@ -224,6 +420,21 @@ void COscilloscope::Reset(void) {
 }
 
 void COscilloscope::Init(CWindow* win) {
+    // untouched pages of unused channels don't take memory
+    int psize = 0;
+    for (int l = 0; l < OSC_LEVELS; l++) {
+        psize += OSC_DEPTH >> (OSC_BLOCK_BITS + l);
+    }
+    for (int c = 0; c < OSC_MAX_CHANNELS; c++) {
+        if (samples[c] == NULL) {
+            samples[c] = (uint16_t*)calloc(OSC_DEPTH, sizeof(uint16_t));
+            pyramid[c][0] = (osc_minmax_t*)calloc(psize, sizeof(osc_minmax_t));
+            for (int l = 1; l < OSC_LEVELS; l++) {
+                pyramid[c][l] = pyramid[c][l - 1] + (OSC_DEPTH >> (OSC_BLOCK_BITS + l - 1));
+            }
+        }
+    }
+
     Window = win;
     tbstop = (CToggleButton*)Window->GetChildByName("togglebutton6");
     tbsingle = (CToggleButton*)Window->GetChildByName("togglebutton7");
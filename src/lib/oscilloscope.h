@@ -31,10 +31,23 @@
 #define WMAX 350
 #define HMAX 250
 
-#define NPOINTS (2 * WMAX)
-
 #define MAX_MEASURES 10
 
+#define OSC_MAX_CHANNELS 4
+
+#define OSC_DEPTH_BITS 21
+#define OSC_DEPTH (1 << OSC_DEPTH_BITS)  // ring buffer samples per channel
+#define OSC_DEPTH_MASK (OSC_DEPTH - 1)
+
+#define OSC_BLOCK_BITS 4  // samples of the pyramid base blocks (log2)
+#define OSC_BLOCK (1 << OSC_BLOCK_BITS)
+#define OSC_BLOCK_MASK (OSC_BLOCK - 1)
+#define OSC_LEVELS (OSC_DEPTH_BITS - OSC_BLOCK_BITS + 1)
+
+#define OSC_OVERSAMPLE 8  // samples per screen column
+
+#define OSC_NOISE_SIZE 1024
+
 typedef struct {
     double Vrms;
     double Vavr;
@@ -46,9 +59,31 @@ typedef struct {
     double Duty;
 } ch_status_t;
 
+typedef struct {
+    uint16_t min;
+    uint16_t max;
+} osc_minmax_t;
+
+typedef struct {
+    uint32_t n;       // number of samples
+    double sum;       // sum of samples
+    double sum2;      // sum of squared samples
+    float vmax;       // max sample
+    float vmin;       // min sample
+    float vavr;       // average of the last frame, used as transition level
+    int down;         // last transition down
+    int upseen;       // first transition up already seen
+    uint32_t lup;     // last transition up sample number
+    uint32_t sumfcw;  // full cycle width sum
+    uint32_t sumpcw;  // positive semi-cycle width sum
+    uint32_t nfc;     // number of full cycles
+    uint32_t npc;     // number of positive semi-cycles
+} osc_acc_t;
+
 class COscilloscope {
 public:
     COscilloscope();
+    ~COscilloscope();
 
     void Init(CWindow* win);
 
@@ -57,6 +92,16 @@ public:
      */
     void SetSample(void);
 
+    /**
+     * @brief  Number of SetSample calls that don't take any sample
+     */
+    uint64_t GetIdleSteps(void);
+
+    /**
+     * @brief  Replace steps SetSample calls, steps must be lower or equal to GetIdleSteps()
+     */
+    void SkipIdleSteps(const uint64_t steps);
+
     void SetBoard(board* b) { pboard = b; };
 
     void NextMeasure(int mn);
@@ -71,8 +116,15 @@ public:
     int GetTriggerChannel(void) { return tch; };
     void SetTriggerChannel(int tc) { tch = tc; };
 
-    double* GetChannel(int cn) { return ch[cn]; };
+    /**
+     * @brief  Min/max envelope of ncols screen columns of the last frame, starting at column col0 relative to the
+     * trigger. Columns without data return vmin > vmax.
+     */
+    void GetEnvelope(const int channel, const int col0, const int ncols, float* vmin, float* vmax);
 
+    /**
+     * @brief  Update the channel status with the measures of the last frame
+     */
     void CalculateStats(int channel);
     void ClearStats(int channel);
 
@@ -82,6 +134,7 @@ public:
     void SetUpdate(int up) { update = up; };
 
     void SetChannelPin(int ch, int pin) { chpin[ch] = pin; };
+    int GetChannelPin(int ch) { return chpin[ch]; };
 
     int GetTimeOffset(void) { return toffset; };
     void SetTimeOffset(int to) { toffset = to; };
@@ -93,10 +146,10 @@ public:
 
     void SetVMax(float vm) { vmax = vm; };
 
-    void SetRT(double rt) { Rt = rt; };
+    void SetRT(double rt);
     double GetRT(void) { return Rt; };
 
-    void SetDT(double dt) { Dt = dt; };
+    void SetDT(double dt);
     double GetDT(void) { return Dt; };
 
     void Reset(void);
@@ -112,23 +165,39 @@ public:
     void ReadPreferencesList(lxStringList pl);
 
 private:
+    void StartFrame(void);
+    void EndFrame(const uint64_t trig);
+    void Capture(const int channel, float value);
+    void PublishStats(const int channel);
+    void RangeMinMax(const int channel, uint32_t a, uint32_t b, osc_minmax_t* mm);
+
     CWindow* Window;
     board* pboard;
     double Dt;  // Delta T
     double Rt;  // Relative delta T
+    double Ct;  // Capture delta T
     int usetrigger;
     double triggerlv;
     int tch;  // trigger channel
     int toffset;
-    int chpin[2];
-    double databuffer[2][2][NPOINTS];  // flip buffers + 2 channels + 700 points
-    int fp;                            // actual flip buffer
-    double* ch[2];                     // actual channel data (pointer to databuffer)
-    ch_status_t ch_status[2];          // channel measurament status
-    double pins_[2];                   // last value of input pins
-    int is;                            // input samples
-    double t;                          // time
-    int tr;                            // trigger
+    int chpin[OSC_MAX_CHANNELS];
+    uint16_t* samples[OSC_MAX_CHANNELS];                  // ring buffer of quantized samples
+    osc_minmax_t* pyramid[OSC_MAX_CHANNELS][OSC_LEVELS];  // min/max of blocks of (OSC_BLOCK << level) samples
+    osc_acc_t acc[OSC_MAX_CHANNELS];                      // measures of the current frame
+    ch_status_t ch_meas[OSC_MAX_CHANNELS];                // measures of the last frame
+    ch_status_t ch_status[OSC_MAX_CHANNELS];              // channel measurament status
+    float noise[OSC_NOISE_SIZE];                          // precomputed noise table
+    uint32_t nidx;                                        // noise table index
+    uint64_t wcount;                                      // samples written
+    uint64_t acq_start;                                   // first sample of the current frame
+    uint64_t frame_len;                                   // samples of a frame
+    uint64_t frame_pre;                                   // samples before the trigger
+    uint64_t trpos;                                       // trigger sample of the current frame
+    uint64_t frame_trig;                                  // trigger sample of the last frame
+    double frame_ct;                                      // capture delta T of the last frame
+    float vtrg;                                           // last value of trigger pin
+    double t;                                             // time
+    int tr;                                               // trigger
     int run;
     int update;
     int measures[5];
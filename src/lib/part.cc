@@ -27,6 +27,23 @@
 #include "../lib/picsimlab.h"
 #include "../lib/spareparts.h"
 
+#define MAX_MAPS 256
+
+// parsed map file of one part type, ids already resolved
+typedef struct {
+    lxString name;
+    lxString fname;
+    unsigned int width;
+    unsigned int height;
+    int inputc;
+    int outputc;
+    input_t input[MAX_IDS];
+    output_t output[MAX_IDS];
+} part_map_t;
+
+static part_map_t* maps[MAX_MAPS];
+static int mapsc = 0;
+
 part::part(const unsigned x, const unsigned y, const char* name, const char* type, board* pboard_, const int fsize)
     : font(fsize, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     always_update = 0;
@@ -63,21 +80,54 @@ void part::Init(void) {
 }
 
 void part::ReadMaps(void) {
-    inputc = 0;
-    outputc = 0;
-    ReadInputMap(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetMapFile()));
-    ReadOutputMap(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetMapFile()));
+    lxString fname = lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetMapFile());
+    part_map_t* map = NULL;
+
+    // map files are shared by parts of different types (../Common/IC*.map), the ids are not
+    for (int i = 0; i < mapsc; i++) {
+        if ((maps[i]->fname == fname) && (maps[i]->name == GetName())) {
+            map = maps[i];
+            break;
+        }
+    }
+
+    if (map) {
+        Width = map->width;
+        Height = map->height;
+        inputc = map->inputc;
+        outputc = map->outputc;
+        memcpy(input, map->input, inputc * sizeof(input_t));
+        memcpy(output, map->output, outputc * sizeof(output_t));
+    } else {
+        inputc = 0;
+        outputc = 0;
+        int ok = ReadInputMap(fname);
+        ok &= ReadOutputMap(fname);
+
+        if (ok && (mapsc < MAX_MAPS)) {
+            map = new part_map_t;
+            map->name = GetName();
+            map->fname = fname;
+            map->width = Width;
+            map->height = Height;
+            map->inputc = inputc;
+            map->outputc = outputc;
+            memcpy(map->input, input, inputc * sizeof(input_t));
+            memcpy(map->output, output, outputc * sizeof(output_t));
+            maps[mapsc++] = map;
+        }
+    }
 
     for (int i = 0; i < inputc; i++) {
-        input_ids[GetInputId(input[i].name)] = &input[i];
+        input_ids[input[i].id] = &input[i];
     }
 
     for (int i = 0; i < outputc; i++) {
-        output_ids[GetOutputId(output[i].name)] = &output[i];
+        output_ids[output[i].id] = &output[i];
     }
 }
 
-void part::ReadInputMap(lxString fname) {
+int part::ReadInputMap(lxString fname) {
     FILE* fin;
 
     char line[256];
@@ -170,10 +220,12 @@ void part::ReadInputMap(lxString fname) {
     } else {
         printf("PICSimLab: (%s) Error open input.map \"%s\"!\n", (const char*)Name.c_str(), (const char*)fname.c_str());
         PICSimLab.RegisterError(Name + ": Error open input.map:\n" + fname);
+        return 0;
     }
+    return 1;
 }
 
-void part::ReadOutputMap(lxString fname) {
+int part::ReadOutputMap(lxString fname) {
     FILE* fin;
 
     char line[256];
@@ -247,7 +299,9 @@ void part::ReadOutputMap(lxString fname) {
         printf("PICSimLab: (%s) Error open output.map \"%s\"!\n", (const char*)Name.c_str(),
                (const char*)fname.c_str());
         PICSimLab.RegisterError(Name + ": Error open output.map:\n" + fname);
+        return 0;
     }
+    return 1;
 }
 
 int part::PointInside(int x, int y) {
@@ -321,32 +375,47 @@ int part::PointInside(int x, int y, input_t input) {
         return 0;
 }
 
-void part::LoadImage(void) {
-    lxImage image(SpareParts.GetWindow());
+lxBitmap* part::GetPictureImage(void) {
     lxString iname = lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetPictureFileName());
 
-    if (image.LoadFile(iname, Orientation, Scale, Scale)) {
-        if (SpareParts.GetWindow()) {
-            Bitmap = new lxBitmap(&image, SpareParts.GetWindow());
-            image.Destroy();
-            canvas.Destroy();
-            canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
-        }
-    } else if (image.LoadFile(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/Common/notfound.svg")), Orientation,
-                              Scale, Scale)) {
-        if (SpareParts.GetWindow()) {
-            Bitmap = new lxBitmap(&image, SpareParts.GetWindow());
-
-            image.Destroy();
-            canvas.Destroy();
-            canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
-        }
+    // the rasterized image is shared by all parts of the same type, each part draws over its own copy
+    lxBitmap* BackBitmap = SpareParts.GetImage(iname, Orientation, Scale);
+
+    if (!BackBitmap) {
+        BackBitmap = SpareParts.GetImage(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/Common/notfound.svg")),
+                                         Orientation, Scale);
         printf("PICSimLab: (%s) Error loading image %s\n", (const char*)Name.c_str(), (const char*)iname.c_str());
+        if (!BackBitmap) {
+            exit(-1);
+        }
         PICSimLab.RegisterError("Error loading image:\n " + iname);
-    } else {
-        printf("PICSimLab: (%s) Error loading image %s\n", (const char*)Name.c_str(), (const char*)iname.c_str());
-        exit(-1);
     }
+    return BackBitmap;
+}
+
+void part::LoadImage(void) {
+    if (!SpareParts.GetWindow()) {
+        return;
+    }
+
+    lxBitmap* BackBitmap = GetPictureImage();
+
+    lxImage image(SpareParts.GetWindow());
+    image.CreateBlank(Width, Height, Orientation, Scale, Scale);
+    Bitmap = new lxBitmap(&image, SpareParts.GetWindow());
+    image.Destroy();
+
+    canvas.Destroy();
+    canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
+
+    canvas.Init(Scale, Scale, Orientation);
+    canvas.SetColor(50, 50, 50);
+    canvas.Rectangle(1, 0, 0, Width, Height);
+
+    canvas.ChangeScale(1.0, 1.0);
+    canvas.PutBitmap(BackBitmap, 0, 0);
+    canvas.ChangeScale(Scale, Scale);
+    canvas.End();
 }
 
 int part::GetOrientation(void) {
@@ -183,6 +183,18 @@ public:
      */
     virtual void ReadPreferences(lxString value) = 0;
 
+    /**
+     * @brief  Write part internal state to simulation snapshot, return 0 on success (-1 if not supported)
+     *
+     * Parts without simulation state (only configuration and pins) return 0 without writing anything.
+     */
+    virtual int SnapshotWrite(FILE* fout) { return -1; };
+
+    /**
+     * @brief  Read part internal state from simulation snapshot, return 0 on success
+     */
+    virtual int SnapshotRead(FILE* fin) { return -1; };
+
     /**
      * @brief  return the input ids numbers of names used in input map
      */
@@ -367,6 +379,11 @@ protected:
      */
     virtual void RegisterRemoteControl(void){};
 
+    /**
+     * @brief Return the shared rasterized picture of the part (notfound.svg if the picture can't be loaded)
+     */
+    lxBitmap* GetPictureImage(void);
+
     int id;                         ///< part ID
     input_t input[MAX_IDS];         ///< input map elements
     input_t* input_ids[MAX_IDS];    ///< input map elements by id order
@@ -415,14 +432,14 @@ private:
     lxString Name;
 
     /**
-     * @brief  Read the Input Map
+     * @brief  Read the Input Map, return 0 on error
      */
-    void ReadInputMap(lxString fname);
+    int ReadInputMap(lxString fname);
 
     /**
-     * @brief  Read the Output Map
+     * @brief  Read the Output Map, return 0 on error
      */
-    void ReadOutputMap(lxString fname);
+    int ReadOutputMap(lxString fname);
 };
 
 #endif /* PART_H */
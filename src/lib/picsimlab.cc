@@ -23,6 +23,8 @@
    For e-mail suggestions :  lcgamboa@yahoo.com
    ######################################################################## */
 
+#include <chrono>
+
 #include "picsimlab.h"
 #include "oscilloscope.h"
 #include "spareparts.h"
@@ -75,12 +77,31 @@ CPICSimLab::CPICSimLab() {
     use_dsr_reset = 1;
     settodestroy = 0;
     sync = 0;
+    slices = 0;
+    syncs = 0;
+    sync_stop = 0;
     SHARE = "";
     pzwtmpdir[0] = 0;
+    freerun = 0;
+    freerun_exit = 0;
+    freerun_time = 0;
+    freerun_wtime = 0;
+    freerun_steps = 0;
+    freerun_icount = 0;
+    stop_time = 0;
+    stop_uart[0] = 0;
+    stop_uart_len = 0;
+    stop_uart_found = 0;
+    memset(uart_last, 0, sizeof(uart_last));
+    stop_pin = 0;
+    stop_pin_value = 0;
+    bench_timers = 0;
 
 #ifndef _NOTHREAD
     cpu_mutex = NULL;
     cpu_cond = NULL;
+    sync_mutex = NULL;
+    sync_cond = NULL;
 #endif
 
     menu_EvBoard = NULL;
@@ -337,6 +358,13 @@ void CPICSimLab::EndSimulation(int saveold, const char* newpath) {
     cpu_mutex->Lock();
     cpu_cond->Signal();
     cpu_mutex->Unlock();
+    // release remote control sync waiters
+    sync_mutex->Lock();
+    sync_stop = 1;
+    sync_cond->Broadcast();
+    sync_mutex->Unlock();
+#else
+    sync_stop = 1;
 #endif
     if (Window) {
         ((CThread*)Window->GetChildByName("thread1"))->Destroy();
@@ -445,6 +473,10 @@ void CPICSimLab::EndSimulation(int saveold, const char* newpath) {
     delete cpu_mutex;
     cpu_cond = NULL;
     cpu_mutex = NULL;
+    delete sync_cond;
+    delete sync_mutex;
+    sync_cond = NULL;
+    sync_mutex = NULL;
 #endif
 
     if (GetNeedReboot()) {
@@ -884,8 +916,11 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
     if (cpu_mutex == NULL) {
         cpu_mutex = new lxMutex();
         cpu_cond = new lxCondition(*cpu_mutex);
+        sync_mutex = new lxMutex();
+        sync_cond = new lxCondition(*sync_mutex);
     }
 #endif
+    sync_stop = 0;
 
     if (Instance && !HOME.compare(home)) {
         snprintf(fname, 1023, "%s/picsimlab_%i.ini", home, Instance);
@@ -1260,6 +1295,183 @@ void CPICSimLab::SetToDestroy(void) {
     settodestroy = 1;
 }
 
+void CPICSimLab::SyncSignal(const int slice) {
+#ifndef _NOTHREAD
+    if (sync_mutex == NULL) {
+        return;
+    }
+    sync_mutex->Lock();
+#endif
+    if (slice) {
+        slices++;
+    } else {
+        sync = 1;
+        syncs++;
+    }
+#ifndef _NOTHREAD
+    sync_cond->Broadcast();
+    sync_mutex->Unlock();
+#endif
+}
+
+int CPICSimLab::WaitSync(const unsigned int count, const int slice) {
+    volatile unsigned int* counter = slice ? &slices : &syncs;
+#ifndef _NOTHREAD
+    if (sync_mutex == NULL) {
+        return 1;
+    }
+    sync_mutex->Lock();
+    const unsigned int start = *counter;
+    while (((*counter - start) < count) && (!sync_stop)) {
+        sync_cond->Wait();
+    }
+    sync_mutex->Unlock();
+#else
+    const unsigned int start = *counter;
+    while (((*counter - start) < count) && (!sync_stop)) {
+        usleep(1000);
+    }
+#endif
+    return sync_stop;
+}
+
+static double wall_time(void) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int CPICSimLab::SetFreeRunOption(const char* opt) {
+    unsigned int pin, value;
+
+    if (!strcmp(opt, "run")) {
+    } else if (!strncmp(opt, "stop-time=", 10)) {
+        stop_time = atof(opt + 10);
+    } else if (!strncmp(opt, "stop-uart=", 10)) {
+        strncpy(stop_uart, opt + 10, 255);
+        stop_uart[255] = 0;
+        stop_uart_len = strlen(stop_uart);
+    } else if ((!strncmp(opt, "stop-pin=", 9)) && (sscanf(opt + 9, "%u:%u", &pin, &value) == 2) && (pin > 0) &&
+               (pin < 256)) {
+        stop_pin = pin;
+        stop_pin_value = value;
+    } else if ((!strncmp(opt, "bench-timers=", 13)) && (sscanf(opt + 13, "%u", &value) == 1) && (value <= 64)) {
+        bench_timers = value;
+    } else {
+        return 0;
+    }
+
+    freerun = 1;
+    return 1;
+}
+
+void CPICSimLab::UartOutput(const unsigned char c) {
+    if (!freerun) {
+        return;
+    }
+
+    putchar(c);
+
+    if (stop_uart_len) {
+        memmove(uart_last, uart_last + 1, stop_uart_len - 1);
+        uart_last[stop_uart_len - 1] = c;
+        if (!memcmp(uart_last, stop_uart, stop_uart_len)) {
+            stop_uart_found = 1;
+        }
+    }
+}
+
+static void bench_timer_callback(void* arg) {}
+
+int CPICSimLab::FreeRunStep(void) {
+    const char* reason = NULL;
+
+    if (settodestroy) {
+        return 1;
+    }
+
+    if (freerun_time == 0) {
+        // timers microbenchmark, periods from 10us to 73us
+        for (unsigned int i = 0; i < bench_timers; i++) {
+            pboard->TimerRegister_us(10 + i, bench_timer_callback, NULL);
+        }
+        freerun_wtime = wall_time();  // first slice is not timed
+        freerun_icount = pboard->GetInstCounter();
+    }
+    freerun_time += BASETIMER * 1e-3;
+
+    // simulation steps (instructions) executed, for the speed report
+    const uint32_t icount = pboard->GetInstCounter();
+    freerun_steps += (uint32_t)(icount - freerun_icount);
+    freerun_icount = icount;
+
+    if (stop_uart_found) {
+        reason = "UART pattern";
+    } else if (stop_pin && (stop_pin > pboard->MGetPinCount())) {
+        printf("\nPICSimLab: Invalid stop pin %i, the board has %i pins\n", stop_pin, pboard->MGetPinCount());
+        freerun_exit = 1;
+        reason = "invalid pin";
+    } else if (stop_pin && (pboard->MGetPinsValues()[stop_pin - 1].value == stop_pin_value)) {
+        reason = "pin state";
+    } else if ((stop_time > 0) && (freerun_time >= stop_time)) {
+        reason = "time limit";
+        // waiting for an event that did not happen
+        freerun_exit = (stop_uart_len || stop_pin) ? 2 : 0;
+    }
+
+    if (reason) {
+        double wtime = wall_time() - freerun_wtime;
+        printf("\nPICSimLab: Free run stop by %s at %.3fs (%.3fs of wall time, %.1fx, %.2f MIPS)\n", reason,
+               freerun_time, wtime, freerun_time / wtime, freerun_steps / (wtime * 1e6));
+        fflush(stdout);
+        SetToDestroy();
+        return 1;
+    }
+    return 0;
+}
+
+int CPICSimLab::SaveSnapshot(lxString fname) {
+    const int di = status.st[0] & ST_DI;
+
+    // wait the simulation thread stop between two steps
+    status.st[0] |= ST_DI;
+    while (status.status & 0x0401) {
+        msleep(1);
+        Application->ProcessEvents();
+    }
+
+    int ret = GetBoard()->SnapshotSave(fname.char_str());
+
+    if (!di) {
+        status.st[0] &= ~ST_DI;
+    }
+
+    if (ret) {
+        RegisterError(lxT("Error saving snapshot file!"));
+    }
+    return ret;
+}
+
+int CPICSimLab::LoadSnapshot(lxString fname) {
+    const int di = status.st[0] & ST_DI;
+
+    // wait the simulation thread stop between two steps
+    status.st[0] |= ST_DI;
+    while (status.status & 0x0401) {
+        msleep(1);
+        Application->ProcessEvents();
+    }
+
+    int ret = GetBoard()->SnapshotLoad(fname.char_str());
+
+    if (!di) {
+        status.st[0] &= ~ST_DI;
+    }
+
+    if (ret) {
+        RegisterError(lxT("Error loading snapshot file!"));
+    }
+    return ret;
+}
+
 int CPICSimLab::LoadHexFile(lxString fname) {
     int pa;
     int ret = 0;
@@ -219,6 +219,9 @@ public:
 
     int LoadHexFile(lxString fname);
 
+    int SaveSnapshot(lxString fname);
+    int LoadSnapshot(lxString fname);
+
     void LoadWorkspace(lxString fnpzw, const int show_readme = 1);
     void SaveWorkspace(lxString fnpzw);
 
@@ -252,9 +255,49 @@ public:
 
     char* GetPzwTmpdir(void) { return pzwtmpdir; };
 
+    /**
+     * @brief  Return the number of Run_CPU slices executed
+     */
+    unsigned int GetSliceCount(void) { return slices; };
+
+    /**
+     * @brief  Wake threads blocked in WaitSync after a timer event (slice = 0) or a Run_CPU slice (slice = 1)
+     */
+    void SyncSignal(const int slice);
+
+    /**
+     * @brief  Block until count timer events (slice = 0) or Run_CPU slices (slice = 1) happen, return 1 if the
+     * simulation ended while waiting
+     */
+    int WaitSync(const unsigned int count, const int slice);
+
+    /**
+     * @brief  Parse a free running batch mode command line option (without the leading --)
+     */
+    int SetFreeRunOption(const char* opt);
+
+    /**
+     * @brief  Return true if Run_CPU must be called back to back without wall clock pacing
+     */
+    int GetFreeRun(void) { return freerun; };
+
+    /**
+     * @brief  Account one Run_CPU slice in free running mode and check the stop conditions
+     */
+    int FreeRunStep(void);
+
+    int GetFreeRunExitCode(void) { return freerun_exit; };
+
+    /**
+     * @brief  Receive one byte sent by the microcontroller UART (used by the --stop-uart condition)
+     */
+    void UartOutput(const unsigned char c);
+
 #ifndef _NOTHREAD
     lxCondition* cpu_cond;
     lxMutex* cpu_mutex;
+    lxCondition* sync_cond;
+    lxMutex* sync_mutex;
 #endif
     union {
         char st[2];
@@ -314,7 +357,24 @@ private:
     double idle_ms;
     int settodestroy;
     unsigned char sync;
+    volatile unsigned int slices;
+    volatile unsigned int syncs;
+    volatile int sync_stop;
     char pzwtmpdir[1024];
+    int freerun;
+    int freerun_exit;
+    double freerun_time;
+    double freerun_wtime;
+    uint64_t freerun_steps;
+    uint32_t freerun_icount;
+    double stop_time;
+    char stop_uart[256];
+    unsigned int stop_uart_len;
+    char uart_last[256];
+    unsigned char stop_uart_found;
+    unsigned char stop_pin;
+    unsigned char stop_pin_value;
+    unsigned int bench_timers;
 };
 
 extern CPICSimLab PICSimLab;
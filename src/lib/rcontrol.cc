@@ -49,6 +49,8 @@
 #endif
 // system headers independent
 #include <errno.h>
+#include <limits.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -69,6 +71,66 @@ static int server_started = 0;
 static char buffer[BSIZE];
 static int bp = 0;
 
+// binary stream mode ======================================================
+// frame: 0xA5, type, payload length (uint16 LE), payload
+#define FRAME_SYNC 0xA5
+#define FRAME_TEXT 'T'     // text reply
+#define FRAME_CHANGES 'C'  // stream_chg_t records
+#define FRAME_MAX 0xFFFF   // payload size limit
+
+enum { SK_PIN, SK_APIN, SK_BOARD_OUT, SK_PART_OUT };
+
+#define STREAM_MAX 512
+
+typedef struct {
+    unsigned char kind;
+    unsigned char part;
+    unsigned char index;
+    unsigned char dir;
+    float value;
+    unsigned char watched;  ///< board pin with edges read from the board edge log
+    uint32_t pos;           ///< edge log read position
+} stream_rec_t;
+
+// change record sent to the client
+typedef struct {
+    uint32_t time;  ///< InstCounter value of the change
+    unsigned char kind;
+    unsigned char part;
+    unsigned char index;
+    unsigned char dir;
+    float value;
+} stream_chg_t;
+
+static stream_rec_t stream_items[STREAM_MAX];
+static int stream_count = 0;
+static int stream_on = 0;
+static unsigned int stream_slice = 0;
+static board* stream_board = NULL;
+
+static void stream_watch(const int watch);
+
+static int sendframe(const unsigned char type, const void* payload, const unsigned int size) {
+    unsigned char header[4];
+
+    if (size > FRAME_MAX) {
+        printf("rcontrol: frame too long (%u bytes)\n", size);
+        return 1;
+    }
+
+    header[0] = FRAME_SYNC;
+    header[1] = type;
+    header[2] = size & 0xFF;
+    header[3] = (size >> 8) & 0xFF;
+
+    if ((send(sockfd, (const char*)header, 4, MSG_NOSIGNAL) != 4) ||
+        (size && (send(sockfd, (const char*)payload, size, MSG_NOSIGNAL) != (int)size))) {
+        printf("rcontrol: send error : %s \n", strerror(errno));
+        return 1;
+    }
+    return 0;
+}
+
 void setnblock(int sock_descriptor) {
 #ifndef _WIN_
     int flags;
@@ -153,6 +215,18 @@ int rcontrol_init(const unsigned short tcpport, const int reporterror) {
 static int sendtext(const char* str) {
     int size = strlen(str);
 
+    if (stream_on) {
+        // long replies are split in several frames
+        int ret = 0;
+        do {
+            const int len = (size < FRAME_MAX) ? size : FRAME_MAX;
+            ret |= sendframe(FRAME_TEXT, str, len);
+            str += len;
+            size -= len;
+        } while (size && !ret);
+        return ret;
+    }
+
     if (send(sockfd, str, size, MSG_NOSIGNAL) != size) {
         printf("rcontrol: send error : %s \n", strerror(errno));
         return 1;
@@ -183,6 +257,9 @@ int rcontrol_start(void) {
 
     memset(buffer, 0, BSIZE);
     bp = 0;
+    stream_on = 0;
+    stream_watch(0);
+    stream_count = 0;
 
     return sendtext(
         "\r\nPICSimLab Remote Control Interface\r\n\r\n  Type help "
@@ -408,6 +485,214 @@ static char pintypetoletter(unsigned char type) {
     return '?';
 }
 
+static int stream_value(stream_rec_t* item, float* value) {
+    board* Board = PICSimLab.GetBoard();
+    output_t* Output;
+
+    switch (item->kind) {
+        case SK_PIN:
+        case SK_APIN: {
+            const picpin* pins;
+            if (item->index > Board->MGetPinCount()) {
+                pins = SpareParts.GetPinsValues();
+            } else {
+                pins = Board->MGetPinsValues();
+            }
+            item->dir = pins[item->index - 1].dir;
+            *value = (item->kind == SK_PIN) ? pins[item->index - 1].value : pins[item->index - 1].avalue;
+            return 1;
+        }
+        case SK_BOARD_OUT:
+            if (item->index >= Board->GetOutputCount()) {
+                return 0;
+            }
+            Output = Board->GetOutput(item->index);
+            break;
+        case SK_PART_OUT:
+            if ((item->part >= SpareParts.GetCount()) ||
+                (item->index >= SpareParts.GetPart(item->part)->GetOutputCount())) {
+                return 0;
+            }
+            Output = SpareParts.GetPart(item->part)->GetOutput(item->index);
+            break;
+        default:
+            return 0;
+    }
+
+    if (Output->status == NULL) {
+        return 0;
+    }
+    if (type_is_equal(Output->name, "LD")) {
+        *value = *((float*)Output->status) - 55;
+    } else if (type_is_equal(Output->name, "DG")) {
+        *value = *((float*)Output->status) * 180.0 / M_PI;
+    } else if (type_is_equal(Output->name, "SS")) {
+        *value = *((int*)Output->status);
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// the board edge watch list is only changed with the simulation thread stopped between two steps
+static void stream_watch(const int watch) {
+    board* Board = PICSimLab.GetBoard();
+    const int di = PICSimLab.status.st[0] & ST_DI;
+
+    if (!stream_count) {
+        stream_board = Board;
+        return;
+    }
+
+    PICSimLab.status.st[0] |= ST_DI;
+    while (PICSimLab.status.status & 0x0401) {
+        msleep(1);
+    }
+
+    for (int i = 0; i < stream_count; i++) {
+        stream_rec_t* item = &stream_items[i];
+        if (!watch || (stream_board != Board)) {
+            // the watches of a replaced board were freed with it
+            if (item->watched && (stream_board == Board)) {
+                Board->EdgeUnwatch(item->index);
+            }
+            item->watched = 0;
+        }
+        if (watch && !item->watched && (item->kind == SK_PIN) && (item->index <= Board->MGetPinCount())) {
+            item->pos = Board->EdgeWatch(item->index);
+            item->watched = 1;
+        }
+    }
+    stream_board = Board;
+
+    if (!di) {
+        PICSimLab.status.st[0] &= ~ST_DI;
+    }
+}
+
+// parse a subscription index "NN]", returns -1 if it is not a number from min to 255
+static int stream_index(const char* str, const int min) {
+    char* end;
+    const long val = strtol(str, &end, 10);
+    if ((end == str) || (*end != ']') || (val < min) || (val > 255)) {
+        return -1;
+    }
+    return val;
+}
+
+// subscribe "pins", "pin[NN]", "apin[NN]", "board.out[NN]" or "part[NN].out[NN]"
+static int stream_add(const char* obj) {
+    stream_rec_t item;
+    float value;
+    const char* ptr;
+    int index = -1;
+    int part = 0;
+
+    memset(&item, 0, sizeof(item));
+
+    if (!strcmp(obj, "pins")) {
+        board* Board = PICSimLab.GetBoard();
+        for (int i = 1; (i <= Board->MGetPinCount()) && (stream_count < STREAM_MAX); i++) {
+            item.kind = SK_PIN;
+            item.index = i;
+            stream_items[stream_count++] = item;
+        }
+        stream_watch(1);
+        return 1;
+    } else if (!strncmp(obj, "pin[", 4)) {
+        item.kind = SK_PIN;
+        index = stream_index(obj + 4, 1);
+    } else if (!strncmp(obj, "apin[", 5)) {
+        item.kind = SK_APIN;
+        index = stream_index(obj + 5, 1);
+    } else if (!strncmp(obj, "board.out[", 10)) {
+        item.kind = SK_BOARD_OUT;
+        index = stream_index(obj + 10, 0);
+    } else if ((!strncmp(obj, "part[", 5)) && (ptr = strstr(obj, "].out["))) {
+        item.kind = SK_PART_OUT;
+        part = stream_index(obj + 5, 0);
+        index = stream_index(ptr + 6, 0);
+    } else {
+        return 0;
+    }
+
+    if ((index < 0) || (part < 0)) {
+        return 0;
+    }
+    item.part = part;
+    item.index = index;
+
+    if ((stream_count >= STREAM_MAX) || (!stream_value(&item, &value))) {
+        return 0;
+    }
+    stream_items[stream_count++] = item;
+    if (item.kind == SK_PIN) {
+        stream_watch(1);
+    }
+    return 1;
+}
+
+// change records are sent in frames of up to STREAM_CHG_MAX records
+#define STREAM_CHG_MAX (FRAME_MAX / sizeof(stream_chg_t))
+
+static int stream_record(stream_chg_t* chg, int* count, const stream_rec_t* item, const uint32_t time) {
+    stream_chg_t* rec = &chg[(*count)++];
+    rec->time = time;
+    rec->kind = item->kind;
+    rec->part = item->part;
+    rec->index = item->index;
+    rec->dir = item->dir;
+    rec->value = item->value;
+    if (*count == (int)STREAM_CHG_MAX) {
+        *count = 0;
+        return sendframe(FRAME_CHANGES, chg, STREAM_CHG_MAX * sizeof(stream_chg_t));
+    }
+    return 0;
+}
+
+// send the subscribed values changed since the last call, the board pins with the InstCounter of each edge and the
+// other objects with the InstCounter at the end of the slice
+static int stream_send(const int all) {
+    static stream_chg_t chg[STREAM_CHG_MAX];
+    board* Board = PICSimLab.GetBoard();
+    const uint32_t now = Board->GetInstCounter();
+    int count = 0;
+    int ret = 0;
+
+    if (stream_board != Board) {
+        stream_watch(1);
+    }
+
+    for (int i = 0; (i < stream_count) && !ret; i++) {
+        stream_rec_t* item = &stream_items[i];
+        const unsigned char dir = item->dir;
+        float value;
+        int changed = 0;
+
+        if (item->watched) {
+            pin_edge_t edges[16];
+            int n;
+            while (((n = Board->EdgeRead(item->index, &item->pos, edges, 16)) > 0) && !ret) {
+                for (int e = 0; (e < n) && !ret; e++) {
+                    item->value = edges[e].value;
+                    ret |= stream_record(chg, &count, item, edges[e].time);
+                    changed = 1;
+                }
+            }
+        }
+
+        if (stream_value(item, &value) && !changed && (all || (value != item->value) || (dir != item->dir))) {
+            item->value = value;
+            ret |= stream_record(chg, &count, item, now);
+        }
+    }
+
+    if (count && !ret) {
+        ret = sendframe(FRAME_CHANGES, chg, count * sizeof(stream_chg_t));
+    }
+    return ret;
+}
+
 int rcontrol_loop(void) {
     int i, j;
     int n;
@@ -425,6 +710,15 @@ int rcontrol_loop(void) {
         return rcontrol_start();
     }
 
+    // push changes once per Run_CPU slice
+    if (stream_on && (stream_slice != PICSimLab.GetSliceCount())) {
+        stream_slice = PICSimLab.GetSliceCount();
+        if (stream_send(0)) {
+            rcontrol_stop();
+            return 1;
+        }
+    }
+
     n = recv(sockfd, (char*)&buffer[bp], 1024 - bp, 0);
 
     if (n > 0) {
@@ -799,10 +1093,17 @@ int rcontrol_loop(void) {
                         ret += sendtext("  quit         - exit remote control interface\r\n");
                         ret += sendtext("  reset        - reset the board\r\n");
                         ret += sendtext("  set ob vl    - set object with value\r\n");
+                        ret += sendtext("  snapload file- restore simulation state from snapshot file\r\n");
+                        ret += sendtext("  snapsave file- save simulation state to snapshot file\r\n");
+                        ret += sendtext(
+                            "  stream [cmd] - binary push of object changes: stream ob (pins, pin[n], apin[n],\r\n"
+                            "                 board.out[n], part[n].out[n]) to subscribe, start, stop or clear\r\n");
                         ret += sendtext(
                             "  sim [cmd]    - show simulation status or execute "
                             "cmd start/stop\r\n");
-                        ret += sendtext("  sync         - wait to syncronize with timer event\r\n");
+                        ret += sendtext(
+                            "  sync [n]     - wait to syncronize with timer event, n slices or n[ms|s] of "
+                            "simulated time\r\n");
                         ret += sendtext("  version      - show PICSimLab version\r\n");
 
                         ret += sendtext("Ok\r\n>");
@@ -1079,13 +1380,79 @@ int rcontrol_loop(void) {
                             }
                         }
 
-                    } else if (!strcmp(cmd, "sync")) {
+                    } else if (!strncmp(cmd, "stream ", 7)) {
+                        // Command stream ==================================================
+                        if (!strcmp(cmd + 7, "start")) {
+                            ret = sendtext("Ok\r\n>");
+                            stream_on = 1;
+                            stream_slice = PICSimLab.GetSliceCount();
+                            ret += stream_send(1);
+                        } else if (!strcmp(cmd + 7, "stop")) {
+                            stream_on = 0;
+                            ret = sendtext("Ok\r\n>");
+                        } else if (!strcmp(cmd + 7, "clear")) {
+                            stream_watch(0);
+                            stream_count = 0;
+                            ret = sendtext("Ok\r\n>");
+                        } else if (stream_add(cmd + 7)) {
+                            ret = sendtext("Ok\r\n>");
+                        } else {
+                            ret = sendtext("ERROR\r\n>");
+                        }
+                    } else if (!strncmp(cmd, "sync", 4)) {
                         // Command sync =====================================================
-                        PICSimLab.SetSync(0);
-                        while (!PICSimLab.GetSync()) {
-                            usleep(1);  // FIXME avoid use of usleep to reduce cpu usage
+                        int aborted;
+                        if (cmd[4] == 0) {
+                            // next timer event
+                            aborted = PICSimLab.WaitSync(1, 0);
+                        } else if (cmd[4] == ' ') {
+                            char* end;
+                            double val = strtod(cmd + 5, &end);
+                            double count = -1;
+                            if (end == (cmd + 5)) {
+                                // no number
+                            } else if (!strcmp(end, "ms")) {
+                                count = ceil(val / BASETIMER);
+                            } else if (!strcmp(end, "s")) {
+                                count = ceil(val * 1000.0 / BASETIMER);
+                            } else if (!end[0]) {
+                                count = floor(val);
+                            }
+                            if ((val > 0) && (count >= 1) && (count <= UINT_MAX)) {
+                                // N Run_CPU slices of BASETIMER ms of simulated time
+                                aborted = PICSimLab.WaitSync((unsigned int)count, 1);
+                            } else {
+                                aborted = 1;
+                            }
+                        } else {
+                            aborted = 1;
+                        }
+                        if (aborted) {
+                            ret = sendtext("ERROR\r\n>");
+                        } else {
+                            ret = sendtext("Ok\r\n>");
+                        }
+                    } else if (!strncmp(cmd, "snapsave ", 9) || !strncmp(cmd, "snapload ", 9)) {
+                        // Command snapsave/snapload
+                        // ========================================================
+                        char* ptr;
+                        if ((ptr = strchr(cmd, '\r'))) {
+                            ptr[0] = 0;
+                        }
+                        if ((ptr = strchr(cmd, '\n'))) {
+                            ptr[0] = 0;
+                        }
+                        int err;
+                        if (cmd[4] == 's') {
+                            err = PICSimLab.SaveSnapshot(cmd + 9);
+                        } else {
+                            err = PICSimLab.LoadSnapshot(cmd + 9);
+                        }
+                        if (err) {
+                            ret += sendtext("ERROR\r\n>");
+                        } else {
+                            ret += sendtext("Ok\r\n>");
                         }
-                        ret = sendtext("Ok\r\n>");
                     } else {
                         ret = sendtext("ERROR\r\n>");
                     }
@@ -38,6 +38,7 @@
 #include <windows.h>
 #else
 #include <glob.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <termios.h>
 #endif
@@ -457,3 +458,164 @@ char* serial_port_list(void) {
 
     return resp;
 }
+
+// buffered serial port ====================================================
+
+void serial_port_buff_init(serial_port_buff_t* sb) {
+    memset(sb, 0, sizeof(serial_port_buff_t));
+    sb->serialfd = INVALID_SERIAL;
+}
+
+#ifdef SERIAL_PORT_THREAD
+#ifdef _WIN_
+static DWORD WINAPI serial_port_buff_thread(LPVOID arg) {
+#else
+static void* serial_port_buff_thread(void* arg) {
+#endif
+    serial_port_buff_t* sb = (serial_port_buff_t*)arg;
+
+    while (__atomic_load_n(&sb->running, __ATOMIC_ACQUIRE)) {
+        // free contiguous space in rx and pending contiguous data in tx
+        unsigned int rx_head = sb->rx.head;
+        unsigned int rx_len = SERIAL_BUFF_SIZE - (rx_head - __atomic_load_n(&sb->rx.tail, __ATOMIC_ACQUIRE));
+        if (rx_len > (SERIAL_BUFF_SIZE - (rx_head & SERIAL_BUFF_MASK))) {
+            rx_len = SERIAL_BUFF_SIZE - (rx_head & SERIAL_BUFF_MASK);
+        }
+        unsigned int tx_tail = sb->tx.tail;
+        unsigned int tx_len = __atomic_load_n(&sb->tx.head, __ATOMIC_ACQUIRE) - tx_tail;
+        if (tx_len > (SERIAL_BUFF_SIZE - (tx_tail & SERIAL_BUFF_MASK))) {
+            tx_len = SERIAL_BUFF_SIZE - (tx_tail & SERIAL_BUFF_MASK);
+        }
+
+#ifdef _WIN_
+        DWORD nbytes;
+        int idle = 1;
+
+        if (rx_len && ReadFile(sb->serialfd, &sb->rx.data[rx_head & SERIAL_BUFF_MASK], rx_len, &nbytes, NULL) &&
+            nbytes) {
+            __atomic_store_n(&sb->rx.head, rx_head + nbytes, __ATOMIC_RELEASE);
+            idle = 0;
+        }
+        if (tx_len && WriteFile(sb->serialfd, &sb->tx.data[tx_tail & SERIAL_BUFF_MASK], tx_len, &nbytes, NULL) &&
+            nbytes) {
+            __atomic_store_n(&sb->tx.tail, tx_tail + nbytes, __ATOMIC_RELEASE);
+            idle = 0;
+        }
+
+        long unsigned int state = 0;
+        GetCommModemStatus(sb->serialfd, &state);
+        __atomic_store_n(&sb->dsr, (int)(state & MS_DSR_ON), __ATOMIC_RELAXED);
+
+        if (idle) {
+            Sleep(1);
+        }
+#else
+        struct pollfd pfd;
+        long nbytes;
+
+        pfd.fd = sb->serialfd;
+        pfd.events = (rx_len ? POLLIN : 0) | (tx_len ? POLLOUT : 0);
+        pfd.revents = 0;
+
+        // 1ms timeout bounds the latency of bytes queued while waiting
+        if (poll(&pfd, 1, 1) > 0) {
+            if ((pfd.revents & POLLIN) &&
+                ((nbytes = read(sb->serialfd, &sb->rx.data[rx_head & SERIAL_BUFF_MASK], rx_len)) > 0)) {
+                __atomic_store_n(&sb->rx.head, rx_head + nbytes, __ATOMIC_RELEASE);
+            }
+            if ((pfd.revents & POLLOUT) &&
+                ((nbytes = write(sb->serialfd, &sb->tx.data[tx_tail & SERIAL_BUFF_MASK], tx_len)) > 0)) {
+                __atomic_store_n(&sb->tx.tail, tx_tail + nbytes, __ATOMIC_RELEASE);
+            }
+            if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                usleep(1000);  // peer closed, avoid spinning
+            }
+        }
+
+        int state = 0;
+        ioctl(sb->serialfd, TIOCMGET, &state);
+        __atomic_store_n(&sb->dsr, state & TIOCM_DSR, __ATOMIC_RELAXED);
+#endif
+    }
+    return 0;
+}
+#endif
+
+int serial_port_buff_start(serial_port_buff_t* sb, serialfd_t serialfd) {
+    serial_port_buff_stop(sb);
+
+    sb->serialfd = serialfd;
+    sb->rx.head = sb->rx.tail = 0;
+    sb->tx.head = sb->tx.tail = 0;
+    sb->dsr = 0;
+
+    if (serialfd == INVALID_SERIAL) {
+        return 0;
+    }
+
+#ifdef SERIAL_PORT_THREAD
+    sb->running = 1;
+#ifdef _WIN_
+    sb->thread = CreateThread(NULL, 0, serial_port_buff_thread, sb, 0, NULL);
+    if (sb->thread == NULL) {
+        sb->running = 0;
+    }
+#else
+    if (pthread_create(&sb->thread, NULL, serial_port_buff_thread, sb)) {
+        sb->running = 0;
+    }
+#endif
+#endif
+    // without the I/O thread send/rec fall back to direct port access
+    return sb->running;
+}
+
+void serial_port_buff_stop(serial_port_buff_t* sb) {
+#ifdef SERIAL_PORT_THREAD
+    if (sb->running) {
+        __atomic_store_n(&sb->running, 0, __ATOMIC_RELEASE);
+#ifdef _WIN_
+        WaitForSingleObject(sb->thread, INFINITE);
+        CloseHandle(sb->thread);
+#else
+        pthread_join(sb->thread, NULL);
+#endif
+    }
+#endif
+    sb->serialfd = INVALID_SERIAL;
+}
+
+unsigned long serial_port_buff_send(serial_port_buff_t* sb, unsigned char c) {
+    if (!sb->running) {
+        return serial_port_send(sb->serialfd, c);
+    }
+
+    unsigned int head = sb->tx.head;
+    if ((head - __atomic_load_n(&sb->tx.tail, __ATOMIC_ACQUIRE)) >= SERIAL_BUFF_SIZE) {
+        return 0;  // full, drop like a non blocking write
+    }
+    sb->tx.data[head & SERIAL_BUFF_MASK] = c;
+    __atomic_store_n(&sb->tx.head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+unsigned long serial_port_buff_rec(serial_port_buff_t* sb, unsigned char* c) {
+    if (!sb->running) {
+        return serial_port_rec(sb->serialfd, c);
+    }
+
+    unsigned int tail = sb->rx.tail;
+    if (tail == __atomic_load_n(&sb->rx.head, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    *c = sb->rx.data[tail & SERIAL_BUFF_MASK];
+    __atomic_store_n(&sb->rx.tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+int serial_port_buff_get_dsr(serial_port_buff_t* sb) {
+    if (!sb->running) {
+        return serial_port_get_dsr(sb->serialfd);
+    }
+    return __atomic_load_n(&sb->dsr, __ATOMIC_RELAXED);
+}
@@ -35,6 +35,46 @@
 #define INVALID_SERIAL -1
 #endif
 
+#if !defined(__EMSCRIPTEN__)
+#define SERIAL_PORT_THREAD
+#ifndef _WIN_
+#include <pthread.h>
+#endif
+#endif
+
+#define SERIAL_BUFF_SIZE 4096  // must be a power of 2
+#define SERIAL_BUFF_MASK (SERIAL_BUFF_SIZE - 1)
+
+/**
+ * @brief Single producer single consumer byte ring
+ */
+typedef struct {
+    unsigned char data[SERIAL_BUFF_SIZE];
+    unsigned int head;  ///< written only by the producer
+    unsigned int tail;  ///< written only by the consumer
+} serial_ring_t;
+
+/**
+ * @brief Serial port serviced by a background I/O thread
+ *
+ * The I/O thread drains the port into rx and writes tx to the port, so the
+ * simulation thread only touches memory on serial_port_buff_send/rec.
+ */
+typedef struct {
+    serialfd_t serialfd;
+    serial_ring_t rx;
+    serial_ring_t tx;
+    int dsr;      ///< last DSR state read by the I/O thread
+    int running;  ///< cleared to stop the I/O thread
+#ifdef SERIAL_PORT_THREAD
+#ifdef _WIN_
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+#endif
+} serial_port_buff_t;
+
 unsigned long serial_port_send(serialfd_t serialfd, unsigned char c);
 unsigned long serial_port_rec(serialfd_t serialfd, unsigned char* c);
 int serial_port_get_dsr(serialfd_t serialfd);
@@ -43,4 +83,11 @@ int serial_port_cfg(serialfd_t serialfd, float serialexbaud);
 int serial_port_close(serialfd_t* serialfd);
 char* serial_port_list(void);
 
+void serial_port_buff_init(serial_port_buff_t* sb);
+int serial_port_buff_start(serial_port_buff_t* sb, serialfd_t serialfd);
+void serial_port_buff_stop(serial_port_buff_t* sb);
+unsigned long serial_port_buff_send(serial_port_buff_t* sb, unsigned char c);
+unsigned long serial_port_buff_rec(serial_port_buff_t* sb, unsigned char* c);
+int serial_port_buff_get_dsr(serial_port_buff_t* sb);
+
 #endif /* SERIAL_PORT_H */
@@ -36,11 +36,15 @@ CSpareParts::CSpareParts() {
     pboard = NULL;
     partsc = 0;
     partsc_aup = 0;
+    parts_sens_valid = 0;
+    pullup_bus_regs = 0;
+    i2c_busesc = 0;
     useAlias = 0;
     alias_fname = "";
     scale = 1.0;
     LoadConfigFile = "";
     fdtype = -1;
+    imagesc = 0;
 
     PropButtonRelease = NULL;
     PropComboChange = NULL;
@@ -83,6 +87,7 @@ part* CSpareParts::AddPart(const char* partname, const int x, const int y, const
         parts[partsc]->SetScale(scale);
         parts[partsc]->Reset();
         partsc++;
+        parts_sens_valid = 0;
     }
 
     return newpart;
@@ -92,11 +97,51 @@ void CSpareParts::DeleteParts(void) {
     int partsc_ = partsc;
     partsc = 0;  // for disable process
     partsc_aup = 0;
+    parts_sens_valid = 0;
     useAlias = 0;
 
     for (int i = 0; i < partsc_; i++) {
         delete parts[i];
     }
+
+    ClearImageCache();
+}
+
+lxBitmap* CSpareParts::GetImage(const lxString fname, const int orientation, const float scale) {
+    if (!Window) {
+        return NULL;
+    }
+
+    for (int i = 0; i < imagesc; i++) {
+        if ((images[i].orientation == orientation) && (images[i].scale == scale) && (images[i].fname == fname)) {
+            return images[i].bitmap;
+        }
+    }
+
+    lxImage image(Window);
+    if (!image.LoadFile(fname, orientation, scale, scale)) {
+        return NULL;
+    }
+
+    if (imagesc == MAX_IMAGES) {
+        ClearImageCache();
+    }
+
+    images[imagesc].fname = fname;
+    images[imagesc].orientation = orientation;
+    images[imagesc].scale = scale;
+    images[imagesc].bitmap = new lxBitmap(&image, Window);
+    image.Destroy();
+
+    return images[imagesc++].bitmap;
+}
+
+void CSpareParts::ClearImageCache(void) {
+    for (int i = 0; i < imagesc; i++) {
+        delete images[i].bitmap;
+        images[i].bitmap = NULL;
+    }
+    imagesc = 0;
 }
 
 void CSpareParts::ClearPinAlias(void) {
@@ -108,6 +153,7 @@ void CSpareParts::ClearPinAlias(void) {
 void CSpareParts::ResetPullupBus(unsigned char pin) {
     if (pin < IOINIT) {
         pullup_bus[pin]++;  // count i2c devices in bus
+        pullup_bus_regs++;
     }
 }
 
@@ -124,6 +170,82 @@ unsigned char CSpareParts::GetPullupBus(unsigned char pin) {
         return 0;
 }
 
+i2c_bus_t* CSpareParts::GetI2CBus(const unsigned char scl_pin, const unsigned char sda_pin) {
+    if (!scl_pin || !sda_pin) {
+        return NULL;
+    }
+
+    int free = -1;
+    for (int i = 0; i < i2c_busesc; i++) {
+        if ((i2c_buses_pins[i][0] == scl_pin) && (i2c_buses_pins[i][1] == sda_pin)) {
+            return &i2c_buses[i];
+        }
+        if ((free < 0) && (i2c_buses[i].devc == 0)) {
+            free = i;  // nobody holds an empty bus, it can move to other pins
+        }
+    }
+
+    if (free < 0) {
+        if (i2c_busesc >= MAX_PARTS) {
+            return NULL;
+        }
+        free = i2c_busesc++;
+    }
+
+    i2c_buses_pins[free][0] = scl_pin;
+    i2c_buses_pins[free][1] = sda_pin;
+    i2c_bus_init(&i2c_buses[free]);
+    return &i2c_buses[free];
+}
+
+i2c_bus_t* CSpareParts::FindI2CBus(const unsigned char scl_pin, const unsigned char sda_pin) {
+    i2c_bus_t* bus = NULL;
+
+    for (int i = 0; i < i2c_busesc; i++) {
+        if ((i2c_buses_pins[i][0] == scl_pin) && (i2c_buses_pins[i][1] == sda_pin) && i2c_buses[i].devc) {
+            bus = &i2c_buses[i];
+            break;
+        }
+    }
+
+    if (!bus) {
+        return NULL;
+    }
+
+    if (pboard->EdgeWatched(scl_pin) || pboard->EdgeWatched(sda_pin)) {
+        return NULL;
+    }
+
+    if (pboard->GetUseOscilloscope()) {
+        for (int c = 0; c < OSC_MAX_CHANNELS; c++) {
+            const int pin = Oscilloscope.GetChannelPin(c) + 1;
+            if ((pin == scl_pin) || (pin == sda_pin)) {
+                return NULL;
+            }
+        }
+    }
+
+    // parts on the pins besides the attached devices watch the line
+    int users = 0;
+    for (int i = 0; i < partsc; i++) {
+        const unsigned char* ppins = parts[i]->GetPins();
+        const unsigned char* cpins = parts[i]->GetPinsCtrl();
+        int use = 0;
+        for (int p = 0; p < parts[i]->GetPinCount(); p++) {
+            use |= (ppins[p] == scl_pin) || (ppins[p] == sda_pin);
+        }
+        for (int p = 0; p < parts[i]->GetPinCtrlCount(); p++) {
+            use |= (cpins[p] == scl_pin) || (cpins[p] == sda_pin);
+        }
+        users += use;
+    }
+    if (users > bus->devc) {
+        return NULL;
+    }
+
+    return bus;
+}
+
 lxString CSpareParts::GetPinsNames(void) {
     lxString Items = "0  NC,";
     lxString spin;
@@ -172,6 +294,13 @@ lxString CSpareParts::GetPinName(unsigned char pin) {
     }
 }
 
+bool CSpareParts::IsValidPin(const unsigned char pin) {
+    if ((!pin) || (!pboard))
+        return false;
+
+    return (PinNames[pin].length() > 0) && PinNames[pin].Cmp(lxT("error"));
+}
+
 const picpin* CSpareParts::GetPinsValues(void) {
     return Pins;
 }
@@ -188,6 +317,7 @@ void CSpareParts::SetPin(unsigned char pin, unsigned char value) {
             } else {
                 pboard->MSetPin(pin, value);
             }
+            pboard->ioupdated_pin(pin);
         }
     }
 }
@@ -209,6 +339,7 @@ void CSpareParts::SetPinDir(unsigned char pin, unsigned char dir) {
         if (Pins[pin - 1].dir != dir) {
             if ((pin > PinsCount)) {
                 Pins[pin - 1].dir = dir;
+                pboard->ioupdated_pin(pin);
             }
         }
     }
@@ -217,7 +348,10 @@ void CSpareParts::SetPinDir(unsigned char pin, unsigned char dir) {
 void CSpareParts::WritePin(unsigned char pin, unsigned char value) {
     if (pin > PinsCount) {
         Pins[pin - 1].lsvalue = value;  // for open collector simulation
-        Pins[pin - 1].value = value;
+        if (Pins[pin - 1].value != value) {
+            Pins[pin - 1].value = value;
+            pboard->ioupdated_pin(pin);
+        }
     }
 }
 
@@ -520,6 +654,7 @@ void CSpareParts::DeletePart(const int partn) {
     int partsc_ = partsc;
     partsc = 0;  // disable process
     partsc_aup = 0;
+    parts_sens_valid = 0;
 
     delete parts[partn];
 
@@ -531,19 +666,46 @@ void CSpareParts::DeletePart(const int partn) {
     partsc = partsc_;
 }
 
+void CSpareParts::UpdateSensitivity(const int partn, const int pullup_regs) {
+    part* p = parts[partn];
+
+    memset(parts_sens[partn], 0, sizeof(parts_sens[partn]));
+
+    // parts without pins list, bus devices and always update parts are processed on every io update
+    parts_sens_all[partn] = (p->GetPinCount() == 0) || (pullup_regs != pullup_bus_regs) || p->GetAlwaysUpdate();
+
+    const unsigned char* ppins = p->GetPins();
+    for (int i = 0; i < p->GetPinCount(); i++) {
+        if (ppins[i]) {
+            parts_sens[partn][ppins[i] >> 5] |= 1U << (ppins[i] & 0x1F);
+        }
+    }
+
+    ppins = p->GetPinsCtrl();
+    for (int i = 0; i < p->GetPinCtrlCount(); i++) {
+        if (ppins[i]) {
+            parts_sens[partn][ppins[i] >> 5] |= 1U << (ppins[i] & 0x1F);
+        }
+    }
+}
+
 void CSpareParts::PreProcess(void) {
     int i;
 
     memset(pullup_bus, 0, PinsCount);
 
     partsc_aup = 0;
+    pullup_bus_regs = 0;
     for (i = 0; i < partsc; i++) {
+        int pullup_regs = pullup_bus_regs;
         parts[i]->PreProcess();
         if (parts[i]->GetAlwaysUpdate()) {
             parts_aup[partsc_aup] = parts[i];
             partsc_aup++;
         }
+        UpdateSensitivity(i, pullup_regs);
     }
+    parts_sens_valid = 1;
 
     pullup_bus_count = 0;
     for (i = 0; i < PinsCount; i++) {
@@ -559,12 +721,33 @@ void CSpareParts::PreProcess(void) {
 void CSpareParts::Process(void) {
     int i;
 
-    if (ioupdated) {
+    if (pboard->ioupdated) {
         for (i = 0; i < pullup_bus_count; i++) {
             pullup_bus[pullup_bus_ptr[i]] = 1;
         }
-        for (i = 0; i < partsc; i++) {
-            parts[i]->Process();
+        if ((pboard->ioupdated == IOUPDATED_PINS) && parts_sens_valid) {
+            // only process the parts connected to changed pins
+            uint32_t changed[IOUPDATED_WORDS];
+            memcpy(changed, pboard->ioupdated_pins, sizeof(changed));
+            memset(pboard->ioupdated_pins, 0, sizeof(pboard->ioupdated_pins));
+            for (i = 0; i < partsc; i++) {
+                if (!parts_sens_all[i]) {
+                    uint32_t match = 0;
+                    for (int w = 0; w < IOUPDATED_WORDS; w++) {
+                        // pins changed by previous parts in this loop are kept in ioupdated_pins
+                        match |= (changed[w] | pboard->ioupdated_pins[w]) & parts_sens[i][w];
+                    }
+                    if (!match) {
+                        continue;
+                    }
+                }
+                parts[i]->Process();
+            }
+        } else {
+            memset(pboard->ioupdated_pins, 0, sizeof(pboard->ioupdated_pins));
+            for (i = 0; i < partsc; i++) {
+                parts[i]->Process();
+            }
         }
         for (i = 0; i < pullup_bus_count; i++) {
             SetPin(pullup_bus_ptr[i] + 1, pullup_bus[pullup_bus_ptr[i]]);
@@ -588,6 +771,9 @@ void CSpareParts::Reset(void) {
         parts[i]->Reset();
         parts[i]->SetUpdate(1);
     }
+    for (int i = 0; i < i2c_busesc; i++) {
+        i2c_bus_rst(&i2c_buses[i]);
+    }
 }
 
 void CSpareParts::ReadPreferences(char* name, char* value) {
@@ -26,10 +26,23 @@
 #ifndef SPAREPARTS
 #define SPAREPARTS
 
+#include "../devices/i2c_bus.h"
 #include "../lib/part.h"
 
 #define IOINIT 110
 
+#define MAX_IMAGES (4 * MAX_PARTS)
+
+/**
+ * @brief rasterized image shared by the parts
+ */
+typedef struct {
+    lxString fname;
+    int orientation;
+    float scale;
+    lxBitmap* bitmap;
+} image_cache_t;
+
 class CSpareParts {
 public:
     CSpareParts();
@@ -44,6 +57,50 @@ public:
     void SetPullupBus(unsigned char pin, unsigned char value);
     unsigned char GetPullupBus(unsigned char pin);
 
+    /**
+     * @brief  Return the I2C bus shared by the parts on the scl and sda pins, created on the first use
+     */
+    i2c_bus_t* GetI2CBus(const unsigned char scl_pin, const unsigned char sda_pin);
+
+    /**
+     * @brief  Move the I2C device of a part to the bus on the scl and sda pins, return the bus in use
+     *
+     * bus is the bus the device is attached to (NULL if none). The device is detached from it and attached to
+     * the new bus with its attach function when the pins change. A pin 0 leaves the device detached.
+     */
+    template <typename T>
+    i2c_bus_t* AttachI2C(i2c_bus_t* bus, const unsigned char scl_pin, const unsigned char sda_pin, T* dev,
+                         void (*attach)(T*, i2c_bus_t*)) {
+        i2c_bus_t* nbus = GetI2CBus(scl_pin, sda_pin);
+        if (nbus != bus) {
+            if (bus) {
+                i2c_bus_detach(bus, &dev->bb_i2c);
+            }
+            if (nbus) {
+                attach(dev, nbus);
+            }
+        }
+        return nbus;
+    }
+
+    /**
+     * @brief  Detach the I2C device of a part from its bus, if any
+     */
+    template <typename T>
+    void DetachI2C(i2c_bus_t* bus, T* dev) {
+        if (bus) {
+            i2c_bus_detach(bus, &dev->bb_i2c);
+        }
+    }
+
+    /**
+     * @brief  Return the I2C bus on the scl and sda pins if a master can send whole transfers to it, NULL otherwise
+     *
+     * The pins don't toggle in these transfers, so the bus is only returned when it has some device attached and
+     * the pins are not observed by other parts, the oscilloscope or the board edge log.
+     */
+    i2c_bus_t* FindI2CBus(const unsigned char scl_pin, const unsigned char sda_pin);
+
     /**
      * @brief  Execute the process code of spare parts N times (where N is the number of steps in 100ms)
      */
@@ -69,7 +126,17 @@ public:
      */
     lxString GetPinName(unsigned char pin);
 
+    /**
+     * @brief  Return true if pin is a board pin or a registered IO pin
+     */
+    bool IsValidPin(const unsigned char pin);
+
     const picpin* GetPinsValues(void);
+
+    /**
+     * @brief  Return the number of parts processed on every clock cycle
+     */
+    int GetAlwaysUpdateCount(void) { return partsc_aup; };
     void SetPin(unsigned char pin, unsigned char value);
     void SetAPin(unsigned char pin, float value);
     void SetPinDOV(unsigned char pin, unsigned char ovalue);
@@ -89,8 +156,26 @@ public:
     void ClearPinAlias(void);
     lxString GetAliasFname(void) { return alias_fname; };
     float GetScale(void) { return scale; };
-    void SetScale(float s) { scale = s; };
+    void SetScale(float s) {
+        if (s != scale) {
+            ClearImageCache();  // images of the old scale are not used anymore
+        }
+        scale = s;
+    };
     CWindow* GetWindow(void) { return Window; }
+
+    /**
+     * @brief  Return the image file rasterized with orientation and scale, NULL on error
+     *
+     * The bitmap is shared by all parts and owned by the cache, it must not be drawn over or deleted. It is only
+     * valid until the next GetImage call, that can clear a full cache.
+     */
+    lxBitmap* GetImage(const lxString fname, const int orientation, const float scale);
+
+    /**
+     * @brief  Free all cached images
+     */
+    void ClearImageCache(void);
     CFileDialog* GetFileDialog(void) { return filedialog; }
     void Reset(void);
 
@@ -134,13 +219,27 @@ private:
     unsigned char useAlias;
     int partsc;
     part* parts[MAX_PARTS];
-    int partsc_aup;              // always update list
-    part* parts_aup[MAX_PARTS];  // always update list
+    int partsc_aup;                                   // always update list
+    part* parts_aup[MAX_PARTS];                       // always update list
+    unsigned char parts_sens_all[MAX_PARTS];          // parts processed on every io update
+    uint32_t parts_sens[MAX_PARTS][IOUPDATED_WORDS];  // pins watched by each part
+    int parts_sens_valid;
     unsigned char pullup_bus[IOINIT];
+    int pullup_bus_regs;
     int pullup_bus_count;
     unsigned char pullup_bus_ptr[IOINIT];
+    i2c_bus_t i2c_buses[MAX_PARTS];
+    unsigned char i2c_buses_pins[MAX_PARTS][2];  // scl and sda of each bus
+    int i2c_busesc;
     int fdtype;
     lxString oldfname;
+    image_cache_t images[MAX_IMAGES];
+    int imagesc;
+
+    /**
+     * @brief  Build the pins sensitivity list of one part
+     */
+    void UpdateSensitivity(const int partn, const int pullup_regs);
 };
 
 extern CSpareParts SpareParts;
@@ -0,0 +1,290 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "vcd_writer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+CVCDWriter::CVCDWriter(void) {
+    f_vcd = NULL;
+    buff[0] = NULL;
+    buff[1] = NULL;
+    used = 0;
+    cur = 0;
+    vtime = 0;
+    time_pending = 0;
+#ifdef VCD_WRITER_THREAD
+    running = 0;
+    pending = -1;
+    pending_len = 0;
+#endif
+}
+
+CVCDWriter::~CVCDWriter(void) {
+    Close();
+}
+
+int CVCDWriter::Open(const char* fname, const char* scope, const int timescale_ps) {
+    Close();
+
+    f_vcd = fopen(fname, "w");
+    if (!f_vcd) {
+        return 0;
+    }
+
+    buff[0] = (char*)malloc(VCD_BUFF_SIZE);
+    buff[1] = (char*)malloc(VCD_BUFF_SIZE);
+    used = 0;
+    cur = 0;
+    vtime = (unsigned long)-1;
+    time_pending = 0;
+    ids.clear();
+    types.clear();
+
+#ifdef VCD_WRITER_THREAD
+    pending = -1;
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&cond, NULL);
+    running = 1;
+    if (pthread_create(&thread, NULL, WriterThread, this)) {
+        running = 0;  // write from the simulation thread
+    }
+#endif
+
+    char line[256];
+    snprintf(line, sizeof(line),
+             "$version Generated by PICSimLab $end\n"
+             "$timescale %ips $end\n"
+             "$scope module %s $end\n",
+             timescale_ps, scope);
+    Put(line, strlen(line));
+    return 1;
+}
+
+// identifiers use the printable ASCII range in base 94: ! $ ... ~ !! $! ...
+static std::string vcd_id(int n) {
+    std::string id;
+    do {
+        id += (char)('!' + (n % 94));
+        n /= 94;
+    } while (n);
+    return id;
+}
+
+int CVCDWriter::AddWire(const char* name) {
+    int ch = ids.size();
+    ids.push_back(vcd_id(ch));
+    types.push_back('w');
+
+    std::string line = "$var wire 1 " + ids[ch] + " " + name + " $end\n";
+    Put(line.c_str(), line.length());
+    return ch;
+}
+
+int CVCDWriter::AddReal(const char* name) {
+    int ch = ids.size();
+    ids.push_back(vcd_id(ch));
+    types.push_back('r');
+
+    std::string line = "$var real 32 " + ids[ch] + " " + name + " $end\n";
+    Put(line.c_str(), line.length());
+    return ch;
+}
+
+void CVCDWriter::EndDefinitions(void) {
+    static const char enddef[] =
+        "$upscope $end\n"
+        "$enddefinitions $end\n"
+        "$dumpvars\n";
+
+    Put(enddef, sizeof(enddef) - 1);
+    for (unsigned int i = 0; i < ids.size(); i++) {
+        if (types[i] == 'w') {
+            PutChar('x');
+            PutId(i);
+            PutChar('\n');
+        }
+    }
+    Put("$end\n", 5);
+}
+
+void CVCDWriter::Wire(const int channel, const unsigned char value) {
+    if (time_pending) {
+        PutTime();
+    }
+    PutChar('0' + (value & 1));
+    PutId(channel);
+    PutChar('\n');
+}
+
+void CVCDWriter::Real(const int channel, const float value) {
+    char str[32];
+
+    if (time_pending) {
+        PutTime();
+    }
+    int len = snprintf(str, sizeof(str), "r%f ", value);
+    Put(str, len);
+    PutId(channel);
+    PutChar('\n');
+}
+
+void CVCDWriter::PutTime(void) {
+    char str[24];
+    int pos = sizeof(str);
+    unsigned long t = vtime;
+
+    str[--pos] = '\n';
+    do {
+        str[--pos] = '0' + (t % 10);
+        t /= 10;
+    } while (t);
+    str[--pos] = '#';
+
+    time_pending = 0;
+    Put(str + pos, sizeof(str) - pos);
+}
+
+void CVCDWriter::PutId(const int channel) {
+    if (channel < 94) {
+        PutChar('!' + channel);
+    } else {
+        Put(ids[channel].c_str(), ids[channel].length());
+    }
+}
+
+void CVCDWriter::PutChar(const char c) {
+    if (used == VCD_BUFF_SIZE) {
+        Swap();
+    }
+    buff[cur][used++] = c;
+}
+
+void CVCDWriter::Put(const char* str, const unsigned int len) {
+    if ((used + len) > VCD_BUFF_SIZE) {
+        Swap();
+    }
+    memcpy(buff[cur] + used, str, len);
+    used += len;
+}
+
+void CVCDWriter::Write(const char* data, const unsigned int len) {
+    if (len) {
+        fwrite(data, 1, len, f_vcd);
+    }
+}
+
+// hands the current buffer to the writer and continues on the other one
+void CVCDWriter::Swap(void) {
+#ifdef VCD_WRITER_THREAD
+    if (running) {
+        pthread_mutex_lock(&lock);
+        while (pending >= 0) {
+            pthread_cond_wait(&cond, &lock);
+        }
+        pending = cur;
+        pending_len = used;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+    } else
+#endif
+    {
+        Write(buff[cur], used);
+    }
+    cur ^= 1;
+    used = 0;
+}
+
+#ifdef VCD_WRITER_THREAD
+void* CVCDWriter::WriterThread(void* arg) {
+    CVCDWriter* vcd = (CVCDWriter*)arg;
+
+    pthread_mutex_lock(&vcd->lock);
+    while (vcd->running || (vcd->pending >= 0)) {
+        if (vcd->pending < 0) {
+            pthread_cond_wait(&vcd->cond, &vcd->lock);
+            continue;
+        }
+        pthread_mutex_unlock(&vcd->lock);
+        vcd->Write(vcd->buff[vcd->pending], vcd->pending_len);
+        pthread_mutex_lock(&vcd->lock);
+        if (vcd->pending_len == 0) {
+            fflush(vcd->f_vcd);
+        }
+        vcd->pending = -1;
+        pthread_cond_broadcast(&vcd->cond);
+    }
+    pthread_mutex_unlock(&vcd->lock);
+    return NULL;
+}
+#endif
+
+void CVCDWriter::Flush(void) {
+    if (!f_vcd) {
+        return;
+    }
+
+    Swap();
+#ifdef VCD_WRITER_THREAD
+    if (running) {
+        // an empty buffer asks the writer to fflush, wait for it
+        Swap();
+        pthread_mutex_lock(&lock);
+        while (pending >= 0) {
+            pthread_cond_wait(&cond, &lock);
+        }
+        pthread_mutex_unlock(&lock);
+        return;
+    }
+#endif
+    fflush(f_vcd);
+}
+
+void CVCDWriter::Close(void) {
+    if (!f_vcd) {
+        return;
+    }
+
+    Swap();
+#ifdef VCD_WRITER_THREAD
+    if (running) {
+        pthread_mutex_lock(&lock);
+        running = 0;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+        pthread_join(thread, NULL);
+    }
+    pthread_mutex_destroy(&lock);
+    pthread_cond_destroy(&cond);
+#endif
+    fclose(f_vcd);
+    f_vcd = NULL;
+
+    free(buff[0]);
+    free(buff[1]);
+    buff[0] = NULL;
+    buff[1] = NULL;
+}
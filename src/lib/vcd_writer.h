@@ -0,0 +1,121 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef VCD_WRITER
+#define VCD_WRITER
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN_) && !defined(__EMSCRIPTEN__)
+#define VCD_WRITER_THREAD
+#include <pthread.h>
+#endif
+
+#define VCD_BUFF_SIZE (1 << 20)
+
+/**
+ * @brief Buffered VCD file writer
+ *
+ * Changes are appended to an in memory buffer. When it fills, the buffer is
+ * handed to a writer thread (or written directly where threads are not
+ * available) while recording continues in a second buffer.
+ */
+class CVCDWriter {
+public:
+    CVCDWriter(void);
+    ~CVCDWriter(void);
+
+    /**
+     * @brief Creates the file and starts the definitions section
+     */
+    int Open(const char* fname, const char* scope, const int timescale_ps);
+
+    /**
+     * @brief Adds a 1 bit wire variable and returns its channel number
+     */
+    int AddWire(const char* name);
+
+    /**
+     * @brief Adds a real variable and returns its channel number
+     */
+    int AddReal(const char* name);
+
+    /**
+     * @brief Ends the definitions section and dumps the initial values
+     */
+    void EndDefinitions(void);
+
+    /**
+     * @brief Sets the time of the following changes, written only if a change happens
+     */
+    void SetTime(const unsigned long time) {
+        if (time != vtime) {
+            vtime = time;
+            time_pending = 1;
+        }
+    };
+
+    void Wire(const int channel, const unsigned char value);
+    void Real(const int channel, const float value);
+
+    /**
+     * @brief Writes everything recorded so far to the file
+     */
+    void Flush(void);
+
+    void Close(void);
+
+    int IsOpen(void) { return f_vcd != NULL; };
+
+private:
+    void Put(const char* str, const unsigned int len);
+    void PutChar(const char c);
+    void PutId(const int channel);
+    void PutTime(void);
+    void Swap(void);
+    void Write(const char* data, const unsigned int len);
+
+    FILE* f_vcd;
+    std::vector<std::string> ids;
+    std::vector<char> types;
+    char* buff[2];
+    unsigned int used;
+    int cur;
+    unsigned long vtime;
+    int time_pending;
+#ifdef VCD_WRITER_THREAD
+    static void* WriterThread(void* arg);
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int running;
+    int pending;  // buffer index waiting to be written or -1
+    unsigned int pending_len;
+#endif
+};
+
+#endif  // VCD_WRITER
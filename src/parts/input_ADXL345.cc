@@ -46,6 +46,7 @@ cpart_ADXL345::cpart_ADXL345(const unsigned x, const unsigned y, const char* nam
       font(8, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD),
       font_p(7, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     adxl345_init(&adxl);
+    i2c_bus = NULL;
     adxl345_rst(&adxl);
 
     adxl_pins[0] = 0;
@@ -81,6 +82,7 @@ void cpart_ADXL345::RegisterRemoteControl(void) {
 }
 
 cpart_ADXL345::~cpart_ADXL345(void) {
+    SpareParts.DetachI2C(i2c_bus, &adxl);
     adxl345_end(&adxl);
     delete Bitmap;
     canvas.Destroy();
@@ -228,6 +230,9 @@ void cpart_ADXL345::PreProcess(void) {
             SpareParts.ResetPullupBus(adxl_pins[4] - 1);
         }
     }
+
+    // the SPI mode is latched, the bus only dispatches to the devices still in I2C mode
+    i2c_bus = SpareParts.AttachI2C(i2c_bus, adxl.i2c_mode ? adxl_pins[5] : 0, adxl_pins[4], &adxl, adxl345_attach_I2C);
 }
 
 void cpart_ADXL345::Process(void) {
@@ -235,8 +240,10 @@ void cpart_ADXL345::Process(void) {
 
     if ((adxl_pins[5]) && (adxl_pins[4]) && (adxl_pins[0])) {
         if ((adxl.i2c_mode) && (ppins[adxl_pins[0] - 1].value)) {  // I2C mode
-            SpareParts.SetPullupBus(
-                adxl_pins[4] - 1, adxl345_io_I2C(&adxl, ppins[adxl_pins[5] - 1].value, ppins[adxl_pins[4] - 1].value));
+            if (i2c_bus) {
+                SpareParts.SetPullupBus(adxl_pins[4] - 1, i2c_bus_io(i2c_bus, ppins[adxl_pins[5] - 1].value,
+                                                                     ppins[adxl_pins[4] - 1].value));
+            }
         } else {  // SPI mode
             unsigned char ret = adxl345_io_SPI(&adxl, ppins[adxl_pins[4] - 1].value, ppins[adxl_pins[5] - 1].value,
                                                ppins[adxl_pins[0] - 1].value);
@@ -59,6 +59,7 @@ private:
     void RegisterRemoteControl(void) override;
     unsigned char adxl_pins[6];
     adxl345_t adxl;
+    i2c_bus_t* i2c_bus;  // bus shared with the other parts on the same pins
     lxFont font;
     lxFont font_p;
     unsigned char active[3];
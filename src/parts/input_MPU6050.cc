@@ -46,6 +46,7 @@ cpart_MPU6050::cpart_MPU6050(const unsigned x, const unsigned y, const char* nam
       font(9, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD),
       font_p(7, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     mpu6050_init(&mpu);
+    i2c_bus = NULL;
     mpu6050_rst(&mpu);
 
     mpu_pins[0] = 0;
@@ -96,6 +97,7 @@ void cpart_MPU6050::RegisterRemoteControl(void) {
 }
 
 cpart_MPU6050::~cpart_MPU6050(void) {
+    SpareParts.DetachI2C(i2c_bus, &mpu);
     mpu6050_end(&mpu);
     delete Bitmap;
     canvas.Destroy();
@@ -278,14 +280,16 @@ void cpart_MPU6050::PreProcess(void) {
     if (mpu_pins[1] > 0) {
         SpareParts.ResetPullupBus(mpu_pins[1] - 1);
     }
+
+    i2c_bus = SpareParts.AttachI2C(i2c_bus, mpu_pins[0], mpu_pins[1], &mpu, mpu6050_attach_I2C);
 }
 
 void cpart_MPU6050::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((mpu_pins[0] > 0) && (mpu_pins[1] > 0))
+    if (i2c_bus && (mpu_pins[0] > 0) && (mpu_pins[1] > 0))
         SpareParts.SetPullupBus(mpu_pins[1] - 1,
-                                mpu6050_io_I2C(&mpu, ppins[mpu_pins[0] - 1].value, ppins[mpu_pins[1] - 1].value));
+                                i2c_bus_io(i2c_bus, ppins[mpu_pins[0] - 1].value, ppins[mpu_pins[1] - 1].value));
 }
 
 void cpart_MPU6050::PostProcess(void) {
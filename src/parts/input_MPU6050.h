@@ -58,6 +58,7 @@ private:
     void RegisterRemoteControl(void) override;
     unsigned char mpu_pins[6];
     mpu6050_t mpu;
+    i2c_bus_t* i2c_bus;  // bus shared with the other parts on the same pins
     lxFont font;
     lxFont font_p;
     unsigned char active[6];
@@ -48,6 +48,7 @@ cpart_bmp180::cpart_bmp180(const unsigned x, const unsigned y, const char* name,
       font(8, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD),
       font_p(6, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     sen_bmp180_init(&bmp180);
+    i2c_bus = NULL;
     sen_bmp180_rst(&bmp180);
 
     input_pins[0] = 0;
@@ -65,6 +66,7 @@ cpart_bmp180::cpart_bmp180(const unsigned x, const unsigned y, const char* name,
 }
 
 cpart_bmp180::~cpart_bmp180(void) {
+    SpareParts.DetachI2C(i2c_bus, &bmp180);
     sen_bmp180_end(&bmp180);
     delete Bitmap;
     canvas.Destroy();
@@ -162,14 +164,16 @@ void cpart_bmp180::PreProcess(void) {
         sen_bmp180_setPressTemp(&bmp180, (4.0 * (200 - values[0]) + 300), (0.625 * (200 - values[1]) - 40));
         SpareParts.ResetPullupBus(input_pins[1] - 1);
     }
+
+    i2c_bus = SpareParts.AttachI2C(i2c_bus, input_pins[0], input_pins[1], &bmp180, sen_bmp180_I2C_attach);
 }
 
 void cpart_bmp180::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((input_pins[0] > 0) && (input_pins[1] > 0))
-        SpareParts.SetPullupBus(input_pins[1] - 1, sen_bmp180_I2C_io(&bmp180, ppins[input_pins[0] - 1].value,
-                                                                     ppins[input_pins[1] - 1].value));
+    if (i2c_bus && (input_pins[0] > 0) && (input_pins[1] > 0))
+        SpareParts.SetPullupBus(input_pins[1] - 1, i2c_bus_io(i2c_bus, ppins[input_pins[0] - 1].value,
+                                                              ppins[input_pins[1] - 1].value));
 }
 
 void cpart_bmp180::OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) {
@@ -53,6 +53,7 @@ public:
 private:
     unsigned char input_pins[2];
     sen_bmp180_t bmp180;
+    i2c_bus_t* i2c_bus;  // bus shared with the other parts on the same pins
     unsigned char values[2];
     unsigned char active[2];
     lxFont font;
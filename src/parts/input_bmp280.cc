@@ -46,6 +46,7 @@ cpart_bmp280::cpart_bmp280(const unsigned x, const unsigned y, const char* name,
       font(8, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD),
       font_p(6, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     sen_bmp280_init(&bmp280);
+    i2c_bus = NULL;
     sen_bmp280_rst(&bmp280);
 
     input_pins[0] = 0;
@@ -66,6 +67,7 @@ cpart_bmp280::cpart_bmp280(const unsigned x, const unsigned y, const char* name,
 }
 
 cpart_bmp280::~cpart_bmp280(void) {
+    SpareParts.DetachI2C(i2c_bus, &bmp280);
     sen_bmp280_end(&bmp280);
     delete Bitmap;
     canvas.Destroy();
@@ -191,6 +193,10 @@ void cpart_bmp280::PreProcess(void) {
             SpareParts.ResetPullupBus(input_pins[1] - 1);
         }
     }
+
+    // the SPI mode is latched, the bus only dispatches to the devices still in I2C mode
+    i2c_bus = SpareParts.AttachI2C(i2c_bus, bmp280.i2c_mode ? input_pins[0] : 0, input_pins[1], &bmp280,
+                                   sen_bmp280_I2C_attach);
 }
 
 void cpart_bmp280::Process(void) {
@@ -198,8 +204,10 @@ void cpart_bmp280::Process(void) {
 
     if (input_pins[0] && input_pins[1] && (input_pins[2])) {
         if ((bmp280.i2c_mode) && (ppins[input_pins[2] - 1].value)) {  // I2C mode
-            SpareParts.SetPullupBus(input_pins[1] - 1, sen_bmp280_I2C_io(&bmp280, ppins[input_pins[0] - 1].value,
-                                                                         ppins[input_pins[1] - 1].value));
+            if (i2c_bus) {
+                SpareParts.SetPullupBus(input_pins[1] - 1, i2c_bus_io(i2c_bus, ppins[input_pins[0] - 1].value,
+                                                                      ppins[input_pins[1] - 1].value));
+            }
         } else {  // SPI mode
             unsigned char ret = sen_bmp280_io_SPI(&bmp280, ppins[input_pins[1] - 1].value,
                                                   ppins[input_pins[0] - 1].value, ppins[input_pins[2] - 1].value);
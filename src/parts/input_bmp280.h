@@ -54,6 +54,7 @@ private:
     unsigned char input_pins[3];
     unsigned char output_pins[1];
     sen_bmp280_t bmp280;
+    i2c_bus_t* i2c_bus;  // bus shared with the other parts on the same pins
     unsigned char values[2];
     unsigned char active[2];
     lxFont font;
@@ -46,6 +46,7 @@ cpart_ds1621::cpart_ds1621(const unsigned x, const unsigned y, const char* name,
       font(8, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD),
       font_p(6, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     sen_ds1621_init(&ds1621);
+    i2c_bus = NULL;
     sen_ds1621_rst(&ds1621);
 
     input_pins[0] = 0;
@@ -65,6 +66,7 @@ cpart_ds1621::cpart_ds1621(const unsigned x, const unsigned y, const char* name,
 }
 
 cpart_ds1621::~cpart_ds1621(void) {
+    SpareParts.DetachI2C(i2c_bus, &ds1621);
     sen_ds1621_end(&ds1621);
     delete Bitmap;
     canvas.Destroy();
@@ -200,14 +202,16 @@ void cpart_ds1621::PreProcess(void) {
         // TODO set addr
         SpareParts.ResetPullupBus(input_pins[0] - 1);
     }
+
+    i2c_bus = SpareParts.AttachI2C(i2c_bus, input_pins[1], input_pins[0], &ds1621, sen_ds1621_I2C_attach);
 }
 
 void cpart_ds1621::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((input_pins[0] > 0) && (input_pins[1] > 0))
-        SpareParts.SetPullupBus(input_pins[0] - 1, sen_ds1621_I2C_io(&ds1621, ppins[input_pins[1] - 1].value,
-                                                                     ppins[input_pins[0] - 1].value));
+    if (i2c_bus && (input_pins[0] > 0) && (input_pins[1] > 0))
+        SpareParts.SetPullupBus(input_pins[0] - 1, i2c_bus_io(i2c_bus, ppins[input_pins[1] - 1].value,
+                                                              ppins[input_pins[0] - 1].value));
 
     // TODO implement Tout output
 }
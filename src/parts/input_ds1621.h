@@ -53,6 +53,7 @@ public:
 private:
     unsigned char input_pins[6];
     sen_ds1621_t ds1621;
+    i2c_bus_t* i2c_bus;  // bus shared with the other parts on the same pins
     unsigned char value;
     unsigned char active;
     lxFont font;
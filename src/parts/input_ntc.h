@@ -48,6 +48,8 @@ public:
     void Reset(void) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
+    int SnapshotWrite(FILE* fout) override { return 0; };  // no simulation state
+    int SnapshotRead(FILE* fin) override { return 0; };
 
 private:
     void RegisterRemoteControl(void) override;
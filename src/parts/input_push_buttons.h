@@ -50,6 +50,8 @@ public:
     void ReadPreferences(lxString value) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
+    int SnapshotWrite(FILE* fout) override { return 0; };  // no simulation state
+    int SnapshotRead(FILE* fin) override { return 0; };
     void SpinChange(CPWindow* WProp, CSpin* control, int value) override;
 
 private:
@@ -67,6 +67,7 @@ cpart_IO_PCF8574::cpart_IO_PCF8574(const unsigned x, const unsigned y, const cha
     LoadImage();
 
     io_PCF8574_init(&ioe8);
+    i2c_bus = NULL;
     io_PCF8574_rst(&ioe8);
 
     input_pins[0] = 0;
@@ -97,6 +98,7 @@ cpart_IO_PCF8574::cpart_IO_PCF8574(const unsigned x, const unsigned y, const cha
 }
 
 cpart_IO_PCF8574::~cpart_IO_PCF8574(void) {
+    SpareParts.DetachI2C(i2c_bus, &ioe8);
     for (int i = 0; i < 9; i++)
         SpareParts.UnregisterIOpin(output_pins[i]);
     delete Bitmap;
@@ -287,12 +289,14 @@ void cpart_IO_PCF8574::PreProcess(void) {
     if (input_pins[1] > 0) {
         SpareParts.ResetPullupBus(input_pins[1] - 1);
     }
+
+    i2c_bus = SpareParts.AttachI2C(i2c_bus, input_pins[0], input_pins[1], &ioe8, io_PCF8574_I2C_attach);
 }
 
 void cpart_IO_PCF8574::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if (ioupdated) {
+    if (pboard->ioupdated) {
         ioe8.dataOut = 0x00;
         ioe8.dataOut |= ppins[output_pins[0] - 1].lsvalue;
         ioe8.dataOut |= ppins[output_pins[1] - 1].lsvalue << 1;
@@ -304,9 +308,9 @@ void cpart_IO_PCF8574::Process(void) {
         ioe8.dataOut |= ppins[output_pins[7] - 1].lsvalue << 7;
         ioe8.dataOut &= ioe8.dataIn;  // mask with input
 
-        if ((input_pins[0] > 0) && (input_pins[1] > 0))
-            SpareParts.SetPullupBus(input_pins[1] - 1, io_PCF8574_I2C_io(&ioe8, ppins[input_pins[0] - 1].value,
-                                                                         ppins[input_pins[1] - 1].value));
+        if (i2c_bus && (input_pins[0] > 0) && (input_pins[1] > 0))
+            SpareParts.SetPullupBus(input_pins[1] - 1, i2c_bus_io(i2c_bus, ppins[input_pins[0] - 1].value,
+                                                                  ppins[input_pins[1] - 1].value));
 
         if (_ret != ioe8.dataIn) {
             SpareParts.WritePin(output_pins[0], (ioe8.dataIn & 0x01) != 0);
@@ -58,6 +58,7 @@ private:
     long mcount;
     int JUMPSTEPS_;
     io_PCF8574_t ioe8;
+    i2c_bus_t* i2c_bus;  // bus shared with the other parts on the same pins
     unsigned short _ret;
 };
 
@@ -58,6 +58,7 @@ cpart_MI2C_24CXXX::cpart_MI2C_24CXXX(const unsigned x, const unsigned y, const c
     kbits = 4;
 
     mi2c_init(&mi2c, kbits);
+    i2c_bus = NULL;
     mi2c_rst(&mi2c);
 
     input_pins[0] = 0;
@@ -83,6 +84,7 @@ cpart_MI2C_24CXXX::cpart_MI2C_24CXXX(const unsigned x, const unsigned y, const c
 }
 
 cpart_MI2C_24CXXX::~cpart_MI2C_24CXXX(void) {
+    SpareParts.DetachI2C(i2c_bus, &mi2c);
     mi2c_end(&mi2c);
     delete Bitmap;
     canvas.Destroy();
@@ -198,6 +200,14 @@ void cpart_MI2C_24CXXX::ReadPreferences(lxString value) {
     Reset();
 }
 
+int cpart_MI2C_24CXXX::SnapshotWrite(FILE* fout) {
+    return mi2c_snapshot_write(&mi2c, fout);
+}
+
+int cpart_MI2C_24CXXX::SnapshotRead(FILE* fin) {
+    return mi2c_snapshot_read(&mi2c, fin);
+}
+
 void cpart_MI2C_24CXXX::ConfigurePropertiesWindow(CPWindow* WProp) {
     SetPCWComboWithPinNames(WProp, "combo1", input_pins[0]);
     SetPCWComboWithPinNames(WProp, "combo2", input_pins[1]);
@@ -251,14 +261,16 @@ void cpart_MI2C_24CXXX::PreProcess(void) {
     if (input_pins[3] > 0) {
         SpareParts.ResetPullupBus(input_pins[3] - 1);
     }
+
+    i2c_bus = SpareParts.AttachI2C(i2c_bus, input_pins[4], input_pins[3], &mi2c, mi2c_attach);
 }
 
 void cpart_MI2C_24CXXX::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((input_pins[3] > 0) && (input_pins[4] > 0))
+    if (i2c_bus && (input_pins[3] > 0) && (input_pins[4] > 0))
         SpareParts.SetPullupBus(input_pins[3] - 1,
-                                mi2c_io(&mi2c, ppins[input_pins[4] - 1].value, ppins[input_pins[3] - 1].value));
+                                i2c_bus_io(i2c_bus, ppins[input_pins[4] - 1].value, ppins[input_pins[3] - 1].value));
 }
 
 void cpart_MI2C_24CXXX::OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) {
@@ -47,12 +47,15 @@ public:
     void ReadPropertiesWindow(CPWindow* WProp) override;
     lxString WritePreferences(void) override;
     void ReadPreferences(lxString value) override;
+    int SnapshotWrite(FILE* fout) override;
+    int SnapshotRead(FILE* fin) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
 
 private:
     unsigned char input_pins[5];
     mi2c_t mi2c;
+    i2c_bus_t* i2c_bus;  // bus shared with the other parts on the same pins
     int kbits;
     char f_mi2c_name[200];
     char f_mi2c_tmp_name[200];
@@ -44,6 +44,7 @@ cpart_RTC_ds1307::cpart_RTC_ds1307(const unsigned x, const unsigned y, const cha
       font(8, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD),
       font_p(6, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     rtc_ds1307_init(&rtc2, pboard);
+    i2c_bus = NULL;
     rtc_ds1307_rst(&rtc2);
     input_pins[0] = 0;
     input_pins[1] = 0;
@@ -56,6 +57,7 @@ cpart_RTC_ds1307::cpart_RTC_ds1307(const unsigned x, const unsigned y, const cha
 }
 
 cpart_RTC_ds1307::~cpart_RTC_ds1307(void) {
+    SpareParts.DetachI2C(i2c_bus, &rtc2);
     rtc_ds1307_end(&rtc2);
     delete Bitmap;
     canvas.Destroy();
@@ -134,6 +136,14 @@ void cpart_RTC_ds1307::ReadPreferences(lxString value) {
     Reset();
 }
 
+int cpart_RTC_ds1307::SnapshotWrite(FILE* fout) {
+    return rtc_ds1307_snapshot_write(&rtc2, fout);
+}
+
+int cpart_RTC_ds1307::SnapshotRead(FILE* fin) {
+    return rtc_ds1307_snapshot_read(&rtc2, fin);
+}
+
 void cpart_RTC_ds1307::ConfigurePropertiesWindow(CPWindow* WProp) {
     SetPCWComboWithPinNames(WProp, "combo5", input_pins[0]);
     SetPCWComboWithPinNames(WProp, "combo6", input_pins[1]);
@@ -150,14 +160,16 @@ void cpart_RTC_ds1307::PreProcess(void) {
     if (input_pins[0] > 0) {
         SpareParts.ResetPullupBus(input_pins[0] - 1);
     }
+
+    i2c_bus = SpareParts.AttachI2C(i2c_bus, input_pins[1], input_pins[0], &rtc2, rtc_ds1307_I2C_attach);
 }
 
 void cpart_RTC_ds1307::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((input_pins[0] > 0) && (input_pins[1] > 0))
-        SpareParts.SetPullupBus(input_pins[0] - 1, rtc_ds1307_I2C_io(&rtc2, ppins[input_pins[1] - 1].value,
-                                                                     ppins[input_pins[0] - 1].value));
+    if (i2c_bus && (input_pins[0] > 0) && (input_pins[1] > 0))
+        SpareParts.SetPullupBus(input_pins[0] - 1, i2c_bus_io(i2c_bus, ppins[input_pins[1] - 1].value,
+                                                              ppins[input_pins[0] - 1].value));
 }
 
 part_init(PART_RTC_DS1307_Name, cpart_RTC_ds1307, "Other");
@@ -46,12 +46,15 @@ public:
     void ReadPropertiesWindow(CPWindow* WProp) override;
     lxString WritePreferences(void) override;
     void ReadPreferences(lxString value) override;
+    int SnapshotWrite(FILE* fout) override;
+    int SnapshotRead(FILE* fin) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
 
 private:
     unsigned char input_pins[3];
     rtc_ds1307_t rtc2;
+    i2c_bus_t* i2c_bus;  // bus shared with the other parts on the same pins
     lxFont font;
     lxFont font_p;
 };
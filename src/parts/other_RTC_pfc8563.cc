@@ -42,6 +42,7 @@ cpart_RTC_pfc8563::cpart_RTC_pfc8563(const unsigned x, const unsigned y, const c
                                      board* pboard_)
     : part(x, y, name, type, pboard_, 8), font_p(6, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     rtc_pfc8563_init(&rtc, pboard);
+    i2c_bus = NULL;
     rtc_pfc8563_rst(&rtc);
 
     input_pins[0] = 0;
@@ -56,6 +57,7 @@ cpart_RTC_pfc8563::cpart_RTC_pfc8563(const unsigned x, const unsigned y, const c
 }
 
 cpart_RTC_pfc8563::~cpart_RTC_pfc8563(void) {
+    SpareParts.DetachI2C(i2c_bus, &rtc);
     rtc_pfc8563_end(&rtc);
     delete Bitmap;
     canvas.Destroy();
@@ -134,6 +136,14 @@ void cpart_RTC_pfc8563::ReadPreferences(lxString value) {
     Reset();
 }
 
+int cpart_RTC_pfc8563::SnapshotWrite(FILE* fout) {
+    return rtc_pfc8563_snapshot_write(&rtc, fout);
+}
+
+int cpart_RTC_pfc8563::SnapshotRead(FILE* fin) {
+    return rtc_pfc8563_snapshot_read(&rtc, fin);
+}
+
 void cpart_RTC_pfc8563::ConfigurePropertiesWindow(CPWindow* WProp) {
     SetPCWComboWithPinNames(WProp, "combo3", input_pins[0]);
     SetPCWComboWithPinNames(WProp, "combo5", input_pins[1]);
@@ -152,14 +162,16 @@ void cpart_RTC_pfc8563::PreProcess(void) {
     if (input_pins[1] > 0) {
         SpareParts.ResetPullupBus(input_pins[1] - 1);
     }
+
+    i2c_bus = SpareParts.AttachI2C(i2c_bus, input_pins[2], input_pins[1], &rtc, rtc_pfc8563_I2C_attach);
 }
 
 void cpart_RTC_pfc8563::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((input_pins[1] > 0) && (input_pins[2] > 0))
-        SpareParts.SetPullupBus(input_pins[1] - 1, rtc_pfc8563_I2C_io(&rtc, ppins[input_pins[2] - 1].value,
-                                                                      ppins[input_pins[1] - 1].value));
+    if (i2c_bus && (input_pins[1] > 0) && (input_pins[2] > 0))
+        SpareParts.SetPullupBus(input_pins[1] - 1, i2c_bus_io(i2c_bus, ppins[input_pins[2] - 1].value,
+                                                              ppins[input_pins[1] - 1].value));
 }
 
 part_init(PART_RTC_PFC8563_Name, cpart_RTC_pfc8563, "Other");
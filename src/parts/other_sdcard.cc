@@ -54,9 +54,9 @@ const char pin_values[10][10] = {
 };
  */
 
-static PCWProp pcwprop[7] = {
+static PCWProp pcwprop[8] = {
     {PCW_LABEL, "P1-GND ,GND"}, {PCW_LABEL, "P2-VCC,+5V"}, {PCW_COMBO, "P3-MISO"}, {PCW_COMBO, "P4-MOSI"},
-    {PCW_COMBO, "P5-SCK"},      {PCW_COMBO, "P6-CS"},      {PCW_END, ""}};
+    {PCW_COMBO, "P5-SCK"},      {PCW_COMBO, "P6-CS"},      {PCW_COMBO, "Writes"},  {PCW_END, ""}};
 
 cpart_SDCard::cpart_SDCard(const unsigned x, const unsigned y, const char* name, const char* type, board* pboard_)
     : part(x, y, name, type, pboard_), font(8, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
@@ -72,6 +72,7 @@ cpart_SDCard::cpart_SDCard(const unsigned x, const unsigned y, const char* name,
 
     sdcard_fname[0] = '*';
     sdcard_fname[1] = 0;
+    sdcard_cow = 0;
 
     SetPCWProperties(pcwprop);
 
@@ -164,13 +165,18 @@ unsigned short cpart_SDCard::GetOutputId(char* name) {
 lxString cpart_SDCard::WritePreferences(void) {
     char prefs[256];
 
-    sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%s", pins[0], pins[1], pins[2], pins[3], sdcard_fname);
+    sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%hhu,%s", pins[0], pins[1], pins[2], pins[3], sdcard_cow, sdcard_fname);
 
     return prefs;
 }
 
 void cpart_SDCard::ReadPreferences(lxString value) {
-    sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%s", &pins[0], &pins[1], &pins[2], &pins[3], sdcard_fname);
+    if (sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%s", &pins[0], &pins[1], &pins[2], &pins[3], &sdcard_cow,
+               sdcard_fname) != 6) {
+        // old format without write mode
+        sdcard_cow = 0;
+        sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%s", &pins[0], &pins[1], &pins[2], &pins[3], sdcard_fname);
+    }
 
     Reset();
 
@@ -182,7 +188,7 @@ void cpart_SDCard::ReadPreferences(lxString value) {
             strcpy(sdcard_fname, buff);
         }
 
-        sdcard_set_filename(&sd, sdcard_fname);
+        sdcard_set_filename(&sd, sdcard_fname, sdcard_cow);
         sdcard_set_card_present(&sd, 1);
     } else {
         sdcard_set_card_present(&sd, 0);
@@ -194,6 +200,13 @@ void cpart_SDCard::ConfigurePropertiesWindow(CPWindow* WProp) {
     SetPCWComboWithPinNames(WProp, "combo4", pins[0]);
     SetPCWComboWithPinNames(WProp, "combo5", pins[1]);
     SetPCWComboWithPinNames(WProp, "combo6", pins[2]);
+
+    ((CCombo*)WProp->GetChildByName("combo7"))->SetItems("To image,Memory only,");
+    if (sdcard_cow) {
+        ((CCombo*)WProp->GetChildByName("combo7"))->SetText("Memory only");
+    } else {
+        ((CCombo*)WProp->GetChildByName("combo7"))->SetText("To image");
+    }
 }
 
 void cpart_SDCard::ReadPropertiesWindow(CPWindow* WProp) {
@@ -201,6 +214,14 @@ void cpart_SDCard::ReadPropertiesWindow(CPWindow* WProp) {
     pins[0] = GetPWCComboSelectedPin(WProp, "combo4");
     pins[1] = GetPWCComboSelectedPin(WProp, "combo5");
     pins[2] = GetPWCComboSelectedPin(WProp, "combo6");
+
+    unsigned char cow = (((CCombo*)WProp->GetChildByName("combo7"))->GetText().compare("Memory only") == 0);
+    if (cow != sdcard_cow) {
+        sdcard_cow = cow;
+        if (sdcard_fname[0] != '*') {
+            sdcard_set_filename(&sd, sdcard_fname, sdcard_cow);
+        }
+    }
 }
 
 void cpart_SDCard::Process(void) {
@@ -242,7 +263,7 @@ void cpart_SDCard::filedialog_EvOnClose(int retId) {
         if ((SpareParts.GetFileDialog()->GetType() == (lxFD_OPEN | lxFD_CHANGE_DIR))) {
             if (lxFileExists(SpareParts.GetFileDialog()->GetFileName())) {
                 strncpy(sdcard_fname, SpareParts.GetFileDialog()->GetFileName().c_str(), 199);
-                sdcard_set_filename(&sd, sdcard_fname);
+                sdcard_set_filename(&sd, sdcard_fname, sdcard_cow);
                 sdcard_set_card_present(&sd, 1);
             } else {
                 sdcard_set_card_present(&sd, 0);
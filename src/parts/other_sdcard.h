@@ -54,6 +54,7 @@ private:
     sdcard_t sd;
     unsigned short _ret;
     char sdcard_fname[200];
+    unsigned char sdcard_cow;
     lxFont font;
 };
 
@@ -230,6 +230,23 @@ void cpart_LCD_hd44780::ReadPreferences(lxString value) {
     Reset();
 }
 
+int cpart_LCD_hd44780::SnapshotWrite(FILE* fout) {
+    int ret = lcd_snapshot_write(&lcd, fout);
+    ret |= snapshot_write(fout, &lcde, sizeof(lcde));
+    return ret;
+}
+
+int cpart_LCD_hd44780::SnapshotRead(FILE* fin) {
+    int slcde;
+
+    if (lcd_snapshot_read(&lcd, fin) || snapshot_read(fin, &slcde, sizeof(slcde))) {
+        return -1;
+    }
+
+    lcde = slcde;
+    return 0;
+}
+
 void cpart_LCD_hd44780::RegisterRemoteControl(void) {
     output_ids[O_LCD]->status = (void*)&lcd;
 }
@@ -397,6 +414,7 @@ void cpart_LCD_hd44780::LoadImage(void) {
     }
 
     lcd.update = 1;
+    lcd.redraw = 1;
 }
 
 part_init(PART_LCD_HD44780_Name, cpart_LCD_hd44780, "Output");
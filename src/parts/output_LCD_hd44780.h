@@ -55,6 +55,8 @@ public:
     lxString WritePreferences(void) override;
     void LoadImage(void) override;
     void ReadPreferences(lxString value) override;
+    int SnapshotWrite(FILE* fout) override;
+    int SnapshotRead(FILE* fin) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
     unsigned char input_pins[11];
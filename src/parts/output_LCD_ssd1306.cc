@@ -45,6 +45,7 @@ cpart_LCD_ssd1306::cpart_LCD_ssd1306(const unsigned x, const unsigned y, const c
     LoadImage();
 
     lcd_ssd1306_init(&lcd);
+    i2c_bus = NULL;
     lcd_ssd1306_rst(&lcd);
 
     input_pins[0] = 0;
@@ -62,6 +63,7 @@ cpart_LCD_ssd1306::cpart_LCD_ssd1306(const unsigned x, const unsigned y, const c
 };
 
 cpart_LCD_ssd1306::~cpart_LCD_ssd1306(void) {
+    SpareParts.DetachI2C(i2c_bus, &lcd);
     delete Bitmap;
     canvas.Destroy();
 }
@@ -188,15 +190,17 @@ void cpart_LCD_ssd1306::PreProcess(void) {
     if ((type_com) && (input_pins[1] > 0)) {
         SpareParts.ResetPullupBus(input_pins[1] - 1);
     }
+
+    i2c_bus = SpareParts.AttachI2C(i2c_bus, type_com ? input_pins[0] : 0, input_pins[1], &lcd, lcd_ssd1306_I2C_attach);
 }
 
 void cpart_LCD_ssd1306::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
     if (type_com) {
-        if ((input_pins[0] > 0) && (input_pins[1] > 0))
-            SpareParts.SetPullupBus(input_pins[1] - 1, lcd_ssd1306_I2C_io(&lcd, ppins[input_pins[1] - 1].value,
-                                                                          ppins[input_pins[0] - 1].value));
+        if (i2c_bus && (input_pins[0] > 0) && (input_pins[1] > 0))
+            SpareParts.SetPullupBus(input_pins[1] - 1, i2c_bus_io(i2c_bus, ppins[input_pins[0] - 1].value,
+                                                                  ppins[input_pins[1] - 1].value));
 
         if (input_pins[1] > 0)
             SpareParts.SetPin(input_pins[1], SpareParts.GetPullupBus(input_pins[1] - 1));
@@ -52,6 +52,7 @@ public:
 private:
     unsigned char input_pins[5];
     lcd_ssd1306_t lcd;
+    i2c_bus_t* i2c_bus;  // bus shared with the other parts on the same pins
     unsigned char type_com;
     lxFont font;
 };
@@ -45,7 +45,8 @@ cpart_led_ws2812b::cpart_led_ws2812b(const unsigned x, const unsigned y, const c
 
     Bitmap = NULL;
 
-    always_update = 1;
+    edge_pin = 0;
+    edge_pos = 0;
 
     led_ws2812b_init(&led, 1, 1, 1);
 
@@ -64,6 +65,7 @@ cpart_led_ws2812b::cpart_led_ws2812b(const unsigned x, const unsigned y, const c
 }
 
 cpart_led_ws2812b::~cpart_led_ws2812b(void) {
+    pboard->EdgeUnwatch(edge_pin);
     SpareParts.UnregisterIOpin(output_pins[0]);
     delete Bitmap;
     canvas.Destroy();
@@ -87,10 +89,7 @@ void cpart_led_ws2812b::LoadImage(void) {
             canvas.Destroy();
             canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
 
-            image.LoadFile(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetPictureFileName()),
-                           Orientation, Scale, Scale);
-            lxBitmap* BackBitmap = new lxBitmap(&image, SpareParts.GetWindow());
-            image.Destroy();
+            lxBitmap* BackBitmap = GetPictureImage();
 
             image.LoadFile(
                 lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetName() + lxT("/LED.svg")),
@@ -115,7 +114,6 @@ void cpart_led_ws2812b::LoadImage(void) {
             canvas.ChangeScale(Scale, Scale);
             canvas.End();
 
-            delete BackBitmap;
             delete LEDBitmap;
         }
     } else {
@@ -285,6 +283,35 @@ void cpart_led_ws2812b::ReadPropertiesWindow(CPWindow* WProp) {
 
 void cpart_led_ws2812b::PreProcess(void) {
     led_ws2812b_prepare(&led, pboard->MGetInstClockFreq());
+
+    // DIN on a board pin is also read from the board edge log, it keeps the edges of boards that change pins
+    // without signaling ioupdated. DIN driven by another part is always signaled by SpareParts.WritePin.
+    unsigned char pin = 0;
+    if ((input_pins[0] > 0) && (input_pins[0] <= pboard->MGetPinCount())) {
+        pin = input_pins[0];
+    }
+    if (pin != edge_pin) {
+        pboard->EdgeUnwatch(edge_pin);
+        edge_pin = pin;
+        edge_pos = pboard->EdgeWatch(edge_pin);
+    }
+}
+
+// feed the logged DIN edges not seen by Process, edges already applied have the value of the last DIN.
+// Return the last DOUT value or -1 if no edge was applied.
+int cpart_led_ws2812b::DinEdges(void) {
+    pin_edge_t edges[32];
+    int count;
+    int out = -1;
+
+    while ((count = pboard->EdgeRead(edge_pin, &edge_pos, edges, 32)) > 0) {
+        for (int i = 0; i < count; i++) {
+            if (edges[i].value != led.adin) {
+                out = led_ws2812b_io(&led, edges[i].value, edges[i].time);
+            }
+        }
+    }
+    return out;
 }
 
 void cpart_led_ws2812b::Process(void) {
@@ -292,7 +319,12 @@ void cpart_led_ws2812b::Process(void) {
 
     if (input_pins[0] > 0) {
         unsigned char out;
-        out = led_ws2812b_io(&led, ppins[input_pins[0] - 1].value);
+
+        if (edge_pin) {
+            DinEdges();
+        }
+
+        out = led_ws2812b_io(&led, ppins[input_pins[0] - 1].value, pboard->GetInstCounter());
 
         if (out != ppins[output_pins[0] - 1].value) {
             SpareParts.WritePin(output_pins[0], out);
@@ -301,6 +333,15 @@ void cpart_led_ws2812b::Process(void) {
 }
 
 void cpart_led_ws2812b::PostProcess(void) {
+    if (edge_pin) {
+        const picpin* ppins = SpareParts.GetPinsValues();
+        const int out = DinEdges();
+
+        if ((out >= 0) && (out != ppins[output_pins[0] - 1].value)) {
+            SpareParts.WritePin(output_pins[0], out);
+        }
+    }
+
     if (led.update)
         output_ids[O_LED]->update = 1;
 }
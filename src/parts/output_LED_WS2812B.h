@@ -52,8 +52,11 @@ public:
 private:
     void ChangeType(const unsigned int rows, const unsigned int cols, const unsigned char diffuser);
     void RegisterRemoteControl(void) override;
+    int DinEdges(void);
     unsigned char input_pins[1];
     unsigned char output_pins[1];
+    unsigned char edge_pin;  // watched DIN board pin, 0 if none
+    uint32_t edge_pos;       // edge log read position
     led_ws2812b_t led;
     lxFont font;
     int OWidth;
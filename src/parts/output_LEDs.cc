@@ -356,10 +356,7 @@ void cpart_leds::LoadImage(void) {
             canvas.Destroy();
             canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
 
-            image.LoadFile(lxGetLocalFile(PICSimLab.GetSharePath() + lxT("parts/") + Type + "/" + GetPictureFileName()),
-                           Orientation, Scale, Scale);
-            lxBitmap* BackBitmap = new lxBitmap(&image, SpareParts.GetWindow());
-            image.Destroy();
+            lxBitmap* BackBitmap = GetPictureImage();
 
             canvas.Init(Scale, Scale, Orientation);
             canvas.SetColor(0x31, 0x3d, 0x63);
@@ -370,8 +367,6 @@ void cpart_leds::LoadImage(void) {
 
             canvas.ChangeScale(Scale, Scale);
             canvas.End();
-
-            delete BackBitmap;
         }
     } else {
         Width = OWidth;
@@ -35,13 +35,12 @@ static PCWProp pcwprop[2] = {{PCW_COMBO, "Pin 1"}, {PCW_END, ""}};
 
 cpart_servo::cpart_servo(const unsigned x, const unsigned y, const char* name, const char* type, board* pboard_)
     : part(x, y, name, type, pboard_), font(9, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
-    always_update = 1;
     input_pin = 0;
     angle = 0;
     angle_ = 0;
-    in_[0] = 0;
-    in_[1] = 0;
-    time = 0;
+    edge_pos = 0;
+    rise_time = 0;
+    rise = 0;
     BackGround = NULL;
     SetPCWProperties(pcwprop);
     PinCount = 1;
@@ -49,6 +48,7 @@ cpart_servo::cpart_servo(const unsigned x, const unsigned y, const char* name, c
 }
 
 cpart_servo::~cpart_servo(void) {
+    pboard->EdgeUnwatch(input_pin);
     delete Bitmap;
     delete BackGround;
     canvas.Destroy();
@@ -83,34 +83,37 @@ void cpart_servo::DrawOutput(const unsigned int i) {
     }
 }
 
-void cpart_servo::Process(void) {
-    const picpin* ppins = SpareParts.GetPinsValues();
-
-    if (input_pin == 0)
-        return;
-
-    in_[1] = in_[0];
-    in_[0] = ppins[input_pin - 1].value;
-
-    if ((in_[0] == 1) && (in_[1] == 0))  // rise
-    {
-        time = 0;
-    }
-
-    if ((in_[0] == 0) && (in_[1] == 1))  // low
-    {
-        angle_ = ((time / pboard->MGetInstClockFreq()) - 0.0015) * 3141.59265359;
-
-        if (angle_ > M_PI / 2.0)
-            angle_ = M_PI / 2.0;
-        if (angle_ < -M_PI / 2.0)
-            angle_ = -M_PI / 2.0;
+void cpart_servo::SetInputPin(const unsigned char pin) {
+    if (pin != input_pin) {
+        pboard->EdgeUnwatch(input_pin);
+        input_pin = pin;
+        edge_pos = pboard->EdgeWatch(input_pin);
+        rise = 0;
     }
-
-    time++;
 }
 
 void cpart_servo::PostProcess(void) {
+    pin_edge_t edges[32];
+    int n;
+
+    // pulse width from the edges logged since last call
+    while ((n = pboard->EdgeRead(input_pin, &edge_pos, edges, 32)) > 0) {
+        for (int i = 0; i < n; i++) {
+            if (edges[i].value) {  // rise
+                rise_time = edges[i].time;
+                rise = 1;
+            } else if (rise) {  // low
+                angle_ = (((edges[i].time - rise_time) / pboard->MGetInstClockFreq()) - 0.0015) * 3141.59265359;
+
+                if (angle_ > M_PI / 2.0)
+                    angle_ = M_PI / 2.0;
+                if (angle_ < -M_PI / 2.0)
+                    angle_ = -M_PI / 2.0;
+                rise = 0;
+            }
+        }
+    }
+
     if (angle > angle_) {
         angle -= 0.2;
         if (angle < angle_)
@@ -154,7 +157,9 @@ lxString cpart_servo::WritePreferences(void) {
 }
 
 void cpart_servo::ReadPreferences(lxString value) {
-    sscanf(value.c_str(), "%hhu", &input_pin);
+    unsigned char pin = 0;
+    sscanf(value.c_str(), "%hhu", &pin);
+    SetInputPin(pin);
 }
 
 void cpart_servo::RegisterRemoteControl(void) {
@@ -166,7 +171,7 @@ void cpart_servo::ConfigurePropertiesWindow(CPWindow* WProp) {
 }
 
 void cpart_servo::ReadPropertiesWindow(CPWindow* WProp) {
-    input_pin = GetPWCComboSelectedPin(WProp, "combo1");
+    SetInputPin(GetPWCComboSelectedPin(WProp, "combo1"));
 }
 
 void cpart_servo::LoadImage(void) {
@@ -53,7 +53,6 @@ public:
     ~cpart_servo(void);
 
     void DrawOutput(const unsigned int index) override;
-    void Process(void) override;
     void PostProcess(void) override;
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
     void ReadPropertiesWindow(CPWindow* WProp) override;
@@ -65,12 +64,14 @@ public:
 
 private:
     void RegisterRemoteControl(void) override;
+    void SetInputPin(const unsigned char pin);
     unsigned char input_pin;  ///< pulse input pin
     lxBitmap* BackGround;     ///< Background image
     float angle;              ///< angle of shaft
     float angle_;             ///< old angle of shaft
-    unsigned char in_[2];     ///< input pin memory
-    int time;                 ///< pulse time
+    uint32_t edge_pos;        ///< input pin edges read position
+    uint32_t rise_time;       ///< InstCounter of last rising edge
+    unsigned char rise;       ///< rising edge seen
     lxFont font;
 };
 
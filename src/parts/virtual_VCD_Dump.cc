@@ -32,17 +32,16 @@
 #include <emscripten.h>
 #endif
 
-static const char markers[] = "!$%&[()]";
-
 /* outputs */
 enum { O_P1, O_P2, O_P3, O_P4, O_P5, O_P6, O_P7, O_P8, O_L1, O_L2, O_L3, O_L4, O_L5, O_L6, O_L7, O_L8, O_NAME, O_REC };
 
 /*inputs*/
 enum { I_START, I_VIEW };
 
-static PCWProp pcwprop[9] = {{PCW_COMBO, "Pin 1"}, {PCW_COMBO, "Pin 2"}, {PCW_COMBO, "Pin 3"},
-                             {PCW_COMBO, "Pin 4"}, {PCW_COMBO, "Pin 5"}, {PCW_COMBO, "Pin 6"},
-                             {PCW_COMBO, "Pin 7"}, {PCW_COMBO, "Pin 8"}, {PCW_END, ""}};
+static PCWProp pcwprop[10] = {{PCW_COMBO, "Pin 1"}, {PCW_COMBO, "Pin 2"}, {PCW_COMBO, "Pin 3"},
+                              {PCW_COMBO, "Pin 4"}, {PCW_COMBO, "Pin 5"}, {PCW_COMBO, "Pin 6"},
+                              {PCW_COMBO, "Pin 7"}, {PCW_COMBO, "Pin 8"}, {PCW_COMBO, "Record"},
+                              {PCW_END, ""}};
 
 cpart_VCD_Dump::cpart_VCD_Dump(const unsigned x, const unsigned y, const char* name, const char* type, board* pboard_)
     : part(x, y, name, type, pboard_), font(9, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
@@ -57,14 +56,8 @@ cpart_VCD_Dump::cpart_VCD_Dump(const unsigned x, const unsigned y, const char* n
     input_pins[6] = 0;
     input_pins[7] = 0;
 
-    old_value_pins[0] = 2;
-    old_value_pins[1] = 2;
-    old_value_pins[2] = 2;
-    old_value_pins[3] = 2;
-    old_value_pins[4] = 2;
-    old_value_pins[5] = 2;
-    old_value_pins[6] = 2;
-    old_value_pins[7] = 2;
+    allpins = 0;
+    rec_count = 0;
 
     snprintf(f_vcd_name, 200, "%s/picsimlab-XXXXXX", (const char*)lxGetTempDir("PICSimLab").c_str());
     close(mkstemp(f_vcd_name));
@@ -72,9 +65,8 @@ cpart_VCD_Dump::cpart_VCD_Dump(const unsigned x, const unsigned y, const char* n
 
     strncat(f_vcd_name, ".vcd", 200);
 
-    f_vcd = fopen(f_vcd_name, "w");
+    FILE* f_vcd = fopen(f_vcd_name, "w");
     fclose(f_vcd);
-    f_vcd = NULL;
 
     rec = 0;
     vcd_count = 0;
@@ -94,10 +86,7 @@ cpart_VCD_Dump::~cpart_VCD_Dump(void) {
     delete Bitmap;
     canvas.Destroy();
 
-    if (f_vcd) {
-        fclose(f_vcd);
-        f_vcd = NULL;
-    }
+    vcd.Close();
     unlink(f_vcd_name);
 }
 
@@ -252,15 +241,16 @@ unsigned short cpart_VCD_Dump::GetOutputId(char* name) {
 lxString cpart_VCD_Dump::WritePreferences(void) {
     char prefs[256];
 
-    sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu", input_pins[0], input_pins[1], input_pins[2],
-            input_pins[3], input_pins[4], input_pins[5], input_pins[6], input_pins[7], rec);
+    sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu", input_pins[0], input_pins[1], input_pins[2],
+            input_pins[3], input_pins[4], input_pins[5], input_pins[6], input_pins[7], rec, allpins);
 
     return prefs;
 }
 
 void cpart_VCD_Dump::ReadPreferences(lxString value) {
-    sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu", &input_pins[0], &input_pins[1],
-           &input_pins[2], &input_pins[3], &input_pins[4], &input_pins[5], &input_pins[6], &input_pins[7], &rec);
+    sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu", &input_pins[0], &input_pins[1],
+           &input_pins[2], &input_pins[3], &input_pins[4], &input_pins[5], &input_pins[6], &input_pins[7], &rec,
+           &allpins);
 }
 
 void cpart_VCD_Dump::ConfigurePropertiesWindow(CPWindow* WProp) {
@@ -272,6 +262,12 @@ void cpart_VCD_Dump::ConfigurePropertiesWindow(CPWindow* WProp) {
     SetPCWComboWithPinNames(WProp, "combo6", input_pins[5]);
     SetPCWComboWithPinNames(WProp, "combo7", input_pins[6]);
     SetPCWComboWithPinNames(WProp, "combo8", input_pins[7]);
+
+    ((CCombo*)WProp->GetChildByName("combo9"))->SetItems("Selected pins,All pins,");
+    if (allpins)
+        ((CCombo*)WProp->GetChildByName("combo9"))->SetText("All pins");
+    else
+        ((CCombo*)WProp->GetChildByName("combo9"))->SetText("Selected pins");
 }
 
 void cpart_VCD_Dump::ReadPropertiesWindow(CPWindow* WProp) {
@@ -283,86 +279,55 @@ void cpart_VCD_Dump::ReadPropertiesWindow(CPWindow* WProp) {
     input_pins[5] = GetPWCComboSelectedPin(WProp, "combo6");
     input_pins[6] = GetPWCComboSelectedPin(WProp, "combo7");
     input_pins[7] = GetPWCComboSelectedPin(WProp, "combo8");
+
+    allpins = (((CCombo*)WProp->GetChildByName("combo9"))->GetText().compare("All pins") == 0);
 }
 
 void cpart_VCD_Dump::PreProcess(void) {
-    if (rec && (f_vcd == NULL)) {
+    if (rec && !vcd.IsOpen()) {
         float tscale = 1.0e12 / pboard->MGetInstClockFreq();  // ps step
 
-        f_vcd = fopen(f_vcd_name, "w");
         vcd_count = 0;
+        rec_count = 0;
 
-        fprintf(f_vcd,
-                "$version Generated by PICSimLab $end\n"
-                "$timescale %ips $end\n"
-                "$scope module logic $end\n",
-                (int)tscale);
-
-        if (input_pins[0])
-            fprintf(f_vcd, "$var wire 1 !  1-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[0]).c_str());
-        if (input_pins[1])
-            fprintf(f_vcd, "$var wire 1 $  2-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[1]).c_str());
-        if (input_pins[2])
-            fprintf(f_vcd, "$var wire 1 %%  3-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[2]).c_str());
-        if (input_pins[3])
-            fprintf(f_vcd, "$var wire 1 &  4-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[3]).c_str());
-        if (input_pins[4])
-            fprintf(f_vcd, "$var wire 1 [  5-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[4]).c_str());
-        if (input_pins[5])
-            fprintf(f_vcd, "$var wire 1 (  6-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[5]).c_str());
-        if (input_pins[6])
-            fprintf(f_vcd, "$var wire 1 )  7-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[6]).c_str());
-        if (input_pins[7])
-            fprintf(f_vcd, "$var wire 1 ]  8-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[7]).c_str());
-
-        fprintf(f_vcd,
-                "$upscope $end\n"
-                "$enddefinitions $end\n"
-                "$dumpvars\n");
-
-        if (input_pins[0])
-            fprintf(f_vcd, "x!\n");
-        if (input_pins[1])
-            fprintf(f_vcd, "x$\n");
-        if (input_pins[2])
-            fprintf(f_vcd, "x%%\n");
-        if (input_pins[3])
-            fprintf(f_vcd, "x&\n");
-        if (input_pins[4])
-            fprintf(f_vcd, "x[\n");
-        if (input_pins[5])
-            fprintf(f_vcd, "x(\n");
-        if (input_pins[6])
-            fprintf(f_vcd, "x)\n");
-        if (input_pins[7])
-            fprintf(f_vcd, "x[\n");
-        fprintf(f_vcd, "$end\n");
-    } else if (!rec && (f_vcd != NULL)) {
-        if (f_vcd) {
-            fclose(f_vcd);
-            f_vcd = NULL;
+        if (!vcd.Open(f_vcd_name, "logic", (int)tscale)) {
+            return;
         }
+
+        if (allpins) {
+            for (int i = 1; i < 256; i++) {
+                if (SpareParts.IsValidPin(i)) {
+                    rec_pins[rec_count++] = i;
+                    vcd.AddWire((const char*)(itoa(i) + "-" + SpareParts.GetPinName(i)).c_str());
+                }
+            }
+        } else {
+            for (int i = 0; i < 8; i++) {
+                if (input_pins[i]) {
+                    rec_pins[rec_count++] = input_pins[i];
+                    vcd.AddWire((const char*)(itoa(i + 1) + "-" + SpareParts.GetPinName(input_pins[i])).c_str());
+                }
+            }
+        }
+        memset(old_value_pins, 2, sizeof(old_value_pins));
+
+        vcd.EndDefinitions();
+    } else if (!rec && vcd.IsOpen()) {
+        vcd.Close();
     }
 }
 
 void cpart_VCD_Dump::Process(void) {
-    if (rec && f_vcd) {
+    if (rec && vcd.IsOpen()) {
         const picpin* ppins = SpareParts.GetPinsValues();
 
         vcd_count++;
-        int tprint = 0;
-
-        for (int i = 0; i < 8; i++) {
-            if (input_pins[i] != 0) {
-                if (ppins[input_pins[i] - 1].value != old_value_pins[i]) {
-                    if (!tprint) {
-                        tprint = 1;
-                        fprintf(f_vcd, "#%li\n", vcd_count);
-                    }
-                    old_value_pins[i] = ppins[input_pins[i] - 1].value;
-                    fprintf(f_vcd, "%i%c\n", old_value_pins[i], markers[i]);
-                    fflush(f_vcd);
-                }
+        vcd.SetTime(vcd_count);
+
+        for (int i = 0; i < rec_count; i++) {
+            if (ppins[rec_pins[i] - 1].value != old_value_pins[i]) {
+                old_value_pins[i] = ppins[rec_pins[i] - 1].value;
+                vcd.Wire(i, old_value_pins[i]);
             }
         }
     }
@@ -386,6 +351,7 @@ void cpart_VCD_Dump::OnMouseButtonPress(uint inputId, uint button, uint x, uint
             output_ids[O_REC]->update = 1;
             break;
         case I_VIEW:
+            vcd.Flush();
 #ifdef __EMSCRIPTEN__
             EM_ASM_(
                 {
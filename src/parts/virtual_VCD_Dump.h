@@ -28,6 +28,7 @@
 
 #include <lxrad.h>
 #include "../lib/part.h"
+#include "../lib/vcd_writer.h"
 
 #define PART_VCD_DUMP_Name "VCD Dump"
 
@@ -51,9 +52,12 @@ public:
 private:
     void RegisterRemoteControl(void) override;
     unsigned char input_pins[8];
-    unsigned char old_value_pins[8];
+    unsigned char allpins;
+    unsigned char rec_pins[256];
+    unsigned char old_value_pins[256];
+    int rec_count;
     char f_vcd_name[200];
-    FILE* f_vcd;
+    CVCDWriter vcd;
     unsigned long vcd_count;
     unsigned char rec;
     lxFont font;
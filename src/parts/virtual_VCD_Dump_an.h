@@ -28,6 +28,7 @@
 
 #include <lxrad.h>
 #include "../lib/part.h"
+#include "../lib/vcd_writer.h"
 
 #define PART_VCD_DUMP_AN_Name "VCD Dump (Analogic)"
 
@@ -55,8 +56,9 @@ private:
     void RegisterRemoteControl(void) override;
     unsigned char input_pins[8];
     float old_value_pins[8];
+    int vcd_ch[8];
     char f_vcd_name[200];
-    FILE* f_vcd;
+    CVCDWriter vcd;
     unsigned long vcd_count;
     unsigned char rec;
     lxFont font;
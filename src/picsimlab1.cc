@@ -104,7 +104,7 @@ void CPWindow1::timer1_EvOnTime(CControl* control) {
     if (PICSimLab.status.st[0] & (ST_T1 | ST_DI))
         return;
 
-    PICSimLab.SetSync(1);
+    PICSimLab.SyncSignal(0);
     PICSimLab.status.st[0] |= ST_T1;
 
 #ifdef _NOTHREAD
@@ -229,11 +229,26 @@ void CPWindow1::DrawBoard(void) {
 void CPWindow1::thread1_EvThreadRun(CControl*) {
     double t0, t1, etime;
     do {
-        if (PICSimLab.tgo) {
+        if (PICSimLab.GetFreeRun()) {
+            // batch mode, no wall clock pacing
+            PICSimLab.status.st[1] |= ST_TH;
+            // ST_DI is tested with ST_TH already set, the code that waits for ST_TH after setting ST_DI (file load,
+            // sim stop and snapshots) can't miss a slice that is starting
+            if (PICSimLab.GetToDestroy() || (PICSimLab.status.st[0] & ST_DI)) {
+                PICSimLab.status.st[1] &= ~ST_TH;
+                msleep(1);
+            } else {
+                PICSimLab.GetBoard()->Run_CPU();
+                PICSimLab.SyncSignal(1);
+                PICSimLab.FreeRunStep();
+                PICSimLab.status.st[1] &= ~ST_TH;
+            }
+        } else if (PICSimLab.tgo) {
             t0 = cpuTime();
 
             PICSimLab.status.st[1] |= ST_TH;
             PICSimLab.GetBoard()->Run_CPU();
+            PICSimLab.SyncSignal(1);
             if (PICSimLab.GetDebugStatus())
                 PICSimLab.GetBoard()->DebugLoop();
             PICSimLab.tgo--;
@@ -779,6 +794,28 @@ void CPWindow1::_EvOnCreate(CControl* control) {
 
     fflush(stdout);
 
+    // free running batch mode options (--run --stop-time=s --stop-uart=text --stop-pin=pin:value --bench-timers=n)
+    int argc = 1;
+    for (int i = 1; i < Application->Aargc; i++) {
+        if (!strncmp(Application->Aargv[i], "--", 2)) {
+            if (!PICSimLab.SetFreeRunOption(Application->Aargv[i] + 2)) {
+                printf("PICSimLab: Unknown option %s !\n", Application->Aargv[i]);
+            }
+        } else {
+            Application->Aargv[argc++] = Application->Aargv[i];
+        }
+    }
+    Application->Aargc = argc;
+
+#ifdef _NOTHREAD
+    // the Run_CPU slices are paced by timer1 here, there is no simulation thread to run them back to back
+    if (PICSimLab.GetFreeRun()) {
+        printf("PICSimLab: Free run options are not supported in this build (no simulation thread) !\n");
+        fflush(stdout);
+        exit(1);
+    }
+#endif
+
     if (close_error) {
         printf(
             "PICSimLab: Error closing PICSimLab in last time! \nUsing default mode.\n Erro log file: %s\n If the "
@@ -936,6 +973,10 @@ void CPWindow1::_EvOnDestroy(CControl* control) {
     printf("PICSimLab: Finish Ok\n");
     fflush(stdout);
 #endif
+
+    if (PICSimLab.GetFreeRun()) {
+        exit(PICSimLab.GetFreeRunExitCode());
+    }
 }
 
 void CPWindow1::menu1_File_LoadHex_EvMenuActive(CControl* control) {
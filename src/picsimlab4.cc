@@ -80,12 +80,7 @@ void CPWindow4::DrawScreen(void) {
         draw1.Canvas.Polygon(1, pts, 3);
 
         draw1.Canvas.SetLineWidth(2);
-        for (int t = 0; t < (NPOINTS / 2) - 1; t++) {
-            draw1.Canvas.Line((t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[0] * Oscilloscope.GetChannel(0)[t] + nivel[0],
-                              ((t + 1) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[0] * Oscilloscope.GetChannel(0)[t + 1] + nivel[0]);
-        }
+        DrawChannel(0, gain[0], nivel[0]);
     }
     draw1.Canvas.SetLineWidth(1);
 
@@ -106,12 +101,7 @@ void CPWindow4::DrawScreen(void) {
         draw1.Canvas.Polygon(1, pts, 3);
 
         draw1.Canvas.SetLineWidth(2);
-        for (int t = 0; t < (NPOINTS / 2) - 1; t++) {
-            draw1.Canvas.Line((t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[1] * Oscilloscope.GetChannel(1)[t] + nivel[1],
-                              ((t + 1) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[1] * Oscilloscope.GetChannel(1)[t + 1] + nivel[1]);
-        }
+        DrawChannel(1, gain[1], nivel[1]);
     }
     draw1.Canvas.SetLineWidth(1);
 
@@ -137,7 +127,7 @@ void CPWindow4::DrawScreen(void) {
     // draw toffset level
 
     draw1.Canvas.SetFgColor(255, 255, 0);
-    nivel[2] = ((WMAX - Oscilloscope.GetTimeOffset()) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0);
+    nivel[2] = WMAX - Oscilloscope.GetTimeOffset();
     pts[0].y = 1;
     pts[0].x = nivel[2] - 3;
     pts[1].y = 1 + 3;
@@ -262,6 +252,50 @@ void CPWindow4::DrawScreen(void) {
     draw1.Canvas.End();
 }
 
+void CPWindow4::DrawChannel(const int channel, const float gain, const float nivel) {
+    float vmin[WMAX];
+    float vmax[WMAX];
+    int ptop = 0;
+    int pbot = 0;
+    int prev = 0;
+
+    // one min/max pair per column, the cost doesn't depend on the time scale
+    Oscilloscope.GetEnvelope(channel, Oscilloscope.GetTimeOffset() - WMAX, WMAX, vmin, vmax);
+
+    for (int x = 0; x < WMAX; x++) {
+        if (vmin[x] > vmax[x]) {  // no data
+            prev = 0;
+            continue;
+        }
+        int ytop = nivel - gain * vmax[x];
+        int ybot = nivel - gain * vmin[x];
+        if (ytop > ybot) {  // inverted
+            const int y = ytop;
+            ytop = ybot;
+            ybot = y;
+        }
+
+        // join with the previous column
+        if (prev) {
+            if (ytop > pbot) {
+                draw1.Canvas.Line(x - 1, pbot, x, ytop);
+            } else if (ybot < ptop) {
+                draw1.Canvas.Line(x - 1, ptop, x, ybot);
+            } else {
+                const int y = (ytop > ptop) ? ytop : ptop;
+                draw1.Canvas.Line(x - 1, y, x, y);
+            }
+        }
+        if (ybot > ytop) {
+            draw1.Canvas.Line(x, ytop, x, ybot);
+        }
+
+        ptop = ytop;
+        pbot = ybot;
+        prev = 1;
+    }
+}
+
 void CPWindow4::button1_EvMouseButtonClick(CControl* control, uint button, uint x, uint y, uint state) {
 #ifndef __WXX11__
     colordialog1.SetColor(button1.GetColor());
@@ -288,16 +322,10 @@ void CPWindow4::spind5_EvOnChangeSpinDouble(CControl* control) {
 
     Oscilloscope.SetRT((spind5.GetValue() * 1e-3 * 10) / WMAX);
 
-    if ((Oscilloscope.GetRT() / Oscilloscope.GetDT()) < 1.0) {
-        xz = Oscilloscope.GetDT() / Oscilloscope.GetRT();
-    } else
-        xz = 1.0;
-
     spind6.SetMin(-5 * spind5.GetValue());
     spind6.SetMax(5 * spind5.GetValue());
 
     spind6_EvOnChangeSpinDouble(this);
-    // printf("Dt=%e Rt=%e  Rt/Dt=%f   xz=%f\n",Dt,Rt,Rt/Dt,xz);
 }
 
 void CPWindow4::togglebutton5_EvOnToggleButton(CControl* control) {
@@ -376,6 +404,10 @@ void CPWindow4::_EvOnHide(CControl* control) {
 
 void CPWindow4::spind6_EvOnChangeSpinDouble(CControl* control) {
     Oscilloscope.SetTimeOffset((WMAX / 2) - (((WMAX / 2) * spind6.GetValue()) / (5 * spind5.GetValue())));
+    // stopped frames can be zoomed and moved inside the capture memory
+    if (!Oscilloscope.GetRun()) {
+        Oscilloscope.SetUpdate(1);
+    }
 }
 
 // autoset
@@ -424,8 +456,6 @@ void CPWindow4::togglebutton6_EvOnToggleButton(CControl* control) {
     spind2.SetEnable(Oscilloscope.GetRun());
     spind3.SetEnable(Oscilloscope.GetRun());
     spind4.SetEnable(Oscilloscope.GetRun());
-    spind5.SetEnable(Oscilloscope.GetRun());
-    spind6.SetEnable(Oscilloscope.GetRun());
     spind7.SetEnable(Oscilloscope.GetRun());
     button1.SetEnable(Oscilloscope.GetRun());
     button2.SetEnable(Oscilloscope.GetRun());
@@ -111,9 +111,9 @@ public:
     void DrawScreen(void);
 
 private:
+    void DrawChannel(const int channel, const float gain, const float nivel);
     CButton* ctrl;
     lxFont* font;
-    double xz;
 };
 
 extern CPWindow4 Window4;
@@ -0,0 +1,202 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gamboa Lopes
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+// Standalone Run_CPU loop microbenchmark, it doesn't need a PICSimLab build.
+// Compares the per step overhead of the old Arduino Uno Run_CPU loop, which tests the oscilloscope, spare parts and
+// breakpoint state on every step, with the flags specialized kernel of src/lib/board_run.h. The cpu step is a stub
+// that changes a pin every 64 steps, so only the loop cost is measured, not the MIPS of a real core.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RUN_OSCOPE 0x01
+#define RUN_SPARE 0x02
+
+#define PINC 28
+
+static unsigned char pins[PINC];
+static int ioupdated;
+static int mcu_dbg;
+static int bpc;
+static uint32_t inst_counter;
+static uint64_t samples;
+static uint64_t processed;
+
+__attribute__((noinline)) static void cpu_step(void) {
+    static uint32_t n;
+    n++;
+    if (!(n & 63)) {
+        pins[n % PINC] ^= 1;
+        ioupdated = 1;
+    }
+}
+
+// mplabxd_testbp() without breakpoints
+__attribute__((noinline)) static int testbp(void) {
+    if (!mcu_dbg) {
+        for (int i = 0; i < bpc; i++) {
+            if (inst_counter == (uint32_t)i) {
+                return 1;
+            }
+        }
+    }
+    return mcu_dbg;
+}
+
+// old InstCounterInc in board.cc without timers
+__attribute__((noinline)) static void inst_counter_inc_old(void) {
+    inst_counter++;
+}
+
+__attribute__((noinline)) static void oscilloscope_set_sample(void) {
+    samples++;
+}
+
+// CSpareParts::Process with one part and no always update parts
+__attribute__((noinline)) static void spareparts_process(void) {
+    if (ioupdated) {
+        processed++;
+    }
+}
+
+static double run_old(const long int nstep, const int use_oscope, const int use_spare) {
+    unsigned int alm[PINC];
+    int pi = 0;
+
+    memset(alm, 0, sizeof(alm));
+    for (long int i = 0; i < nstep; i++) {
+        if (!testbp()) {
+            cpu_step();
+        }
+        inst_counter_inc_old();
+
+        if (use_oscope)
+            oscilloscope_set_sample();
+        if (use_spare)
+            spareparts_process();
+        ioupdated = 0;
+
+        alm[pi] += pins[pi];
+        pi++;
+        if (pi == PINC)
+            pi = 0;
+    }
+    return alm[0];
+}
+
+template <int flags>
+static double run_new(const long int nstep) {
+    uint32_t alm[PINC];
+    uint32_t alm_rise[PINC];
+    unsigned char alm_value[PINC];
+    const int run = !mcu_dbg;
+
+    for (int p = 0; p < PINC; p++) {
+        alm[p] = 0;
+        alm_rise[p] = inst_counter;
+        alm_value[p] = pins[p];
+    }
+
+    for (long int i = 0; i < nstep; i++) {
+        if (run) {
+            cpu_step();
+        }
+        inst_counter++;
+
+        if (flags & RUN_OSCOPE)
+            oscilloscope_set_sample();
+        if (flags & RUN_SPARE)
+            spareparts_process();
+
+        // AlmUpdate, the pins are only compared after the steps that change some IO
+        if (ioupdated) {
+            for (int p = 0; p < PINC; p++) {
+                if (pins[p] != alm_value[p]) {
+                    if (pins[p]) {
+                        alm_rise[p] = inst_counter;
+                    } else {
+                        alm[p] += inst_counter - alm_rise[p];
+                    }
+                    alm_value[p] = pins[p];
+                }
+            }
+        }
+        ioupdated = 0;
+    }
+    return alm[0];
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char** argv) {
+    long int steps = 100000000;
+    volatile double sink = 0;
+
+    if (argc > 1) {
+        steps = strtol(argv[1], NULL, 10);
+    }
+    if (steps <= 0) {
+        printf("Use: kernel_bench [steps]\n");
+        return 1;
+    }
+
+    printf("%li steps, stub cpu step\n", steps);
+    printf("oscope spare   old ns/step   new ns/step   speedup\n");
+    for (int f = 0; f < 4; f++) {
+        const int use_oscope = (f & RUN_OSCOPE) != 0;
+        const int use_spare = (f & RUN_SPARE) != 0;
+
+        double start = now_ns();
+        sink = sink + run_old(steps, use_oscope, use_spare);
+        const double old_ns = (now_ns() - start) / steps;
+
+        start = now_ns();
+        switch (f) {
+            case 0:
+                sink = sink + run_new<0>(steps);
+                break;
+            case RUN_OSCOPE:
+                sink = sink + run_new<RUN_OSCOPE>(steps);
+                break;
+            case RUN_SPARE:
+                sink = sink + run_new<RUN_SPARE>(steps);
+                break;
+            default:
+                sink = sink + run_new<RUN_OSCOPE | RUN_SPARE>(steps);
+                break;
+        }
+        const double new_ns = (now_ns() - start) / steps;
+
+        printf("%6i %5i   %11.3f   %11.3f   %6.2fx\n", use_oscope, use_spare, old_ns, new_ns, old_ns / new_ns);
+    }
+    return 0;
+}
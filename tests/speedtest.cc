@@ -24,6 +24,8 @@
    ######################################################################## */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "tests.h"
@@ -69,3 +71,135 @@ static int test_speedtest(void* arg) {
 }
 
 register_test("Speed Test", test_speedtest, NULL);
+
+// workspaces of the boards measured by the MIPS benchmark
+static const char* mips_workspaces[] = {
+    "blink/blink.pzw",                   // Arduino Uno
+    "PICGenios/PICGenios.pzw",           // PICGenios
+    "i2c/pic18f_bmp280_i2c.pzw",         // Breadboard PIC18F4620 with spare parts
+    "spi/uno_bmp280_spi.pzw",            // Arduino Uno with spare parts
+    "Blue_Pill/Blue_Pill.pzw",           // Blue Pill (qemu)
+    "../share/boards/uCboard/demo.pzw",  // uCboard C51 (uCsim)
+    NULL,
+};
+
+// free run 10 seconds of simulated time without wall clock pacing, returns 0 if there is no result
+static int board_mips_run(const char* exe, const char* opts, const char* workspace, float* speed, float* mips) {
+    char cmd[512];
+    char line[512];
+
+    *speed = 0;
+    *mips = 0;
+
+    sprintf(cmd, "%s --stop-time=10 %s %s", exe, opts, workspace);
+    FILE* fp = popen(cmd, "r");
+    if (!fp) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        // an option not supported by this build would measure a different run
+        if (strstr(line, "Unknown option")) {
+            *speed = -1;
+        }
+        char* ptr = strstr(line, "of wall time, ");
+        if (ptr && (*speed == 0)) {
+            // builds older than the MIPS report only print the speed
+            sscanf(ptr + 14, "%fx, %f MIPS", speed, mips);
+        }
+    }
+    pclose(fp);
+    return (*speed > 0);
+}
+
+// set PICSIMLAB_BASELINE to an executable built before a change to print the before/after comparison
+static int test_board_mips(void* arg) {
+    const char* baseline = getenv("PICSIMLAB_BASELINE");
+    int ret = 1;
+
+    printf("test test_board_mips \n");
+
+    if (baseline && !test_file_exist(baseline)) {
+        printf("Baseline executable \"%s\" not found! \n", baseline);
+        return 0;
+    }
+
+    for (int i = 0; mips_workspaces[i]; i++) {
+        float speed, mips;
+        float bspeed, bmips;
+
+        if (!test_file_exist(mips_workspaces[i])) {
+            printf("File not found %s\n", mips_workspaces[i]);
+            ret = 0;
+            continue;
+        }
+
+        if (!board_mips_run(test_get_exe(), "", mips_workspaces[i], &speed, &mips) || (mips == 0)) {
+            printf("%-30s  no result\n", mips_workspaces[i]);
+            ret = 0;
+            continue;
+        }
+
+        if (!baseline) {
+            printf("%-30s  %6.1fx  %8.2f MIPS\n", mips_workspaces[i], speed, mips);
+        } else if (!board_mips_run(baseline, "", mips_workspaces[i], &bspeed, &bmips)) {
+            printf("%-30s  no baseline result\n", mips_workspaces[i]);
+            ret = 0;
+        } else {
+            // both runs execute the same steps, the MIPS scale with the speed
+            bmips = mips * bspeed / speed;
+            printf("%-30s  before %8.2f MIPS  after %8.2f MIPS  %+6.1f%%\n", mips_workspaces[i], bmips, mips,
+                   (speed / bspeed - 1) * 100);
+        }
+    }
+    return ret;
+}
+
+register_test("Board MIPS", test_board_mips, NULL);
+
+// timers microbenchmark, the board runs with 0, 8 and 64 extra timers with 10us to 73us periods
+static int test_timers_bench(void* arg) {
+    const char* workspace = "blink/blink.pzw";  // Arduino Uno
+    const int timers[] = {0, 8, 64};
+    const char* baseline = getenv("PICSIMLAB_BASELINE");
+    float base = 0;
+    char opts[32];
+    int ret = 1;
+
+    printf("test test_timers_bench \n");
+
+    if (!test_file_exist(workspace)) {
+        printf("File not found %s\n", workspace);
+        return 0;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        float speed, mips;
+        float bspeed, bmips;
+
+        sprintf(opts, "--bench-timers=%i", timers[i]);
+        if (!board_mips_run(test_get_exe(), opts, workspace, &speed, &mips) || (mips == 0)) {
+            printf("%2i timers  no result\n", timers[i]);
+            ret = 0;
+            continue;
+        }
+
+        // time per step, the timers cost is the increase over the run without extra timers
+        const float ns = 1e3 / mips;
+        if (!timers[i]) {
+            base = ns;
+        }
+
+        if (!baseline) {
+            printf("%2i timers  %6.2f ns/step  (+%5.2f)\n", timers[i], ns, ns - base);
+        } else if (!board_mips_run(baseline, opts, workspace, &bspeed, &bmips)) {
+            printf("%2i timers  no baseline result\n", timers[i]);
+            ret = 0;
+        } else {
+            // both runs execute the same steps, the time per step scales with the speed
+            printf("%2i timers  before %6.2f ns/step  after %6.2f ns/step\n", timers[i], ns * speed / bspeed, ns);
+        }
+    }
+    return ret;
+}
+
+register_test("Timers bench", test_timers_bench, NULL);
@@ -427,6 +427,10 @@ ioctlsocket (sock_descriptor, FIONBIO, &iMode);
 }
  */
 
+const char* test_get_exe(void) {
+    return pexe;
+}
+
 int test_file_exist(const char* fname) {
     struct stat sb;
 
@@ -56,6 +56,8 @@ int test_serial_vt_end(void);
 
 int test_file_exist(const char* fname);
 
+const char* test_get_exe(void);
+
 int testPressButton(const int key, const int down = 0, const int tout = 200);
 
 #endif /* TESTS_H */
@@ -0,0 +1,238 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gamboa Lopes
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+// Standalone board timers microbenchmark, it doesn't need a PICSimLab build.
+// Compares the old countdown list, where InstCounterInc decrements every enabled timer on each step, with the
+// expiration min-heap of src/lib/board.cc, where InstCounterInc compares InstCounter with the nearest expiration.
+// Both copies must be kept in sync with the board code they measure.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MAX_TIMERS 256
+
+typedef struct {
+    uint32_t Timer;
+    uint32_t Reload;
+    void* Arg;
+    void (*Callback)(void* arg);
+    int Enabled;
+    int HeapPos;
+} Timers_t;
+
+static void timer_callback(void* arg) {
+    (*(volatile uint64_t*)arg)++;
+}
+
+// old board: InstCounterInc was in board.cc and scanned the list on every instruction
+class board_list {
+public:
+    board_list(void) : InstCounter(0), TimersCount(0){};
+
+    void TimerRegister(const uint32_t reload, void (*Callback)(void* arg), void* arg) {
+        Timers_t* timer = &Timers[TimersCount];
+        timer->Timer = reload;
+        timer->Reload = reload;
+        timer->Callback = Callback;
+        timer->Arg = arg;
+        timer->Enabled = 1;
+        TimersList[TimersCount] = timer;
+        TimersCount++;
+    }
+
+    __attribute__((noinline)) void InstCounterInc(void) {
+        InstCounter++;
+        for (int t = 0; t < TimersCount; t++) {
+            if (TimersList[t]->Enabled) {
+                TimersList[t]->Timer--;
+                if (!TimersList[t]->Timer) {
+                    (*TimersList[t]->Callback)(TimersList[t]->Arg);
+                    TimersList[t]->Timer = TimersList[t]->Reload;
+                }
+            }
+        }
+    }
+
+private:
+    uint32_t InstCounter;
+    int TimersCount;
+    Timers_t Timers[MAX_TIMERS];
+    Timers_t* TimersList[MAX_TIMERS];
+};
+
+#define TIMER_LEFT(t) ((t)->Timer - InstCounter)
+
+// new board: InstCounterInc is inline in board.h, TimersRun and the heap code are in board.cc
+class board_heap {
+public:
+    board_heap(void) : InstCounter(0), TimersNext(0), TimersHeapCount(0), TimersCount(0){};
+
+    void TimerRegister(const uint32_t reload, void (*Callback)(void* arg), void* arg) {
+        Timers_t* timer = &Timers[TimersCount];
+        timer->Reload = reload;
+        timer->Callback = Callback;
+        timer->Arg = arg;
+        timer->Enabled = 1;
+        timer->HeapPos = -1;
+        TimersCount++;
+        TimerSchedule(timer);
+    }
+
+    void InstCounterInc(void) {
+        InstCounter++;
+        if (InstCounter == TimersNext) {
+            TimersRun();
+        }
+    }
+
+private:
+    uint32_t InstCounter;
+    uint32_t TimersNext;
+    int TimersHeapCount;
+    int TimersCount;
+    Timers_t Timers[MAX_TIMERS];
+    Timers_t* TimersHeap[MAX_TIMERS];
+
+    __attribute__((noinline)) void TimersHeapFix(int pos) {
+        Timers_t* timer = TimersHeap[pos];
+        const uint32_t left = TIMER_LEFT(timer);
+
+        while (pos > 0) {
+            int parent = (pos - 1) >> 1;
+            if (TIMER_LEFT(TimersHeap[parent]) <= left) {
+                break;
+            }
+            TimersHeap[pos] = TimersHeap[parent];
+            TimersHeap[pos]->HeapPos = pos;
+            pos = parent;
+        }
+
+        while (1) {
+            int child = (pos << 1) + 1;
+            if (child >= TimersHeapCount) {
+                break;
+            }
+            if (((child + 1) < TimersHeapCount) &&
+                (TIMER_LEFT(TimersHeap[child + 1]) < TIMER_LEFT(TimersHeap[child]))) {
+                child++;
+            }
+            if (left <= TIMER_LEFT(TimersHeap[child])) {
+                break;
+            }
+            TimersHeap[pos] = TimersHeap[child];
+            TimersHeap[pos]->HeapPos = pos;
+            pos = child;
+        }
+
+        TimersHeap[pos] = timer;
+        timer->HeapPos = pos;
+    }
+
+    void TimersUpdateNext(void) {
+        if (TimersHeapCount) {
+            TimersNext = TimersHeap[0]->Timer;
+        } else {
+            TimersNext = InstCounter;
+        }
+    }
+
+    __attribute__((noinline)) void TimerSchedule(Timers_t* timer) {
+        timer->Timer = InstCounter + timer->Reload;
+        if (timer->HeapPos < 0) {
+            timer->HeapPos = TimersHeapCount;
+            TimersHeap[TimersHeapCount] = timer;
+            TimersHeapCount++;
+        }
+        TimersHeapFix(timer->HeapPos);
+        TimersUpdateNext();
+    }
+
+    __attribute__((noinline)) void TimersRun(void) {
+        while (TimersHeapCount && (TimersHeap[0]->Timer == InstCounter)) {
+            Timers_t* timer = TimersHeap[0];
+            TimerSchedule(timer);
+            (*timer->Callback)(timer->Arg);
+        }
+        TimersUpdateNext();
+    }
+};
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// timers of 10+i us at 16 MIPS, like the speedtest --bench-timers option
+template <class B>
+static double bench(const int ntimers, const uint32_t steps, uint64_t* calls) {
+    static B b;
+    volatile uint64_t count = 0;
+
+    b = B();
+    for (int i = 0; i < ntimers; i++) {
+        b.TimerRegister((10 + i) * 16, timer_callback, (void*)&count);
+    }
+
+    const double start = now_ns();
+    for (uint32_t s = 0; s < steps; s++) {
+        b.InstCounterInc();
+    }
+    const double elapsed = now_ns() - start;
+
+    *calls = count;
+    return elapsed / steps;
+}
+
+int main(int argc, char** argv) {
+    const int timers[3] = {0, 8, 64};
+    uint32_t steps = 100000000;
+
+    if (argc > 1) {
+        steps = strtoul(argv[1], NULL, 10);
+    }
+    if (!steps) {
+        printf("Use: timers_bench [steps]\n");
+        return 1;
+    }
+
+    printf("%u steps, timers of 10+i us at 16 MIPS\n", steps);
+    printf("timers   list ns/step   heap ns/step   speedup   callbacks\n");
+    for (int i = 0; i < 3; i++) {
+        uint64_t lcalls, hcalls;
+        const double list = bench<board_list>(timers[i], steps, &lcalls);
+        const double heap = bench<board_heap>(timers[i], steps, &hcalls);
+
+        printf("%6i   %12.3f   %12.3f   %6.1fx   %llu", timers[i], list, heap, list / heap,
+               (unsigned long long)hcalls);
+        if (lcalls != hcalls) {
+            printf(" (list %llu)", (unsigned long long)lcalls);
+        }
+        printf("\n");
+    }
+    return 0;
+}